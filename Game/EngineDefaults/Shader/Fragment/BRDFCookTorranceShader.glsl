@@ -8,7 +8,7 @@ in vec3 pos;
 in vec2 uv0;
 in vec3 normal;
 in vec4 tangent;
-flat in int instance_index;
+flat in int material_index;
 
 out vec4 outColor;
 
@@ -126,7 +126,7 @@ vec3 RenderLight(vec3 L, vec3 N, vec3 texColor, vec3 Li, float NdotL, float alph
     float NdotV = max(dot(N, V), 0.0001);
     float NdotH = max(dot(N, H), 0.0001);
 
-    vec3 BaseColor = materials[instance_index].diffColor.rgb * texColor;
+    vec3 BaseColor = materials[material_index].diffColor.rgb * texColor;
     vec3 Cd = BaseColor * (1 - metalness);
     vec3 RF0 = mix(vec3(0.04), BaseColor, metalness);
     
@@ -173,7 +173,7 @@ vec3 RenderSpotLight(const int index, const vec3 N, const vec3 texColor, const f
 
 void main()
 {
-    Material mat = materials[instance_index];
+    Material mat = materials[material_index];
     vec3 texColor = pow(texture(sampler2D(mat.diffuseTex), uv0).rgb, vec3(2.2f));
     vec4 metallicRoughnessTexColor = pow(texture(sampler2D(mat.metallicTex), uv0), vec4(2.2));
     float alpha = metallicRoughnessTexColor.a;
@@ -8,7 +8,7 @@ in vec3 pos;
 in vec2 uv0;
 in vec3 normal;
 in vec4 tangent;
-flat in int instance_index;
+flat in int material_index;
 
 out vec4 outColor;
 
@@ -106,8 +106,8 @@ float SpotLightAttenuation(const int index)
 vec3 RenderLight(vec3 L, vec3 N, vec4 specTexColor, vec3 texColor, vec3 Li, float NdotL, float alpha)
  {
     float shininessValue;
-	if(materials[instance_index].shininessInAlpha) shininessValue = exp2(alpha * 7 + 1);
-	else shininessValue = materials[instance_index].shininess;
+	if(materials[material_index].shininessInAlpha) shininessValue = exp2(alpha * 7 + 1);
+	else shininessValue = materials[material_index].shininess;
 
     float normalization = (shininessValue + 2.0) / (2.0 * PI);
     vec3 V = normalize(cameraPos - pos);
@@ -118,8 +118,8 @@ vec3 RenderLight(vec3 L, vec3 N, vec4 specTexColor, vec3 texColor, vec3 Li, floa
     float cosTheta = max(dot(N, V), 0.0);
     vec3 fresnel = RF0 + (1 - RF0) * pow(1 - cosTheta, 5);
 
-    vec3 diffuse = (1.0 - RF0) / PI * materials[instance_index].diffColor.rgb * texColor * Li * NdotL;
-    vec3 specular = normalization * materials[instance_index].specColor.rgb * specTexColor.rgb * VR * Li * fresnel;
+    vec3 diffuse = (1.0 - RF0) / PI * materials[material_index].diffColor.rgb * texColor * Li * NdotL;
+    vec3 specular = normalization * materials[material_index].specColor.rgb * specTexColor.rgb * VR * Li * fresnel;
     return diffuse + specular;
 }
 
@@ -155,7 +155,7 @@ vec3 RenderSpotLight(const int index, const vec3 N, vec4 specTexColor, const vec
 
 void main()
 {
-    Material mat = materials[instance_index];
+    Material mat = materials[material_index];
     vec3 texColor = pow(texture(sampler2D(mat.diffuseTex), uv0).rgb, vec3(2.2f));
     vec4 specTexColor = texture(sampler2D(mat.specularTex), uv0);
     float alpha = specTexColor.a;
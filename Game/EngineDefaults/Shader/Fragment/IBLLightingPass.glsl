@@ -65,6 +65,27 @@ readonly layout(std430, binding = 5) buffer SpotLights
 	SpotLight spotLights[];
 };
 
+readonly layout(std430, row_major, binding = 6) buffer LightClusters
+{
+	mat4 clusterView;
+	uvec4 clusterCounts;	// x = tiles in x, y = tiles in y, z = depth slices
+	vec4 clusterDepth;		// x = near, y = far, z = slices per log unit of depth
+	uvec4 clusters[];		// x = first light index, y = point lights, z = spot lights
+};
+
+readonly layout(std430, binding = 7) buffer LightIndices
+{
+	uint lightIndices[];
+};
+
+uvec4 GetLightCluster(vec3 pos)
+{
+	const float depth = -(clusterView * vec4(pos, 1.0)).z;
+	const uint slice = uint(clamp(floor(log(max(depth, clusterDepth.x) / clusterDepth.x) * clusterDepth.z), 0.0, float(clusterCounts.z - 1u)));
+	const uvec2 tile = min(uvec2(uv0 * vec2(clusterCounts.xy)), clusterCounts.xy - 1u);
+	return clusters[(slice * clusterCounts.y + tile.y) * clusterCounts.x + tile.x];
+}
+
 
 float PointLightAttenuation(const int index, vec3 pos) 
 {
@@ -184,16 +205,19 @@ void main()
     const vec3 ambient = GetAmbientLight(N, R, NdotV, roughness, Cd, RF0);
     vec3 hdr = ambient;
 
+    // Only the lights of the cluster of this pixel, point lights first
+    const uvec4 cluster = GetLightCluster(pos);
+
     // Point Lights
-    for (int i = 0; i < pointLightsCount; ++i)
+    for (uint i = 0; i < cluster.y; ++i)
 	{
-		hdr += RenderPointLight(i, N, Cd, roughness, RF0, pos);
+		hdr += RenderPointLight(int(lightIndices[cluster.x + i]), N, Cd, roughness, RF0, pos);
 	}
 
     //Spot Lights
-    for (int i = 0; i < spotLightsCount; ++i)
+    for (uint i = 0; i < cluster.z; ++i)
 	{
-		hdr += RenderSpotLight(i, N, Cd, roughness, RF0, pos);
+		hdr += RenderSpotLight(int(lightIndices[cluster.x + cluster.y + i]), N, Cd, roughness, RF0, pos);
 	}
 
     // Directional light
@@ -8,7 +8,7 @@ in vec3 pos;
 in vec2 uv0;
 in vec3 normal;
 in vec4 tangent;
-flat in int instance_index;
+flat in int material_index;
 
 out vec4 outColor;
 
@@ -185,7 +185,7 @@ vec3 RenderSpotLight(const int index, const vec3 N, const vec3 Cd, float roughne
 
 void main()
 {
-    const Material mat = materials[instance_index];
+    const Material mat = materials[material_index];
     const vec3 texColor = pow(texture(sampler2D(mat.diffuseTex), uv0).rgb, vec3(2.2f));
     const vec4 metallicRoughnessTexColor = pow(texture(sampler2D(mat.metallicTex), uv0), vec4(2.2));
     const float alpha = metallicRoughnessTexColor.a;
@@ -208,7 +208,7 @@ void main()
     const float NdotV = max(dot(N, V), 0.0001);
 
     // Ambient light
-    const vec3 BaseColor = materials[instance_index].diffColor.rgb * texColor;
+    const vec3 BaseColor = materials[material_index].diffColor.rgb * texColor;
     const vec3 Cd = BaseColor * (1 - metallic);
     const vec3 RF0 = mix(vec3(0.04), BaseColor, metallic);
 
@@ -3,9 +3,9 @@
 #extension GL_ARB_bindless_texture : require
 
 in vec2 uv0;
+in vec3 color;
 out vec4 outColor;
 
-layout(location = 3) uniform vec3 inputColor;
 layout(location = 4) uniform uvec2 fontTexture;
 layout(location = 5) uniform uint widgetType;
 
@@ -16,17 +16,17 @@ void main()
     switch(widgetType) {
         // LABEL
         case 0:    
-            outColor = vec4(inputColor.r, inputColor.g, inputColor.b, sampled.r);
+            outColor = vec4(color.r, color.g, color.b, sampled.r);
             break;
         
         // IMAGE
         case 1:
-            outColor = vec4(sampled.r * inputColor.r, sampled.g * inputColor.g, sampled.b * inputColor.b, sampled.a);
+            outColor = vec4(sampled.r * color.r, sampled.g * color.g, sampled.b * color.b, sampled.a);
             break;
 
         // FALLBACK
         default:
-            outColor = vec4(inputColor.r, inputColor.g, inputColor.b, 1);
+            outColor = vec4(color.r, color.g, color.b, 1);
             break;
     }
     
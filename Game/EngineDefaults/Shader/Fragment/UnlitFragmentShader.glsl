@@ -8,7 +8,7 @@ in vec3 pos;
 in vec2 uv0;
 in vec3 normal;
 in vec4 tangent;
-flat in int instance_index;
+flat in int material_index;
 
 out vec4 outColor;
 
@@ -34,6 +34,6 @@ readonly layout(std430, binding = 11) buffer Materials {
 
 void main()
 {
-    Material mat = materials[instance_index];
+    Material mat = materials[material_index];
     outColor = texture(sampler2D(mat.diffuseTex), uv0);
 }
\ No newline at end of file
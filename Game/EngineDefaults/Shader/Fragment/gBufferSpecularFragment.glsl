@@ -13,7 +13,7 @@ in vec3 pos;
 in vec2 uv0;
 in vec3 normal;
 in vec4 tangent;
-flat in int instance_index;
+flat in int material_index;
 
 struct Material
 {
@@ -43,7 +43,7 @@ mat3 CreateTBN()
 
 void main()
 {
-    const Material mat = materials[instance_index];
+    const Material mat = materials[material_index];
 
     gDiffuse = vec4(pow(texture(sampler2D(mat.diffuseTex), uv0).rgb, vec3(2.2f)), 1);
     gSpecular = vec4(pow(texture(sampler2D(mat.specularTex), uv0), vec4(2.2)));
@@ -1,15 +1,18 @@
 #version 460
-layout (location = 0) in vec2 vertexPos;
+// Batched by the canvas, the positions already have the widget transform applied
+layout (location = 0) in vec3 vertexPos;
 layout (location = 1) in vec2 texCoords;
+layout (location = 2) in vec3 vertexColor;
 
 out vec2 uv0;
+out vec3 color;
 
-layout(location=0) uniform mat4 model;
 layout(location=1) uniform mat4 view;
 layout(location=2) uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(vertexPos, 0.0, 1.0);
+    gl_Position = projection * view * vec4(vertexPos, 1.0);
     uv0 = texCoords;
+    color = vertexColor;
 }
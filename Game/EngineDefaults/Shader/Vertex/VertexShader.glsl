@@ -1,6 +1,6 @@
 #version 460
 
-layout(location=0) in vec3 vertex_position;
+layout(location=0) in vec4 vertex_position; // Compact vertices keep the tangent handedness in w
 layout(location=1) in vec4 vertex_tangent;
 layout(location=2) in vec3 vertex_normal;
 layout(location=3) in vec2 vertex_uv0;
@@ -8,6 +8,7 @@ layout(location=4) in ivec4 vertex_joint;
 layout(location=5) in vec4 vertex_weights;
 
 layout(location=4) uniform bool hasBones;
+layout(location=5) uniform bool isCompact;
 
 layout(std140, row_major, binding = 0) uniform CameraMatrices
 {
@@ -15,10 +16,23 @@ layout(std140, row_major, binding = 0) uniform CameraMatrices
     mat4 viewMatrix;
 };
 
+// Static objects, only rewritten when they move
 readonly layout(std430, row_major, binding = 10) buffer Transforms {
     mat4 models[];
 };
 
+// Dynamic objects, rewritten every frame
+readonly layout(std430, row_major, binding = 16) buffer DynamicTransforms {
+    mat4 dynamicModels[];
+};
+
+// Where the model of every instance is, the dynamic bit selects dynamicModels
+const uint DYNAMIC_MODEL_BIT = 0x80000000u;
+readonly layout(std430, binding = 17) buffer ModelSlots {
+    uint modelSlots[];
+};
+
+// Palettes relative to the model of their instance, instances in the same pose read the same one
 readonly layout(std430, row_major, binding = 12) buffer Bones {
     mat4 palettes[];
 };
@@ -27,25 +41,60 @@ readonly layout(std430, row_major, binding = 13) buffer AccBones {
     uint bonesIndex[];
 };
 
+// Component index of every instance, commands of repeated meshes address a contiguous range of it
+readonly layout(std430, binding = 14) buffer InstanceIndices {
+    uint instanceIndices[];
+};
+
+// Entry of the material table of every instance, instances sharing a material share the entry
+readonly layout(std430, binding = 18) buffer MaterialIndices {
+    uint materialIndices[];
+};
+
+// Bounds minimum and extent of every instance, positions of compact vertices are quantized against them
+readonly layout(std430, binding = 15) buffer Quantization {
+    vec4 quantization[];
+};
+
 out vec3 pos;
 out vec3 normal;
 out vec2 uv0;
 out vec4 tangent;
 out vec3 fragViewPos;
-flat out int instance_index;
+flat out int material_index;
+
+vec3 OctahedralDecode(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.xy += mix(vec2(fold), vec2(-fold), greaterThanEqual(direction.xy, vec2(0.0)));
+    return normalize(direction);
+}
 
 void main()
 {
-    instance_index = gl_BaseInstance;
-    mat4 model = models[instance_index];
+    int instance_index = int(instanceIndices[gl_BaseInstance + gl_InstanceID]);
+    material_index = int(materialIndices[instance_index]);
+    uint modelSlot = modelSlots[instance_index];
+    mat4 model = (modelSlot & DYNAMIC_MODEL_BIT) != 0u ? dynamicModels[modelSlot & ~DYNAMIC_MODEL_BIT] : models[modelSlot];
+
+    vec3 localPosition = vertex_position.xyz;
+    vec3 localNormal = vertex_normal;
+    vec4 localTangent = vertex_tangent;
+    if (isCompact)
+    {
+        localPosition = quantization[instance_index * 2].xyz + vertex_position.xyz * quantization[instance_index * 2 + 1].xyz;
+        localNormal = OctahedralDecode(vertex_normal.xy);
+        localTangent = vec4(OctahedralDecode(vertex_tangent.xy), vertex_position.w * 2.0 - 1.0);
+    }
 
     //Camera position in World Space
     fragViewPos = vec3(inverse(viewMatrix)[3]);
     uv0 = vertex_uv0;
 
     mat3 normalMatrix = mat3(transpose(inverse(model)));
-    normal = normalMatrix * vertex_normal;
-    tangent = vec4(normalMatrix * vertex_tangent.xyz, vertex_tangent.w);
+    normal = normalMatrix * localNormal;
+    tangent = vec4(normalMatrix * localTangent.xyz, localTangent.w);
 
     // Indexing with a float is crashing
     if (hasBones) 
@@ -53,15 +102,15 @@ void main()
         uint boneIndex = bonesIndex[instance_index];
         mat4 skin    = palettes[boneIndex + vertex_joint[0]] * vertex_weights[0] + palettes[boneIndex + vertex_joint[1]] * vertex_weights[1] +             
                        palettes[boneIndex + vertex_joint[2]] * vertex_weights[2] + palettes[boneIndex + vertex_joint[3]] * vertex_weights[3];
-        pos          = (skin * vec4(vertex_position, 1.0)).xyz;
+        pos          = vec3(model * skin * vec4(localPosition, 1.0));
 
         mat3 skinRot = mat3(skin); // Skin matrix with rotation only
-        normal       = skinRot * vertex_normal;        
-        tangent      = vec4(skinRot * tangent.xyz, tangent.w); 
+        normal       = normalMatrix * (skinRot * localNormal);
+        tangent      = vec4(normalMatrix * (skinRot * localTangent.xyz), localTangent.w);
     } 
     else 
     {
-        pos = vec3(model * vec4(vertex_position, 1.0));
+        pos = vec3(model * vec4(localPosition, 1.0));
     }
 
     gl_Position = projMatrix * viewMatrix * vec4(pos, 1.0f); 
@@ -3,9 +3,11 @@
 #include "Application.h"
 #include "CameraComponent.h"
 #include "CameraModule.h"
+#include "FrustumPlanes.h"
 #include "GameObject.h"
 #include "GeometryBatch.h"
 #include "OpenGLModule.h"
+#include "RenderState.h"
 #include "ResourceMaterial.h"
 #include "ResourceMesh.h"
 #include "Scene.h"
@@ -15,6 +17,7 @@
 
 #include "Math/float3.h"
 #include "glew.h"
+#include <algorithm>
 #include <chrono>
 #ifdef OPTICK
 #include "optick.h"
@@ -33,10 +36,12 @@ void BatchManager::UnloadAllBatches()
 {
     for (GeometryBatch* it : batches)
     {
+        renderProxies.OnBatchRemoved(it);
         delete it;
     }
     batches.clear();
     batches.shrink_to_fit();
+    batchStats.clear();
 }
 
 void BatchManager::RemoveBatch(GeometryBatch* removeBatch)
@@ -45,6 +50,7 @@ void BatchManager::RemoveBatch(GeometryBatch* removeBatch)
     {
         if (batches[i] == removeBatch)
         {
+            renderProxies.OnBatchRemoved(removeBatch);
             delete batches[i];
             batches.erase(batches.begin() + i);
             break;
@@ -52,13 +58,47 @@ void BatchManager::RemoveBatch(GeometryBatch* removeBatch)
     }
 }
 
+void BatchManager::RemoveComponent(GeometryBatch* batch, const MeshComponent* component)
+{
+    // The batch may already be gone if all of them were unloaded before the component
+    const auto it = std::find(batches.begin(), batches.end(), batch);
+    if (it == batches.end()) return;
+
+    batch->RemoveComponent(component);
+    if (batch->IsEmpty())
+    {
+        renderProxies.OnBatchRemoved(batch);
+        delete batch;
+        batches.erase(it);
+    }
+}
+
+void BatchManager::CompactBatches()
+{
+    for (GeometryBatch* it : batches)
+        it->Compact();
+}
+
+void BatchManager::SetStaticBatching(bool enabled)
+{
+    staticBatching = enabled;
+    for (GeometryBatch* it : batches)
+        it->SetStaticBatching(enabled);
+}
+
+void BatchManager::OnMaterialUpdated(const ResourceMaterial* material)
+{
+    for (GeometryBatch* it : batches)
+        it->OnMaterialUpdated(material);
+}
+
 void BatchManager::LoadData()
 {
     for (GeometryBatch* it : batches)
         it->LoadData();
 }
 
-void BatchManager::Render(const std::vector<MeshComponent*>& meshesToRender, CameraComponent* camera)
+void BatchManager::Render(CameraComponent* camera)
 {
 #ifdef OPTICK
     OPTICK_CATEGORY("BatchManager::Render", Optick::Category::Rendering)
@@ -68,43 +108,74 @@ void BatchManager::Render(const std::vector<MeshComponent*>& meshesToRender, Cam
     if (camera == nullptr) cameraUBO = App->GetCameraModule()->GetUbo();
     else cameraUBO = camera->GetUbo();
 
+    const FrustumPlanes& frustumPlanes =
+        camera == nullptr ? App->GetCameraModule()->GetFrustrumPlanes() : camera->GetFrustrumPlanes();
+    const float4x4& projection =
+        camera == nullptr ? App->GetCameraModule()->GetProjectionMatrix() : camera->GetProjectionMatrix();
+    const float3& cameraPosition =
+        camera == nullptr ? App->GetCameraModule()->GetCameraPosition() : camera->GetCameraPosition();
+
+    // Only the proxies are read, never the scene. Each camera keeps its own levels of detail, the hysteresis of one
+    // doesn't move the others
+    renderProxies.Cull(frustumPlanes, projection, cameraPosition, cameraLodLevels[camera], visibleProxies);
+    SortVisibleProxies(cameraPosition);
+
+    // Single pass bucketing of the sorted proxies into the list each batch keeps between frames, in the same order
     for (GeometryBatch* it : batches)
-    {
-        std::vector<MeshComponent*> batchMeshes;
-        for (MeshComponent* mesh : meshesToRender)
-        {
-            GameObject* owner = mesh->GetParent();
-            if (!owner || !owner->IsGloballyEnabled()) continue;
+        it->ClearVisibleMeshes();
 
-            if (mesh->GetBatch() == it) batchMeshes.push_back(mesh);
-        }
+    for (const VisibleProxy& visible : visibleProxies)
+        visible.proxy->batch->AddVisibleMesh(visible);
 
-        if (batchMeshes.empty()) continue;
+    OpenGLModule* openGLModule = App->GetOpenGLModule();
+    RenderState* renderState   = openGLModule->GetRenderState();
 
-        const unsigned int program = it->GetIsMetallic() ? App->GetShaderModule()->GetMetallicGeometryPassProgram()
-                                                         : App->GetShaderModule()->GetSpecularGeometryPassProgram();
+    // Every program reads the camera from the same binding point
+    renderState->BindBufferBase(GL_UNIFORM_BUFFER, 0, cameraUBO);
 
-        const auto start           = std::chrono::high_resolution_clock::now();
+    batchStats.resize(batches.size());
+
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        GeometryBatch* it                             = batches[i];
+        BatchRenderStats& stats                       = batchStats[i];
+        stats                                         = BatchRenderStats();
+        stats.vertexOccupancy                         = it->GetVertexArena().GetOccupancy();
+        stats.indexOccupancy                          = it->GetIndexArena().GetOccupancy();
+        stats.fragmentation                           = it->GetArenaFragmentation();
 
-        glUseProgram(program);
+        const std::vector<VisibleProxy>& meshes       = it->GetVisibleMeshes();
+        if (meshes.empty()) continue;
 
-        glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
-        unsigned int blockIdx = glGetUniformBlockIndex(program, "CameraMatrices");
-        glUniformBlockBinding(program, blockIdx, 0);
-        glBindBufferBase(GL_UNIFORM_BUFFER, 0, cameraUBO);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        const auto start           = std::chrono::high_resolution_clock::now();
 
-        it->ResetUpdatedOnce();
-        it->Render(batchMeshes);
+        const unsigned int program = it->GetIsMetallic() ? App->GetShaderModule()->GetMetallicGeometryPassProgram()
+                                                         : App->GetShaderModule()->GetSpecularGeometryPassProgram();
 
-        const auto end                             = std::chrono::high_resolution_clock::now();
-        const std::chrono::duration<float> elapsed = end - start;
+        renderState->UseProgram(program);
+        BindCameraBlock(program);
 
-        const unsigned int vertexCount             = it->GetVertexCount();
-        const int meshTriangles                    = vertexCount / 3;
-        App->GetOpenGLModule()->AddTrianglesPerSecond(meshTriangles / elapsed.count());
-        App->GetOpenGLModule()->AddVerticesCount(vertexCount);
-        App->GetOpenGLModule()->AddDrawCallsCount();
+        it->ResetUpdatedOnce();
+        it->Render(*renderState, meshes, frustumPlanes, cameraPosition);
+
+        const auto end                                         = std::chrono::high_resolution_clock::now();
+        const std::chrono::duration<float, std::milli> elapsed = end - start;
+
+        stats.meshCount                                        = static_cast<unsigned int>(meshes.size());
+        stats.triangleCount                                    = it->GetIndexCount() / 3;
+        stats.vertexCount                                      = it->GetVertexCount();
+        stats.submissionTime                                   = elapsed.count();
+        stats.stallTime                                        = it->GetStallTime();
+        stats.bufferDepth                                      = it->GetBufferDepth();
+        stats.modelUploads                                     = it->GetModelUploadCount();
+        stats.boneUploads                                      = it->GetBoneUploadCount();
+        stats.staticChunks                                     = it->GetStaticChunkCount();
+
+        openGLModule->AddTrianglesCount(stats.triangleCount);
+        openGLModule->AddVerticesCount(stats.vertexCount);
+        openGLModule->AddBatchSubmissionTime(stats.submissionTime);
+        openGLModule->AddBufferStallTime(stats.stallTime);
+        openGLModule->AddDrawCallsCount();
     }
 }
 
@@ -121,7 +192,7 @@ GeometryBatch* BatchManager::RequestBatch(const MeshComponent* component)
     for (GeometryBatch* it : batches)
     {
         if (it->GetMode() == mesh->GetMode() && it->GetIsMetallic() == material->GetIsMetallicRoughness() &&
-            it->GetHasBones() == component->GetHasBones())
+            it->GetHasBones() == component->GetHasBones() && it->GetIsCompact() == mesh->IsCompact())
         {
             return it;
         }
@@ -132,7 +203,51 @@ GeometryBatch* BatchManager::RequestBatch(const MeshComponent* component)
 
 GeometryBatch* BatchManager::CreateNewBatch(const MeshComponent* component)
 {
-    GeometryBatch* newBatch = new GeometryBatch(component);
+    GeometryBatch* newBatch = new GeometryBatch(component, &renderProxies);
+    newBatch->SetStaticBatching(staticBatching);
     batches.push_back(newBatch);
     return newBatch;
 }
+
+void BatchManager::SortVisibleProxies(const float3& cameraPosition)
+{
+#ifdef OPTICK
+    OPTICK_CATEGORY("BatchManager::SortVisibleProxies", Optick::Category::Rendering)
+#endif
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < batches.size(); ++i)
+        batches[i]->SetSortIndex(static_cast<unsigned int>(i));
+
+    // Every mesh is opaque in the geometry pass, the closest ones fill the depth buffer first
+    drawSortEntries.resize(visibleProxies.size());
+    for (size_t i = 0; i < visibleProxies.size(); ++i)
+    {
+        const RenderProxy* proxy = visibleProxies[i].proxy;
+        const float depth        = proxy->bounds.CenterPoint().DistanceSq(cameraPosition); // Same order, no root
+        const uint32_t material  = proxy->material ? static_cast<uint32_t>(proxy->material->GetUID()) : 0;
+        drawSortEntries[i]       = {
+            MakeDrawSortKey(DrawLayer::Opaque, proxy->batch->GetSortIndex(), depth, material),
+            static_cast<unsigned int>(i)
+        };
+    }
+    drawSorter.Sort(drawSortEntries);
+
+    sortedProxies.resize(visibleProxies.size());
+    for (size_t i = 0; i < drawSortEntries.size(); ++i)
+        sortedProxies[i] = visibleProxies[drawSortEntries[i].draw];
+    visibleProxies.swap(sortedProxies);
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    sortTime                                               = elapsed.count();
+}
+
+void BatchManager::BindCameraBlock(unsigned int program)
+{
+    // The block binding is program state, it only has to be set the first time the program is used
+    if (cameraBlockIndices.find(program) != cameraBlockIndices.end()) return;
+
+    const unsigned int blockIdx = glGetUniformBlockIndex(program, "CameraMatrices");
+    glUniformBlockBinding(program, blockIdx, 0);
+    cameraBlockIndices[program] = blockIdx;
+}
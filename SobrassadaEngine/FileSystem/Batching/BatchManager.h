@@ -1,10 +1,31 @@
 #pragma once
 
+#include "DrawSortKeys.h"
+#include "RenderProxies.h"
+
+#include <unordered_map>
 #include <vector>
 
 class GeometryBatch;
 class MeshComponent;
 class CameraComponent;
+class ResourceMaterial;
+
+struct BatchRenderStats
+{
+    unsigned int meshCount     = 0;
+    unsigned int triangleCount = 0;
+    unsigned int vertexCount   = 0;
+    float submissionTime       = 0.f; // CPU milliseconds spent submitting the batch
+    float stallTime            = 0.f; // Part of the submission waiting for the GPU to release a buffer
+    unsigned int bufferDepth   = 0;   // Regions in the ring of the per component buffers
+    std::size_t modelUploads   = 0;   // Model matrices written this frame
+    std::size_t boneUploads    = 0;   // Palette matrices written this frame, shared poses are written once
+    std::size_t staticChunks   = 0;   // Merged world space chunks of static meshes
+    float vertexOccupancy      = 0.f; // Used fraction of the vertex arena
+    float indexOccupancy       = 0.f; // Used fraction of the index arena
+    float fragmentation        = 0.f; // Worst free space fragmentation of both arenas
+};
 
 class BatchManager
 {
@@ -14,14 +35,52 @@ class BatchManager
 
     void UnloadAllBatches();
     void RemoveBatch(GeometryBatch* batch);
+    // Removes the component from its shared batch, deleting the batch when it becomes empty
+    void RemoveComponent(GeometryBatch* batch, const MeshComponent* component);
+    void CompactBatches();
+    // Merges the static meshes of every batch by material and area. Off, they are drawn one by one and can be edited
+    void SetStaticBatching(bool enabled);
+    bool GetStaticBatching() const { return staticBatching; }
+    // Every batch using the material sends it again
+    void OnMaterialUpdated(const ResourceMaterial* material);
 
     void LoadData();
-    void Render(const std::vector<MeshComponent*>& meshesToRender, CameraComponent* camera);
+    // Culls the render proxies against the camera and draws the visible ones of every batch
+    void Render(CameraComponent* camera);
 
     GeometryBatch* RequestBatch(const MeshComponent* mesh);
 
     GeometryBatch* CreateNewBatch(const MeshComponent* mesh);
 
+    const std::vector<BatchRenderStats>& GetBatchStats() const { return batchStats; }
+    RenderProxies& GetRenderProxies() { return renderProxies; }
+    std::size_t GetSortedDrawCount() const { return visibleProxies.size(); }
+    float GetSortTime() const { return sortTime; }
+    // The name was given to a new program or deleted, the block index cached for it no longer applies
+    void ForgetProgram(unsigned int program) { cameraBlockIndices.erase(program); }
+    // The camera is being deleted, its levels of detail are dropped
+    void ForgetCamera(const CameraComponent* camera) { cameraLodLevels.erase(camera); }
+
+  private:
+    void BindCameraBlock(unsigned int program);
+    // Orders the visible proxies by their sort key, batch by batch and front to back
+    void SortVisibleProxies(const float3& cameraPosition);
+
   private:
     std::vector<GeometryBatch*> batches;
+    RenderProxies renderProxies;
+    std::vector<VisibleProxy> visibleProxies;                       // Culled every frame, keeps its capacity
+    std::vector<VisibleProxy> sortedProxies;
+    std::vector<DrawSortEntry> drawSortEntries;
+    DrawSorter drawSorter;
+    float sortTime = 0.f;                                           // CPU milliseconds spent sorting the last frame
+    std::vector<BatchRenderStats> batchStats;                       // Last frame stats, same order as batches
+    std::unordered_map<unsigned int, unsigned int> cameraBlockIndices; // Program -> CameraMatrices block index
+    // Camera -> level of detail of every proxy handle, last frame. The editor camera is nullptr
+    std::unordered_map<const CameraComponent*, std::vector<unsigned int>> cameraLodLevels;
+#ifdef GAME
+    bool staticBatching = true;
+#else
+    bool staticBatching = false;
+#endif
 };
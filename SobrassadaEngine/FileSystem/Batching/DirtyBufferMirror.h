@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+struct DirtyRange
+{
+    size_t first = 0; // First dirty element
+    size_t count = 0; // Number of dirty elements
+};
+
+// CPU copy of a GPU buffer made of fixed size slots. Writing a slot only marks it dirty when its content changes, and
+// dirty slots are merged into ranges so the owner only uploads what changed since the last upload. It does not touch
+// OpenGL, the owner is responsible for uploading the dirty ranges and calling ClearDirty afterwards
+template <typename T> class DirtyBufferMirror
+{
+  public:
+    DirtyBufferMirror(size_t mergeDistance = 4) : mergeDistance(mergeDistance) {}
+
+    // Changing the size invalidates the GPU copy, the whole buffer becomes dirty
+    void Resize(size_t count);
+    bool Set(size_t slot, const T& value);
+    void MarkAllDirty();
+    void ClearDirty() { dirtyRanges.clear(); }
+
+    size_t GetSize() const { return elements.size(); }
+    size_t GetSizeInBytes() const { return elements.size() * sizeof(T); }
+    const T* GetData() const { return elements.data(); }
+    const T& operator[](size_t slot) const { return elements[slot]; }
+    const std::vector<DirtyRange>& GetDirtyRanges() const { return dirtyRanges; }
+    bool IsDirty() const { return !dirtyRanges.empty(); }
+    // Slots covered by the dirty ranges, each one counted once when ranges overlap
+    size_t GetDirtyCount() const;
+
+  private:
+    void MarkDirty(size_t slot);
+
+  private:
+    std::vector<T> elements;
+    std::vector<DirtyRange> dirtyRanges;
+    size_t mergeDistance; // Clean slots between two dirty ones that are uploaded anyway to save a call
+};
+
+template <typename T> inline void DirtyBufferMirror<T>::Resize(size_t count)
+{
+    if (count == elements.size()) return;
+
+    elements.resize(count, T {});
+    MarkAllDirty();
+}
+
+template <typename T> inline bool DirtyBufferMirror<T>::Set(size_t slot, const T& value)
+{
+    // Slots are plain GPU data, a byte compare is enough to know if they changed
+    if (std::memcmp(&elements[slot], &value, sizeof(T)) == 0) return false;
+
+    elements[slot] = value;
+    MarkDirty(slot);
+    return true;
+}
+
+template <typename T> inline void DirtyBufferMirror<T>::MarkAllDirty()
+{
+    dirtyRanges.clear();
+    if (!elements.empty()) dirtyRanges.push_back({0, elements.size()});
+}
+
+template <typename T> inline size_t DirtyBufferMirror<T>::GetDirtyCount() const
+{
+    std::vector<DirtyRange> sortedRanges = dirtyRanges;
+    std::sort(
+        sortedRanges.begin(), sortedRanges.end(),
+        [](const DirtyRange& a, const DirtyRange& b) { return a.first < b.first; }
+    );
+
+    size_t dirtyCount = 0;
+    size_t countedEnd = 0; // End of the slots already counted
+    for (const DirtyRange& range : sortedRanges)
+    {
+        const size_t start = std::max(range.first, countedEnd);
+        const size_t end   = range.first + range.count;
+        if (end <= start) continue;
+
+        dirtyCount += end - start;
+        countedEnd  = end;
+    }
+    return dirtyCount;
+}
+
+template <typename T> inline void DirtyBufferMirror<T>::MarkDirty(size_t slot)
+{
+    if (!dirtyRanges.empty())
+    {
+        DirtyRange& last     = dirtyRanges.back();
+        const size_t lastEnd = last.first + last.count;
+
+        if (slot >= last.first && slot < lastEnd) return;
+        if (slot >= lastEnd && slot <= lastEnd + mergeDistance)
+        {
+            last.count = slot - last.first + 1;
+            return;
+        }
+    }
+
+    // Out of order writes just open a new range, overlapping ranges are still valid to upload
+    dirtyRanges.push_back({slot, 1});
+}
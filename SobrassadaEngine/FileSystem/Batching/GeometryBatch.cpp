@@ -1,49 +1,112 @@
 #include "GeometryBatch.h"
 
+#include "FrustumPlanes.h"
 #include "GameObject.h"
 #include "Globals.h"
 #include "Mesh.h"
+#include "RenderProxies.h"
+#include "RenderState.h"
 #include "ResourceMaterial.h"
 #include "ResourceMesh.h"
 #include "Standalone/MeshComponent.h"
+#include "VertexQuantization.h"
 
+#include "Geometry/Sphere.h"
+#include "Math/float3x3.h"
 #include "glew.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <tuple>
 #ifdef OPTICK
 #include "optick.h"
 #endif
 
-struct Command
+namespace
 {
-    unsigned int count;         // Number of indices in the mesh
-    unsigned int instanceCount; // Number of instances to render
-    unsigned int firstIndex;    // Index offset in the EBO
-    unsigned int baseVertex;    // Vertex offset in the VBO
-    unsigned int baseInstance;  // Instance Index
-};
+    // Grows the buffer when the mirror no longer fits, otherwise only the dirty ranges are sent
+    template <typename T>
+    void UploadDirtyRanges(GLenum target, GLuint buffer, DirtyBufferMirror<T>& mirror, std::size_t& bufferSize)
+    {
+        if (!mirror.IsDirty()) return;
+
+        glBindBuffer(target, buffer);
+        if (mirror.GetSizeInBytes() > bufferSize)
+        {
+            bufferSize = mirror.GetSizeInBytes();
+            glBufferData(target, bufferSize, mirror.GetData(), GL_DYNAMIC_DRAW);
+        }
+        else
+        {
+            for (const DirtyRange& range : mirror.GetDirtyRanges())
+            {
+                glBufferSubData(target, range.first * sizeof(T), range.count * sizeof(T), &mirror[range.first]);
+            }
+        }
+        mirror.ClearDirty();
+    }
+
+    // Moves the content of a buffer into a bigger one with a GPU side copy, the CPU data is not sent again
+    void ReallocateBuffer(GLuint& buffer, std::size_t oldSize, std::size_t newSize)
+    {
+        GLuint newBuffer = 0;
+        glGenBuffers(1, &newBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+        if (oldSize > 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+        }
+
+        glDeleteBuffers(1, &buffer);
+        buffer = newBuffer;
+    }
+
+    // Appends the original level of the mesh moved to world space, the same way the vertex shader would move it
+    void AppendWorldGeometry(
+        const ResourceMesh* resource, const float4x4& transform, std::vector<Vertex>& outVertices,
+        std::vector<unsigned int>& outIndices
+    )
+    {
+        const float3x3 normalMatrix     = transform.Float3x3Part().Inverted().Transposed();
+        const unsigned int firstVertex  = static_cast<unsigned int>(outVertices.size());
+
+        for (const Vertex& localVertex : resource->GetLocalVertices())
+        {
+            Vertex vertex   = localVertex;
+            vertex.position = transform.TransformPos(localVertex.position);
+            vertex.normal   = (normalMatrix * localVertex.normal).Normalized();
+            vertex.tangent  = float4((normalMatrix * localVertex.tangent.xyz()).Normalized(), localVertex.tangent.w);
+            outVertices.push_back(vertex);
+        }
+
+        for (const unsigned int index : resource->GetIndices())
+            outIndices.push_back(firstVertex + index);
+    }
+} // namespace
 
-GeometryBatch::GeometryBatch(const MeshComponent* component)
-    : totalVertexCount(0), totalIndexCount(0), currentBufferIndex(0)
+GeometryBatch::GeometryBatch(const MeshComponent* component, const RenderProxies* renderProxies)
+    : renderProxies(renderProxies), totalVertexCount(0), totalIndexCount(0)
 {
     mode       = component->GetResourceMesh()->GetMode();
     isMetallic = component->GetResourceMaterial()->GetIsMetallicRoughness();
     hasBones   = component->GetHasBones();
+    isCompact  = component->GetResourceMesh()->IsCompact();
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &indirect);
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
-    glGenBuffers(2, models);
-    if (hasBones)
-    {
-        glGenBuffers(2, bones);
-        glGenBuffers(1, &bonesIndex);
-    }
+    glGenBuffers(1, &staticModelsBuffer);
+    glGenBuffers(1, &modelSlotsBuffer);
+    if (hasBones) glGenBuffers(1, &bonesIndex);
     glGenBuffers(1, &materials);
-    gSync[0]     = nullptr;
-    gSync[1]     = nullptr;
-    ptrModels[0] = nullptr;
-    ptrModels[1] = nullptr;
-    ptrBones[0]  = nullptr;
-    ptrBones[1]  = nullptr;
+    glGenBuffers(1, &materialIndices);
+    glGenBuffers(1, &instanceIndices);
+    if (isCompact) glGenBuffers(1, &quantization);
+    if (isCompact && hasBones) glGenBuffers(1, &skinVbo);
 }
 
 GeometryBatch::~GeometryBatch()
@@ -52,291 +115,963 @@ GeometryBatch::~GeometryBatch()
     componentsMap.clear();
     uniqueMeshesMap.clear();
     uniqueMeshesCount.clear();
-    bonesCount.clear();
+    framePoses.clear();
 
-    CleanUp();
+    dynamicModels.Release();
+    bones.Release();
     glUseProgram(0);
     glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &indirect);
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ebo);
-    glDeleteBuffers(2, models);
-    glDeleteBuffers(2, bones);
+    glDeleteBuffers(1, &staticModelsBuffer);
+    glDeleteBuffers(1, &modelSlotsBuffer);
     glDeleteBuffers(1, &bonesIndex);
     glDeleteBuffers(1, &materials);
+    glDeleteBuffers(1, &materialIndices);
+    glDeleteBuffers(1, &instanceIndices);
+    glDeleteBuffers(1, &quantization);
+    glDeleteBuffers(1, &skinVbo);
 }
 
-void GeometryBatch::CleanUp()
+void GeometryBatch::LoadData()
 {
-    for (int i = 0; i < 2; i++)
+    if (isLoaded) return;
+
+    // Size the arenas for the meshes already added, so the first load never has to grow them
+    std::unordered_map<const ResourceMesh*, std::size_t> meshesToLoad;
+    unsigned int accVertexCount = 0;
+    unsigned int accIndexCount  = 0;
+    for (const MeshComponent* component : components)
     {
-        if (gSync[i])
-        {
-            glDeleteSync(gSync[i]);
-            gSync[i] = nullptr;
-        }
+        const ResourceMesh* resource = component->GetResourceMesh();
+        if (!meshesToLoad.emplace(resource, 0).second) continue;
 
-        if (ptrModels[i])
-        {
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, models[i]);
-            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-            ptrModels[i] = nullptr;
-        }
+        accVertexCount += resource->GetVertexCount();
+        accIndexCount  += resource->GetTotalIndexCount();
+    }
 
-        if (hasBones && ptrBones[i])
-        {
-            glBindBuffer(GL_SHADER_STORAGE_BUFFER, bones[i]);
-            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-            ptrBones[i] = nullptr;
-        }
+    vertexArena.Reset(accVertexCount);
+    indexArena.Reset(accIndexCount);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, accVertexCount * GetVertexSize(), nullptr, GL_STATIC_DRAW);
+    if (skinVbo)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, skinVbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, accVertexCount * sizeof(SkinVertex), nullptr, GL_STATIC_DRAW);
     }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, accIndexCount * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    BindVertexArrayBuffers();
+
+    for (const MeshComponent* component : components)
+    {
+        AddMeshGeometry(component->GetResourceMesh());
+        AddMaterial(component);
+    }
+
+    isLoaded = true;
+    RebuildInstanceData();
 }
 
-void GeometryBatch::LoadData()
+void GeometryBatch::AddComponent(const MeshComponent* component)
 {
-    std::vector<Vertex> totalVertices;
-    std::vector<unsigned int> totalIndices;
-    std::vector<float4x4> totalModels;
-    std::vector<MaterialGPU> totalMaterials;
+    if (componentsMap.find(component) != componentsMap.end()) return;
 
-    unsigned int accVertexCount = 0;
-    unsigned int accIndexCount  = 0;
-    unsigned int accBonesCount  = 0;
-    for (const auto& component : components)
+    componentsMap[component] = components.size();
+    components.push_back(component);
+
+    if (!isLoaded) return;
+
+    AddMeshGeometry(component->GetResourceMesh());
+    AddMaterial(component);
+    instanceDataDirty = true;
+    MarkStaticChunksDirty();
+}
+
+void GeometryBatch::RemoveComponent(const MeshComponent* component)
+{
+    const auto it = componentsMap.find(component);
+    if (it == componentsMap.end()) return;
+
+    // Swap with the last one so the components stay contiguous
+    const std::size_t index = it->second;
+    componentsMap.erase(it);
+    if (index != components.size() - 1)
     {
-        const ResourceMesh* resource = component->GetResourceMesh();
+        components[index]                = components.back();
+        componentsMap[components[index]] = index;
+    }
+    components.pop_back();
 
-        if (uniqueMeshesMap.find(resource) == uniqueMeshesMap.end())
-        {
-            const std::vector<Vertex>& vertices      = resource->GetLocalVertices();
-            const std::vector<unsigned int>& indices = resource->GetIndices();
-            totalVertices.insert(totalVertices.end(), vertices.begin(), vertices.end());
-            totalIndices.insert(totalIndices.end(), indices.begin(), indices.end());
-            uniqueMeshesMap[resource] = uniqueMeshesMap.size();
-
-            AccMeshCount newMeshCount;
-            newMeshCount.accVertexCount = accVertexCount;
-            newMeshCount.accIndexCount  = accIndexCount;
-            uniqueMeshesCount.push_back(newMeshCount);
-
-            accVertexCount += resource->GetVertexCount();
-            accIndexCount  += resource->GetIndexCount();
-        }
-        componentsMap[component] = componentsMap.size();
-        totalModels.push_back(component->GetCombinedMatrix());
-        totalMaterials.push_back(component->GetResourceMaterial()->GetMaterial());
+    if (!isLoaded) return;
+
+    // Its chunk would keep drawing it
+    if (mergedComponents.find(component) != mergedComponents.end())
+    {
+        ClearStaticChunks();
+        MarkStaticChunksDirty();
+    }
+
+    RemoveMeshGeometry(component->GetResourceMesh());
+    RemoveMaterial(component);
+    instanceDataDirty = true;
+}
+
+void GeometryBatch::Compact()
+{
+    if (!isLoaded || (vertexArena.GetFreeSize() == 0 && indexArena.GetFreeSize() == 0)) return;
+
+    // Chunks are built again in the packed arenas
+    ClearStaticChunks();
+    MarkStaticChunksDirty();
+
+    const unsigned int usedVertices = vertexArena.GetUsedSize();
+    const unsigned int usedIndices  = indexArena.GetUsedSize();
+    vertexArena.Reset(usedVertices);
+    indexArena.Reset(usedIndices);
+
+    // Same buffer names, the VAO does not need to be set up again
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, usedVertices * GetVertexSize(), nullptr, GL_STATIC_DRAW);
+    if (skinVbo)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, skinVbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, usedVertices * sizeof(SkinVertex), nullptr, GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, usedIndices * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    for (const auto& uniqueMesh : uniqueMeshesMap)
+    {
+        AccMeshCount& meshCount  = uniqueMeshesCount[uniqueMesh.second];
+        meshCount.accVertexCount = vertexArena.Allocate(meshCount.vertexCount);
+        meshCount.accIndexCount  = indexArena.Allocate(meshCount.indexCount);
+        UploadMeshGeometry(uniqueMesh.first, meshCount);
+    }
+}
+
+void GeometryBatch::OnTransformUpdated(const MeshComponent* component)
+{
+    // Merged components are in world space in their chunk
+    if (!mergedComponents.empty() && mergedComponents.find(component) != mergedComponents.end())
+        MarkStaticChunksDirty();
+
+    // Rebuilding the instance data writes every matrix
+    if (!isLoaded || instanceDataDirty) return;
+
+    const auto it = componentsMap.find(component);
+    if (it == componentsMap.end() || (modelSlots[it->second] & DYNAMIC_MODEL_BIT)) return;
+
+    staticModels.Set(it->second, component->GetCombinedMatrix());
+}
+
+void GeometryBatch::OnMaterialUpdated(const ResourceMaterial* material)
+{
+    const auto it = materialsMap.find(material->GetUID());
+    if (it != materialsMap.end()) materialTable.Set(it->second, material->GetMaterial());
+}
+
+void GeometryBatch::AddMaterial(const MeshComponent* component)
+{
+    const ResourceMaterial* material = component->GetResourceMaterial();
+    const auto it                    = materialsMap.find(material->GetUID());
+    if (it != materialsMap.end())
+    {
+        ++materialSlots[it->second].references;
+        componentMaterials[component] = it->second;
+        return;
+    }
+
+    std::size_t slot = materialSlots.size();
+    if (!freeMaterialSlots.empty())
+    {
+        slot = freeMaterialSlots.back();
+        freeMaterialSlots.pop_back();
+    }
+    else
+    {
+        materialSlots.emplace_back();
+        materialTable.Resize(materialSlots.size());
+    }
+
+    materialSlots[slot]              = {material->GetUID(), 1};
+    materialsMap[material->GetUID()] = slot;
+    componentMaterials[component]    = slot;
+    materialTable.Set(slot, material->GetMaterial());
+}
+
+void GeometryBatch::RemoveMaterial(const MeshComponent* component)
+{
+    // The component may have changed its material already, the slot it was added with is released
+    const auto it = componentMaterials.find(component);
+    if (it == componentMaterials.end()) return;
+
+    MaterialSlot& materialSlot = materialSlots[it->second];
+    if (--materialSlot.references == 0)
+    {
+        materialsMap.erase(materialSlot.uid);
+        freeMaterialSlots.push_back(it->second);
+        materialSlot = MaterialSlot();
+    }
+    componentMaterials.erase(it);
+}
+
+void GeometryBatch::SetStaticBatching(bool enabled)
+{
+    if (staticBatching == enabled) return;
+
+    // Built or reverted before the next frame
+    staticBatching    = enabled;
+    staticChunksDirty = true;
+}
+
+void GeometryBatch::BuildStaticChunks()
+{
+    staticChunksDirty = false;
+    ClearStaticChunks();
+
+    // Skinned meshes are placed by their bones every frame, they can't be baked in world space
+    if (!staticBatching || !isLoaded || hasBones) return;
+
+    // Ordered, a scene always gives the same chunks
+    std::map<std::tuple<std::size_t, int, int, int>, std::vector<const MeshComponent*>> cells;
+    constexpr unsigned int mergedFlags = RENDER_PROXY_ENABLED | RENDER_PROXY_STATIC;
+    for (const MeshComponent* component : components)
+    {
+        const RenderProxy* proxy = FindProxy(component);
+        if (proxy == nullptr || (proxy->flags & mergedFlags) != mergedFlags) continue;
 
-        if (hasBones)
+        const float3 center = proxy->bounds.CenterPoint();
+        if (!center.IsFinite()) continue;
+
+        const int cellX = static_cast<int>(std::floor(center.x / STATIC_CHUNK_SIZE));
+        const int cellY = static_cast<int>(std::floor(center.y / STATIC_CHUNK_SIZE));
+        const int cellZ = static_cast<int>(std::floor(center.z / STATIC_CHUNK_SIZE));
+        cells[{componentMaterials[component], cellX, cellY, cellZ}].push_back(component);
+    }
+
+    std::vector<const MeshComponent*> chunkComponents;
+    for (const auto& cell : cells)
+    {
+        // A lone component already takes a single command
+        if (cell.second.size() < 2) continue;
+
+        const std::size_t materialSlot = std::get<0>(cell.first);
+        unsigned int chunkVertices     = 0;
+        chunkComponents.clear();
+        for (const MeshComponent* component : cell.second)
         {
-            bonesCount.push_back(accBonesCount);
-            accBonesCount += static_cast<unsigned int>(component->GetBindMatrices().size());
+            const unsigned int vertexCount = component->GetResourceMesh()->GetVertexCount();
+            if (!chunkComponents.empty() && chunkVertices + vertexCount > STATIC_CHUNK_MAX_VERTICES)
+            {
+                BuildStaticChunk(materialSlot, chunkComponents);
+                chunkComponents.clear();
+                chunkVertices = 0;
+            }
+
+            chunkComponents.push_back(component);
+            chunkVertices += vertexCount;
         }
+        BuildStaticChunk(materialSlot, chunkComponents);
     }
 
-    glBindVertexArray(vao);
+    instanceDataDirty = true;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, totalVertices.size() * sizeof(Vertex), totalVertices.data(), GL_STATIC_DRAW);
+void GeometryBatch::BuildStaticChunk(std::size_t materialSlot, const std::vector<const MeshComponent*>& chunkComponents)
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for (const MeshComponent* component : chunkComponents)
+        AppendWorldGeometry(component->GetResourceMesh(), FindProxy(component)->model, vertices, indices);
+
+    if (indices.empty()) return;
+
+    StaticChunk chunk;
+    chunk.components    = chunkComponents;
+    chunk.materialSlot  = materialSlot;
+    chunk.instanceIndex = 0; // Given when the instance data is rebuilt
+    chunk.vertexCount   = static_cast<unsigned int>(vertices.size());
+    chunk.indexCount    = static_cast<unsigned int>(indices.size());
+    chunk.firstVertex   = AllocateVertices(chunk.vertexCount);
+    chunk.firstIndex    = AllocateIndices(chunk.indexCount);
+    chunk.commandSlot   = AllocateCommands(1);
+    chunk.bounds        = VertexQuantization::ComputeBounds(vertices);
+
+    const std::size_t vertexSize = GetVertexSize();
+    const void* vertexData       = vertices.data();
+    std::vector<CompactVertex> compactVertices;
+    if (isCompact)
+    {
+        VertexQuantization::Encode(vertices, chunk.bounds, compactVertices);
+        vertexData = compactVertices.data();
+    }
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, chunk.firstVertex * vertexSize, chunk.vertexCount * vertexSize, vertexData);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER, chunk.firstIndex * sizeof(unsigned int), chunk.indexCount * sizeof(unsigned int),
+        indices.data()
+    );
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+    for (const MeshComponent* component : chunkComponents)
+        mergedComponents[component] = staticChunks.size();
+    staticChunks.push_back(std::move(chunk));
+}
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+void GeometryBatch::ClearStaticChunks()
+{
+    if (staticChunks.empty()) return;
 
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    // The components are drawn one by one again
+    for (const StaticChunk& chunk : staticChunks)
+    {
+        vertexArena.Free(chunk.firstVertex, chunk.vertexCount);
+        indexArena.Free(chunk.firstIndex, chunk.indexCount);
+        commandArena.Free(chunk.commandSlot, 1);
+    }
 
-    glEnableVertexAttribArray(4);
-    glVertexAttribIPointer(4, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, joint));
+    staticChunks.clear();
+    mergedComponents.clear();
+    instanceDataDirty = true;
+}
 
-    glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, weights));
+unsigned int GeometryBatch::AllocateVertices(unsigned int count)
+{
+    unsigned int offset = vertexArena.Allocate(count);
+    if (offset == RangeAllocator::INVALID_OFFSET)
+    {
+        GrowVertexArena(count);
+        offset = vertexArena.Allocate(count);
+    }
+    return offset;
+}
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER, totalIndices.size() * sizeof(unsigned int), totalIndices.data(), GL_STATIC_DRAW
-    );
+unsigned int GeometryBatch::AllocateIndices(unsigned int count)
+{
+    unsigned int offset = indexArena.Allocate(count);
+    if (offset == RangeAllocator::INVALID_OFFSET)
+    {
+        GrowIndexArena(count);
+        offset = indexArena.Allocate(count);
+    }
+    return offset;
+}
 
-    glBindVertexArray(0);
+unsigned int GeometryBatch::AllocateCommands(unsigned int count)
+{
+    unsigned int offset = commandArena.Allocate(count);
+    if (offset == RangeAllocator::INVALID_OFFSET)
+    {
+        GrowCommandArena(count);
+        offset = commandArena.Allocate(count);
+    }
+    return offset;
+}
 
-    modelsSize             = totalModels.size() * sizeof(float4x4);
-    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
-    for (int i = 0; i < 2; i++)
+void GeometryBatch::AddMeshGeometry(const ResourceMesh* resource)
+{
+    const auto it = uniqueMeshesMap.find(resource);
+    if (it != uniqueMeshesMap.end())
     {
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, models[i]);
+        ++uniqueMeshesCount[it->second].references;
+        return;
+    }
+
+    AccMeshCount newMeshCount;
+    newMeshCount.vertexCount    = static_cast<unsigned int>(resource->GetVertexCount());
+    newMeshCount.indexCount     = resource->GetTotalIndexCount();
+    newMeshCount.references     = 1;
+    newMeshCount.lodCount       = resource->GetLODCount();
+    newMeshCount.resource       = resource;
+    newMeshCount.commandCount   = MAX_MESH_LODS + static_cast<unsigned int>(resource->GetMeshlets().size());
+    std::copy(resource->GetLODs().begin(), resource->GetLODs().end(), newMeshCount.lods);
+
+    newMeshCount.accVertexCount = AllocateVertices(newMeshCount.vertexCount);
+    newMeshCount.accIndexCount  = AllocateIndices(newMeshCount.indexCount);
+    newMeshCount.firstCommand   = AllocateCommands(newMeshCount.commandCount);
+
+    UploadMeshGeometry(resource, newMeshCount);
+
+    std::size_t slot = uniqueMeshesCount.size();
+    if (!freeMeshSlots.empty())
+    {
+        slot = freeMeshSlots.back();
+        freeMeshSlots.pop_back();
+        uniqueMeshesCount[slot] = newMeshCount;
+    }
+    else uniqueMeshesCount.push_back(newMeshCount);
+
+    uniqueMeshesMap[resource] = slot;
+}
+
+void GeometryBatch::RemoveMeshGeometry(const ResourceMesh* resource)
+{
+    const auto it = uniqueMeshesMap.find(resource);
+    if (it == uniqueMeshesMap.end()) return;
+
+    AccMeshCount& meshCount = uniqueMeshesCount[it->second];
+    if (--meshCount.references > 0) return;
+
+    vertexArena.Free(meshCount.accVertexCount, meshCount.vertexCount);
+    indexArena.Free(meshCount.accIndexCount, meshCount.indexCount);
+    commandArena.Free(meshCount.firstCommand, meshCount.commandCount);
+
+    meshCount = AccMeshCount();
+    freeMeshSlots.push_back(it->second);
+    uniqueMeshesMap.erase(it);
+}
 
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, modelsSize, nullptr, flags);
-        ptrModels[i] = (float4x4*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, modelsSize, flags);
+void GeometryBatch::UploadMeshGeometry(const ResourceMesh* resource, const AccMeshCount& meshCount) const
+{
+    const std::size_t vertexSize = GetVertexSize();
+    const void* vertexData       = isCompact ? static_cast<const void*>(resource->GetCompactVertices().data())
+                                             : static_cast<const void*>(resource->GetLocalVertices().data());
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER, meshCount.accVertexCount * vertexSize, meshCount.vertexCount * vertexSize, vertexData
+    );
 
-        if (ptrModels[i] == nullptr)
+    if (skinVbo)
+    {
+        // Both streams share baseVertex, meshes without skinning data get it bound to the first joint
+        std::vector<SkinVertex> defaultSkin;
+        const SkinVertex* skinData = resource->GetSkinVertices().data();
+        if (!resource->HasSkinStream())
         {
-            GLOG("Error mapping ssbo model %d", i);
-            return;
+            defaultSkin.resize(meshCount.vertexCount, VertexQuantization::GetDefaultSkinVertex());
+            skinData = defaultSkin.data();
         }
 
-        if (!hasBones) continue;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, skinVbo);
+        glBufferSubData(
+            GL_COPY_WRITE_BUFFER, meshCount.accVertexCount * sizeof(SkinVertex),
+            meshCount.vertexCount * sizeof(SkinVertex), skinData
+        );
+    }
+
+    // The simplified levels go right after the original indices
+    const std::size_t baseIndexCount = resource->GetIndices().size();
+    const std::size_t lodIndexCount  = resource->GetLODIndices().size();
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER, meshCount.accIndexCount * sizeof(unsigned int), baseIndexCount * sizeof(unsigned int),
+        resource->GetIndices().data()
+    );
+    if (lodIndexCount > 0)
+    {
+        glBufferSubData(
+            GL_COPY_WRITE_BUFFER, (meshCount.accIndexCount + baseIndexCount) * sizeof(unsigned int),
+            lodIndexCount * sizeof(unsigned int), resource->GetLODIndices().data()
+        );
+    }
+}
+
+void GeometryBatch::GrowVertexArena(unsigned int requiredVertices)
+{
+    const unsigned int oldCapacity = vertexArena.GetCapacity();
+    const unsigned int newCapacity = std::max(oldCapacity * 2, oldCapacity + requiredVertices);
+
+    ReallocateBuffer(vbo, oldCapacity * GetVertexSize(), newCapacity * GetVertexSize());
+    if (skinVbo) ReallocateBuffer(skinVbo, oldCapacity * sizeof(SkinVertex), newCapacity * sizeof(SkinVertex));
+    vertexArena.Grow(newCapacity);
+
+    BindVertexArrayBuffers();
+}
+
+void GeometryBatch::GrowIndexArena(unsigned int requiredIndices)
+{
+    const unsigned int oldCapacity = indexArena.GetCapacity();
+    const unsigned int newCapacity = std::max(oldCapacity * 2, oldCapacity + requiredIndices);
 
-        bonesSize = accBonesCount * sizeof(float4x4);
+    ReallocateBuffer(ebo, oldCapacity * sizeof(unsigned int), newCapacity * sizeof(unsigned int));
+    indexArena.Grow(newCapacity);
+
+    BindVertexArrayBuffers();
+}
 
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bones[i]);
+void GeometryBatch::GrowCommandArena(unsigned int requiredCommands)
+{
+    // Every slot can be drawn in the same frame, the draw commands mirror grows with them and is uploaded whole
+    const unsigned int oldCapacity = commandArena.GetCapacity();
+    const unsigned int newCapacity = std::max(oldCapacity * 2, oldCapacity + requiredCommands);
 
-        glBufferStorage(GL_SHADER_STORAGE_BUFFER, bonesSize, nullptr, flags);
-        ptrBones[i] = (float4x4*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, bonesSize, flags);
+    commandArena.Grow(newCapacity);
+    commands.resize(newCapacity);
+    drawCommands.Resize(newCapacity);
+}
 
-        if (ptrBones[i] == nullptr)
+void GeometryBatch::RebuildInstanceData()
+{
+    instanceDataDirty = false;
+
+    // Static chunks are instances after the components
+    const std::size_t instanceCount        = components.size() + staticChunks.size();
+    std::vector<float4> totalQuantization; // Bounds minimum and extent of every instance
+    materialIndexData.resize(instanceCount);
+    paletteOffsets.Resize(hasBones ? components.size() : 0);
+    staticModels.Resize(instanceCount);
+    modelSlots.resize(instanceCount);
+    dynamicCount = 0;
+
+    unsigned int accBonesCount = 0;
+    for (std::size_t index = 0; index < components.size(); ++index)
+    {
+        const MeshComponent* component = components[index];
+        componentsMap[component]       = index;
+        materialIndexData[index]       = static_cast<unsigned int>(componentMaterials[component]);
+
+        // Palettes of animated meshes are relative to their model, it follows the mobility of the object too. A
+        // component without a record yet is dynamic until UpdateBuffers sees its mobility
+        const RenderProxy* proxy = FindProxy(component);
+        if (proxy != nullptr && (proxy->flags & RENDER_PROXY_STATIC))
         {
-            GLOG("Error mapping ssbo bones %d", i);
-            return;
+            modelSlots[index] = static_cast<unsigned int>(index);
+            staticModels.Set(index, proxy->model);
         }
+        else modelSlots[index] = DYNAMIC_MODEL_BIT | dynamicCount++;
 
-        bonesIndexSize = bonesCount.size() * sizeof(unsigned int);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bonesIndex);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, bonesIndexSize, bonesCount.data(), GL_STATIC_DRAW);
+        if (isCompact)
+        {
+            const AABB& bounds = component->GetResourceMesh()->GetQuantizationBounds();
+            totalQuantization.push_back(float4(bounds.minPoint, 0.f));
+            totalQuantization.push_back(float4(bounds.Size(), 0.f));
+        }
+
+        if (hasBones) accBonesCount += static_cast<unsigned int>(component->GetBindMatrices().size());
+    }
+
+    for (std::size_t chunkIndex = 0; chunkIndex < staticChunks.size(); ++chunkIndex)
+    {
+        StaticChunk& chunk       = staticChunks[chunkIndex];
+        const std::size_t index  = components.size() + chunkIndex;
+        chunk.instanceIndex      = static_cast<unsigned int>(index);
+        materialIndexData[index] = static_cast<unsigned int>(chunk.materialSlot);
+        modelSlots[index]        = static_cast<unsigned int>(index);
+        staticModels.Set(index, float4x4::identity);
+
+        if (isCompact)
+        {
+            totalQuantization.push_back(float4(chunk.bounds.minPoint, 0.f));
+            totalQuantization.push_back(float4(chunk.bounds.Size(), 0.f));
+        }
     }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, materials);
+    visibleMeshes.reserve(components.size());
+    frameInstanceRemap.reserve(instanceCount);
+    instanceRemap.Resize(instanceCount);
+
+    // Persistent buffers have immutable storage, their regions are created again with the new size
+    bonesSize = hasBones ? accBonesCount * sizeof(float4x4) : 0;
+    dynamicModels.Allocate(dynamicCount * sizeof(float4x4));
+    bones.Allocate(bonesSize);
+    if (components.empty()) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, modelSlotsBuffer);
+    glBufferData(
+        GL_SHADER_STORAGE_BUFFER, modelSlots.size() * sizeof(unsigned int), modelSlots.data(), GL_STATIC_DRAW
+    );
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, materialIndices);
     glBufferData(
-        GL_SHADER_STORAGE_BUFFER, totalMaterials.size() * sizeof(MaterialGPU), totalMaterials.data(), GL_STATIC_DRAW
+        GL_SHADER_STORAGE_BUFFER, materialIndexData.size() * sizeof(unsigned int), materialIndexData.data(),
+        GL_STATIC_DRAW
     );
+
+    if (isCompact)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, quantization);
+        glBufferData(
+            GL_SHADER_STORAGE_BUFFER, totalQuantization.size() * sizeof(float4), totalQuantization.data(),
+            GL_STATIC_DRAW
+        );
+    }
 }
 
-void GeometryBatch::Render(const std::vector<MeshComponent*>& meshesToRender)
+const RenderProxy* GeometryBatch::FindProxy(const MeshComponent* component) const
 {
+    return renderProxies->Find(component->GetRenderProxy());
+}
+
+float GeometryBatch::GetArenaFragmentation() const
+{
+    return std::max(vertexArena.GetFragmentation(), indexArena.GetFragmentation());
+}
+
+std::size_t GeometryBatch::GetVertexSize() const
+{
+    return isCompact ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+void GeometryBatch::BindVertexArrayBuffers() const
+{
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    SetupVertexLayout();
+
+    if (skinVbo)
     {
-#ifdef OPTICK
-        OPTICK_CATEGORY("GeometryBatch::WaitBuffer", Optick::Category::Wait)
-#endif
-        WaitBuffer();
+        glBindBuffer(GL_ARRAY_BUFFER, skinVbo);
+
+        glEnableVertexAttribArray(4);
+        glVertexAttribIPointer(4, 4, GL_UNSIGNED_BYTE, sizeof(SkinVertex), (void*)offsetof(SkinVertex, joint));
+
+        glEnableVertexAttribArray(5);
+        glVertexAttribPointer(
+            5, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(SkinVertex), (void*)offsetof(SkinVertex, weights)
+        );
     }
 
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+    glBindVertexArray(0);
+}
+
+void GeometryBatch::SetupVertexLayout() const
+{
+    if (isCompact)
+    {
+        // Same locations as the full layout, the vertex shader decodes them when isCompact is set
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(
+            0, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, position)
+        );
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, tangent));
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, normal));
+
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(
+            3, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex), (void*)offsetof(CompactVertex, texCoord)
+        );
+        return;
+    }
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tangent));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, joint));
+
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, weights));
+}
+
+void GeometryBatch::Render(
+    RenderState& renderState, const std::vector<VisibleProxy>& meshesToRender, const FrustumPlanes& frustumPlanes,
+    const float3& cameraPosition
+)
+{
+    // Batches created after the scene was loaded, or whose components changed since the last frame
+    if (!isLoaded) LoadData();
+    if (staticChunksDirty) BuildStaticChunks();
+    if (instanceDataDirty) RebuildInstanceData();
+
 #ifdef OPTICK
     OPTICK_CATEGORY("GeometryBatch::Render", Optick::Category::Rendering)
 #endif
-    std::vector<Command> commands;
-    GenerateCommands(meshesToRender, commands);
+    GenerateCommands(meshesToRender, frustumPlanes, cameraPosition);
 
-    if (!updatedOnce) UpdateBuffers(meshesToRender);
+    if (!updatedOnce) UpdateBuffers(renderState, meshesToRender);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, materials);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, materials);
+    // Only the materials added or edited since the last frame are sent
+    UploadDirtyRanges(GL_SHADER_STORAGE_BUFFER, materials, materialTable, materialsSize);
+    renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, materials);
+    renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 18, materialIndices);
 
-    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect);
-    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(Command), commands.data(), GL_DYNAMIC_DRAW);
+    if (isCompact) renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, quantization);
+    renderState.SetUniform(5, isCompact ? 1 : 0);
 
-    glBindVertexArray(vao);
+    UploadDirtyRanges(GL_SHADER_STORAGE_BUFFER, instanceIndices, instanceRemap, instanceIndicesSize);
+    renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, instanceIndices);
 
+    UploadDirtyRanges(GL_DRAW_INDIRECT_BUFFER, indirect, drawCommands, indirectSize);
+
+    renderState.BindVertexArray(vao);
+
+    // Only the slots drawn this frame, the entries past them are left from earlier frames
     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect);
-    glMultiDrawElementsIndirect(
-        static_cast<GLenum>(mode), GL_UNSIGNED_INT, (GLvoid*)0, static_cast<GLsizei>(commands.size()), 0
+    renderState.MultiDrawElementsIndirect(
+        static_cast<GLenum>(mode), GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(frameSlots.size()), 0
     );
 
-    glBindVertexArray(0);
+    // The arena code binds vertex arrays on its own and leaves none bound
+    renderState.BindVertexArray(0);
 
     LockBuffer();
 }
 
-void GeometryBatch::GenerateCommands(const std::vector<MeshComponent*>& meshes, std::vector<Command>& commands)
+void GeometryBatch::GenerateCommands(
+    const std::vector<VisibleProxy>& meshes, const FrustumPlanes& frustumPlanes, const float3& cameraPosition
+)
 {
     totalVertexCount = 0;
     totalIndexCount  = 0;
 
-    for (const MeshComponent* component : meshes)
+    for (StaticChunk& chunk : staticChunks)
+        chunk.visible = false;
+
+    // Every visible component draws its level of detail, or the meshlets of it that survive culling
+    frameDraws.clear();
+    for (const VisibleProxy& visible : meshes)
+    {
+        const RenderProxy* proxy = visible.proxy;
+        if (!mergedComponents.empty())
+        {
+            // Merged components are drawn once by their chunk, however many of them are visible
+            const auto merged = mergedComponents.find(proxy->component);
+            if (merged != mergedComponents.end())
+            {
+                StaticChunk& chunk = staticChunks[merged->second];
+                if (!chunk.visible) frameDraws.push_back({chunk.commandSlot, chunk.instanceIndex});
+                chunk.visible = true;
+                continue;
+            }
+        }
+
+        // A proxy of a component or mesh not in this batch would be given slot 0 of both, it is left out instead
+        const auto component = componentsMap.find(proxy->component);
+        const auto mesh      = uniqueMeshesMap.find(proxy->mesh);
+        assert(component != componentsMap.end() && mesh != uniqueMeshesMap.end());
+        if (component == componentsMap.end() || mesh == uniqueMeshesMap.end()) continue;
+
+        const unsigned int componentIndex = static_cast<unsigned int>(component->second);
+        const AccMeshCount& meshCount     = uniqueMeshesCount[mesh->second];
+        const unsigned int lod            = GetLodLevel(visible.lodLevel, meshCount);
+        totalVertexCount                 += meshCount.vertexCount;
+
+        if (lod == 0 && meshCount.commandCount > MAX_MESH_LODS)
+            AddVisibleMeshlets(proxy, meshCount, componentIndex, frustumPlanes, cameraPosition);
+        else frameDraws.push_back({meshCount.firstCommand + lod, componentIndex});
+    }
+
+    // Count the visible instances of every command slot. The proxies come sorted by their draw key, so the slots are
+    // met in the order of the lowest key drawn with each of them
+    slotInstanceCounts.assign(commands.size(), 0);
+    slotInstanceOffsets.resize(commands.size());
+    frameSlots.clear();
+    for (const InstanceDraw& draw : frameDraws)
     {
-        const ResourceMesh* resource   = component->GetResourceMesh();
+        if (slotInstanceCounts[draw.commandSlot]++ == 0) frameSlots.push_back(draw.commandSlot);
+    }
+
+    // Index ranges of the slots of every mesh, whether they are drawn or not
+    for (const AccMeshCount& meshCount : uniqueMeshesCount)
+    {
+        if (meshCount.resource == nullptr) continue;
+
+        const std::vector<Meshlet>& meshlets = meshCount.resource->GetMeshlets();
+        for (unsigned int command = 0; command < meshCount.commandCount; ++command)
+        {
+            // Levels of detail the mesh does not have keep an empty command
+            MeshLOD range = {0, 0};
+            if (command < meshCount.lodCount) range = meshCount.lods[command];
+            else if (command >= MAX_MESH_LODS)
+            {
+                const Meshlet& meshlet = meshlets[command - MAX_MESH_LODS];
+                range                  = {meshlet.firstIndex, meshlet.indexCount};
+            }
+
+            Command& slotCommand   = commands[meshCount.firstCommand + command];
+            slotCommand.count      = range.indexCount;                           // Number of indices to draw
+            slotCommand.firstIndex = meshCount.accIndexCount + range.firstIndex; // Index offset in the EBO
+            slotCommand.baseVertex = meshCount.accVertexCount;                   // Vertex offset in the VBO
+        }
+    }
 
-        const unsigned int vertexCount = static_cast<unsigned int>(resource->GetVertexCount());
-        const unsigned int indexCount  = static_cast<unsigned int>(resource->GetIndexCount());
+    for (const StaticChunk& chunk : staticChunks)
+    {
+        // A chunk is a single instance, already in world space
+        Command& slotCommand   = commands[chunk.commandSlot];
+        slotCommand.count      = chunk.indexCount;
+        slotCommand.firstIndex = chunk.firstIndex;
+        slotCommand.baseVertex = chunk.firstVertex;
+
+        totalVertexCount      += chunk.vertexCount * slotInstanceCounts[chunk.commandSlot];
+    }
+
+    // Only the slots drawn this frame are sent, in order. The instances of each one take a contiguous range of the
+    // remap buffer
+    unsigned int accInstanceCount = 0;
+    for (std::size_t i = 0; i < frameSlots.size(); ++i)
+    {
+        const unsigned int slot   = frameSlots[i];
+        Command drawCommand       = commands[slot];
+        drawCommand.instanceCount = slotInstanceCounts[slot];
+        drawCommand.baseInstance  = accInstanceCount;
+        slotInstanceOffsets[slot] = accInstanceCount;
 
-        const std::size_t idx          = uniqueMeshesMap[resource];
+        totalIndexCount          += drawCommand.count * drawCommand.instanceCount;
+        accInstanceCount         += drawCommand.instanceCount;
 
-        Command newCommand;
-        newCommand.count          = indexCount;                            // Number of indices in the mesh
-        newCommand.instanceCount  = 1;                                     // Number of instances to render
-        newCommand.firstIndex     = uniqueMeshesCount[idx].accIndexCount;  // Index offset in the EBO
-        newCommand.baseVertex     = uniqueMeshesCount[idx].accVertexCount; // Vertex offset in the VBO
-        newCommand.baseInstance   = static_cast<unsigned int>(componentsMap[component]); // Instance Index
+        drawCommands.Set(i, drawCommand);
+    }
 
-        totalVertexCount         += vertexCount;
-        totalIndexCount          += indexCount;
+    // Scatter the component indices into the range of their slot
+    frameInstanceRemap.resize(frameDraws.size());
+    for (const InstanceDraw& draw : frameDraws)
+    {
+        frameInstanceRemap[slotInstanceOffsets[draw.commandSlot]++] = draw.componentIndex;
+    }
 
-        commands.push_back(newCommand);
+    // Meshlets can draw a component several times, the remap may need more entries than components
+    if (frameInstanceRemap.size() > instanceRemap.GetSize()) instanceRemap.Resize(frameInstanceRemap.size());
+
+    // Written in order so consecutive changes merge into the same dirty range
+    for (std::size_t i = 0; i < frameInstanceRemap.size(); ++i)
+    {
+        instanceRemap.Set(i, frameInstanceRemap[i]);
     }
 }
 
-void GeometryBatch::WaitBuffer()
+unsigned int GeometryBatch::GetLodLevel(unsigned int lodLevel, const AccMeshCount& meshCount) const
 {
-    if (gSync[currentBufferIndex])
+    // Components keep the level they were given even if their mesh has less of them
+    const unsigned int lodCount = std::max(meshCount.lodCount, 1u);
+    return std::min(lodLevel, lodCount - 1);
+}
+
+void GeometryBatch::AddVisibleMeshlets(
+    const RenderProxy* proxy, const AccMeshCount& meshCount, unsigned int componentIndex,
+    const FrustumPlanes& frustumPlanes, const float3& cameraPosition
+)
+{
+    const std::vector<Meshlet>& meshlets = meshCount.resource->GetMeshlets();
+    const float4x4& transform            = proxy->model;
+    const float scale                    = transform.GetScale().MaxElement();
+
+    for (unsigned int i = 0; i < meshlets.size(); ++i)
     {
-        while (1)
+        const Meshlet& meshlet = meshlets[i];
+
+        const Sphere bounds(transform.TransformPos(meshlet.center), meshlet.radius * scale);
+        if (!frustumPlanes.Intersects(bounds)) continue;
+
+        // Every triangle of the cluster faces away when the camera is inside the back cone
+        if (meshlet.coneCutoff < 1.f)
         {
-            GLenum waitReturn = glClientWaitSync(gSync[currentBufferIndex], GL_SYNC_FLUSH_COMMANDS_BIT, 1);
-            if (waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED) return;
+            const float3 axis     = transform.TransformDir(meshlet.coneAxis).Normalized();
+            const float3 toCenter = bounds.pos - cameraPosition;
+            if (toCenter.Dot(axis) >= meshlet.coneCutoff * toCenter.Length() + bounds.r) continue;
         }
+
+        frameDraws.push_back({meshCount.firstCommand + MAX_MESH_LODS + i, componentIndex});
     }
 }
 
-void GeometryBatch::UpdateBuffers(const std::vector<MeshComponent*>& meshesToRender)
+void GeometryBatch::UpdateBuffers(RenderState& renderState, const std::vector<VisibleProxy>& meshesToRender)
 {
-    updatedOnce               = true;
-    const int nextBufferIndex = (currentBufferIndex + 1) % 2;
+    updatedOnce = true;
 
+    // The regions of this frame are written and read by its draw, the fences keep the next frames off them
     if (hasBones)
     {
-        const GLuint nextBuffer    = bones[nextBufferIndex];
-        const GLuint currentBuffer = bones[currentBufferIndex];
-
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, nextBuffer);
-
-        for (const MeshComponent* component : meshesToRender)
+        float4x4* ptrBones = static_cast<float4x4*>(bones.Acquire());
+        boneUploadCount    = 0;
+        if (ptrBones)
         {
-            const std::size_t index                         = componentsMap[component];
-            const std::size_t accBones                      = bonesCount[index];
-            const std::vector<GameObject*>& bonesGameObject = component->GetBonesGO();
-            const std::vector<float4x4>& bindMatrices       = component->GetBindMatrices();
-            for (size_t i = 0; i < bonesGameObject.size(); ++i)
+            // The bones are objects of their own, they are still read from the scene. Only the first component seen
+            // in each pose reads them
+            framePoses.clear();
+            for (const VisibleProxy& visible : meshesToRender)
             {
-                ptrBones[nextBufferIndex][accBones + i] = bonesGameObject[i]->GetGlobalTransform() * bindMatrices[i];
+                const RenderProxy* proxy       = visible.proxy;
+                const MeshComponent* component = proxy->component;
+                const auto componentSlot       = componentsMap.find(component);
+                assert(componentSlot != componentsMap.end());
+                if (componentSlot == componentsMap.end()) continue;
+
+                const std::size_t index = componentSlot->second;
+
+                BonePoseKey poseKey;
+                if (component->GetBonePoseKey(poseKey))
+                {
+                    const auto pose = framePoses.find(poseKey);
+                    if (pose != framePoses.end())
+                    {
+                        paletteOffsets.Set(index, pose->second);
+                        continue;
+                    }
+                    framePoses.emplace(poseKey, static_cast<unsigned int>(boneUploadCount));
+                }
+
+                const std::vector<GameObject*>& bonesGameObject = component->GetBonesGO();
+                const std::vector<float4x4>& bindMatrices       = component->GetBindMatrices();
+                const float4x4 toModel                          = proxy->model.Inverted();
+                float4x4* palette                               = ptrBones + boneUploadCount;
+                for (size_t i = 0; i < bonesGameObject.size(); ++i)
+                {
+                    palette[i] = toModel * bonesGameObject[i]->GetGlobalTransform() * bindMatrices[i];
+                }
+
+                paletteOffsets.Set(index, static_cast<unsigned int>(boneUploadCount));
+                boneUploadCount += bonesGameObject.size();
             }
         }
-        glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
-
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, currentBuffer);
-        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 12, currentBuffer, 0, bonesSize);
+        UploadDirtyRanges(GL_SHADER_STORAGE_BUFFER, bonesIndex, paletteOffsets, bonesIndexSize);
 
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, bonesIndex);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, bonesIndex);
+        bones.Bind(renderState, 12);
+        renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, bonesIndex);
 
-        glUniform1i(4, 1); // mesh has bones
+        renderState.SetUniform(4, 1); // mesh has bones
     }
-    else glUniform1i(4, 0); // meshes has no bones
+    else renderState.SetUniform(4, 0); // meshes has no bones
 
-    const GLuint nextBuffer    = models[nextBufferIndex];
-    const GLuint currentBuffer = models[currentBufferIndex];
+    // Static matrices that changed since the last frame, whether they are visible or not
+    modelUploadCount = staticModels.GetDirtyCount();
+    UploadDirtyRanges(GL_SHADER_STORAGE_BUFFER, staticModelsBuffer, staticModels, staticModelsSize);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, nextBuffer);
-
-    for (const MeshComponent* component : meshesToRender)
+    float4x4* ptrDynamicModels = static_cast<float4x4*>(dynamicModels.Acquire());
+    for (const VisibleProxy& visible : meshesToRender)
     {
-        const std::size_t index           = componentsMap[component];
-        ptrModels[nextBufferIndex][index] = component->GetCombinedMatrix();
+        const RenderProxy* proxy = visible.proxy;
+        const auto component     = componentsMap.find(proxy->component);
+        assert(component != componentsMap.end());
+        if (component == componentsMap.end()) continue;
+
+        const unsigned int slot = modelSlots[component->second];
+        const bool isDynamic    = (slot & DYNAMIC_MODEL_BIT) != 0;
+        if (isDynamic && ptrDynamicModels)
+        {
+            ptrDynamicModels[slot & ~DYNAMIC_MODEL_BIT] = proxy->model;
+            ++modelUploadCount;
+        }
+
+        // The object changed its mobility, the slots are given again next frame
+        if (isDynamic == ((proxy->flags & RENDER_PROXY_STATIC) != 0))
+        {
+            instanceDataDirty = true;
+            MarkStaticChunksDirty();
+        }
     }
     glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, currentBuffer);
-    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 10, currentBuffer, 0, modelsSize);
-
-    currentBufferIndex = nextBufferIndex;
+    renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, staticModelsBuffer);
+    dynamicModels.Bind(renderState, 16);
+    renderState.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 17, modelSlotsBuffer);
 }
 
 void GeometryBatch::LockBuffer()
 {
-    if (gSync[currentBufferIndex])
-    {
-        glDeleteSync(gSync[currentBufferIndex]);
-    }
-    gSync[currentBufferIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    dynamicModels.Lock();
+    bones.Lock();
 }
\ No newline at end of file
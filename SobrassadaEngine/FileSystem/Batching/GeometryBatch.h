@@ -1,82 +1,257 @@
 #pragma once
 
+#include "DirtyBufferMirror.h"
+#include "Globals.h"
+#include "Mesh.h"
+#include "PersistentRingBuffer.h"
+#include "RangeAllocator.h"
+#include "RenderProxies.h"
+
+#include "Geometry/AABB.h"
 #include "Math/float4x4.h"
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
 class MeshComponent;
 class ResourceMesh;
+class ResourceMaterial;
 class MeshComponent;
-struct Command;
+class FrustumPlanes;
+class RenderState;
 struct MaterialGPU;
-typedef struct __GLsync* GLsync;
 typedef unsigned int GLuint;
 
+constexpr unsigned int DYNAMIC_MODEL_BIT         = 0x80000000u; // In the dynamic model buffer, the rest is the index
+constexpr float STATIC_CHUNK_SIZE                = 32.f;        // Side of the world cells static meshes are merged by
+constexpr unsigned int STATIC_CHUNK_MAX_VERTICES = 65536;
+
+struct MaterialSlot
+{
+    UID uid                 = INVALID_UID;
+    unsigned int references = 0; // Components using the material, the slot is reused at 0
+};
+
 struct AccMeshCount
 {
-    unsigned int accVertexCount;
-    unsigned int accIndexCount;
+    unsigned int accVertexCount;            // Offset of the mesh in the vertex arena
+    unsigned int accIndexCount;             // Offset of the mesh in the index arena
+    unsigned int vertexCount;
+    unsigned int indexCount;                // Indices of every level of detail, one after the other
+    unsigned int references      = 0;       // Components using the mesh, its ranges are freed at 0
+    unsigned int lodCount        = 0;
+    MeshLOD lods[MAX_MESH_LODS]  = {};
+    const ResourceMesh* resource = nullptr;
+    unsigned int firstCommand    = 0;       // A command per level of detail, then one per meshlet
+    unsigned int commandCount    = 0;
+};
+
+// Static components of the same material and world cell merged in world space and drawn with a single command. It
+// is drawn whole when any of its components survives culling
+struct StaticChunk
+{
+    std::vector<const MeshComponent*> components;
+    std::size_t materialSlot;
+    unsigned int instanceIndex; // Per instance data goes after the one of the components
+    unsigned int firstVertex;
+    unsigned int vertexCount;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    unsigned int commandSlot;
+    AABB bounds;                // Compact vertices are quantized against it
+    bool visible = false;
+};
+
+// Visible instance of a command slot this frame
+struct InstanceDraw
+{
+    unsigned int commandSlot;
+    unsigned int componentIndex;
+};
+
+struct Command
+{
+    unsigned int count;         // Number of indices in the mesh
+    unsigned int instanceCount; // Number of instances to render
+    unsigned int firstIndex;    // Index offset in the EBO
+    unsigned int baseVertex;    // Vertex offset in the VBO
+    unsigned int baseInstance;  // First entry of the instance remap buffer
 };
 
 class GeometryBatch
 {
   public:
-    GeometryBatch(const MeshComponent* component);
+    // The records of the components are read from the proxies, the batch does not go through the scene
+    GeometryBatch(const MeshComponent* component, const RenderProxies* renderProxies);
     ~GeometryBatch();
 
     void LoadData();
-    void Render(const std::vector<MeshComponent*>& meshesToRender);
+    // Meshlets of big meshes are culled against the camera before generating the commands
+    void Render(
+        RenderState& renderState, const std::vector<VisibleProxy>& meshesToRender, const FrustumPlanes& frustumPlanes,
+        const float3& cameraPosition
+    );
 
-    void AddComponent(const MeshComponent* component) { components.push_back(component); }
+    // Once loaded, the geometry of new meshes is appended to the arenas in place instead of rebuilding the batch
+    void AddComponent(const MeshComponent* component);
+    void RemoveComponent(const MeshComponent* component);
+    // Packs the arenas again, removing the holes left by removed meshes
+    void Compact();
+    // Static components only send their matrix again when it changes, dynamic ones send it every frame
+    void OnTransformUpdated(const MeshComponent* component);
+    // Sends the material again if a component of the batch uses it
+    void OnMaterialUpdated(const ResourceMaterial* material);
+    // Static batching merges the static components in chunks. Changes to merged components build them again
+    void SetStaticBatching(bool enabled);
+    void MarkStaticChunksDirty() { staticChunksDirty = staticBatching; }
+
+    void ClearVisibleMeshes() { visibleMeshes.clear(); }
+    void AddVisibleMesh(const VisibleProxy& visible) { visibleMeshes.push_back(visible); }
+    const std::vector<VisibleProxy>& GetVisibleMeshes() const { return visibleMeshes; }
 
     const unsigned int GetMode() const { return mode; }
     const bool GetIsMetallic() const { return isMetallic; }
     const bool GetHasBones() const { return hasBones; }
+    const bool GetIsCompact() const { return isCompact; }
+    const bool IsEmpty() const { return components.empty(); }
     const unsigned int GetVertexCount() const { return totalVertexCount; }
     const unsigned int GetIndexCount() const { return totalIndexCount; }
+    const unsigned int GetMaterialCount() const { return static_cast<unsigned int>(materialsMap.size()); }
+    const unsigned int GetStaticChunkCount() const { return static_cast<unsigned int>(staticChunks.size()); }
+    unsigned int GetSortIndex() const { return sortIndex; }
+    void SetSortIndex(unsigned int index) { sortIndex = index; }
+    const DirtyBufferMirror<Command>& GetDrawCommands() const { return drawCommands; }
+    const DirtyBufferMirror<unsigned int>& GetInstanceRemap() const { return instanceRemap; }
+    const RangeAllocator& GetVertexArena() const { return vertexArena; }
+    const RangeAllocator& GetIndexArena() const { return indexArena; }
+    float GetArenaFragmentation() const;
+    // CPU milliseconds the last frame waited for the GPU to release the per component buffers
+    float GetStallTime() const { return dynamicModels.GetStallTime() + bones.GetStallTime(); }
+    unsigned int GetBufferDepth() const { return std::max(dynamicModels.GetDepth(), bones.GetDepth()); }
+    std::size_t GetModelUploadCount() const { return modelUploadCount; }
+    std::size_t GetBoneUploadCount() const { return boneUploadCount; }
     void ResetUpdatedOnce() { updatedOnce = false; }
 
   private:
     void LockBuffer();
-    void UpdateBuffers(const std::vector<MeshComponent*>& meshesToRender);
-    void WaitBuffer();
+    void UpdateBuffers(RenderState& renderState, const std::vector<VisibleProxy>& meshesToRender);
 
-    void GenerateCommands(const std::vector<MeshComponent*>& meshes, std::vector<Command>& commands);
+    void GenerateCommands(
+        const std::vector<VisibleProxy>& meshes, const FrustumPlanes& frustumPlanes, const float3& cameraPosition
+    );
+    unsigned int GetLodLevel(unsigned int lodLevel, const AccMeshCount& meshCount) const;
+    void AddVisibleMeshlets(
+        const RenderProxy* proxy, const AccMeshCount& meshCount, unsigned int componentIndex,
+        const FrustumPlanes& frustumPlanes, const float3& cameraPosition
+    );
+    void SetupVertexLayout() const;
+    void BindVertexArrayBuffers() const;
+    std::size_t GetVertexSize() const;
 
-    void CleanUp();
+    void AddMaterial(const MeshComponent* component);
+    void RemoveMaterial(const MeshComponent* component);
+    unsigned int AllocateVertices(unsigned int count);
+    unsigned int AllocateIndices(unsigned int count);
+    unsigned int AllocateCommands(unsigned int count);
+    void BuildStaticChunks();
+    void BuildStaticChunk(std::size_t materialSlot, const std::vector<const MeshComponent*>& chunkComponents);
+    void ClearStaticChunks();
+    void AddMeshGeometry(const ResourceMesh* resource);
+    void RemoveMeshGeometry(const ResourceMesh* resource);
+    void UploadMeshGeometry(const ResourceMesh* resource, const AccMeshCount& meshCount) const;
+    void GrowVertexArena(unsigned int requiredVertices);
+    void GrowIndexArena(unsigned int requiredIndices);
+    void GrowCommandArena(unsigned int requiredCommands);
+    void RebuildInstanceData();
+    const RenderProxy* FindProxy(const MeshComponent* component) const;
 
   private:
+    const RenderProxies* renderProxies; // Owned by the BatchManager
     std::vector<const MeshComponent*> components;
     std::unordered_map<const MeshComponent*, std::size_t> componentsMap; // index of position added
+    std::vector<VisibleProxy> visibleMeshes; // Filled every frame by the BatchManager, keeps its capacity
 
+    // Every unique mesh owns a slot, slots of removed meshes are reused by the next ones
     std::unordered_map<const ResourceMesh*, std::size_t> uniqueMeshesMap;
     std::vector<AccMeshCount> uniqueMeshesCount;
+    std::vector<std::size_t> freeMeshSlots;
+
+    // Components sharing a material share its entry in the table, they read it through their material index
+    std::unordered_map<UID, std::size_t> materialsMap;
+    std::unordered_map<const MeshComponent*, std::size_t> componentMaterials; // Slot each component was added with
+    std::vector<MaterialSlot> materialSlots;
+    std::vector<std::size_t> freeMaterialSlots;
+    DirtyBufferMirror<MaterialGPU> materialTable;
+    std::vector<unsigned int> materialIndexData; // Material slot of every component
+
+    std::vector<StaticChunk> staticChunks;
+    std::unordered_map<const MeshComponent*, std::size_t> mergedComponents; // Chunk drawing each merged component
+
+    RangeAllocator vertexArena;
+    RangeAllocator indexArena;
+    RangeAllocator commandArena;
+
+    // Instancing data. Visible components sharing a mesh and level of detail (or meshlet) are drawn with a single
+    // command, the shader reads their component index from instanceRemap[baseInstance + gl_InstanceID]. Every unique
+    // mesh owns a fixed range of command slots. Each frame the slots with visible instances are sent as draw commands,
+    // in the order of the lowest sort key among their instances, and only the entries that changed are uploaded
+    std::vector<Command> commands; // Index ranges of every slot, the instance fields are only set in drawCommands
+    DirtyBufferMirror<Command> drawCommands;
+    DirtyBufferMirror<unsigned int> instanceRemap;
+    std::vector<InstanceDraw> frameDraws;
+    std::vector<unsigned int> frameSlots; // Slots drawn this frame, in draw order
+    std::vector<unsigned int> frameInstanceRemap;
+    std::vector<unsigned int> slotInstanceCounts;
+    std::vector<unsigned int> slotInstanceOffsets;
+
+    bool isLoaded                   = false;
+    bool instanceDataDirty          = false; // Components changed, per component buffers are rebuilt before rendering
+    bool updatedOnce                = false;
+    bool staticBatching             = false;
+    unsigned int sortIndex          = 0; // Position in the BatchManager, the batch field of the draw sort keys
+    bool staticChunksDirty          = false; // Built again before the next frame is rendered
+
+    // Models of static components, only the matrices that changed are sent. Dynamic components write theirs every
+    // frame in a ring, the GPU may still be reading the ones of previous frames. Every component has a model slot
+    // telling the shader where its matrix is
+    DirtyBufferMirror<float4x4> staticModels;
+    PersistentRingBuffer dynamicModels;
+    PersistentRingBuffer bones;
+    std::vector<unsigned int> modelSlots;
+    unsigned int dynamicCount       = 0;
+    std::size_t modelUploadCount    = 0; // Static matrices that changed and visible dynamic ones, last frame
+
+    GLuint staticModelsBuffer       = 0;
+    GLuint modelSlotsBuffer         = 0;
+    std::size_t staticModelsSize    = 0;
+
+    // Palettes of the visible skinned components are packed in the ring every frame, relative to their model.
+    // Components in a pose already written this frame point their palette offset at it instead of writing their own
+    GLuint bonesIndex               = 0;
+    std::size_t bonesSize           = 0; // Every palette of the batch, when no pose is shared
+    std::size_t bonesIndexSize      = 0;
+    DirtyBufferMirror<unsigned int> paletteOffsets;                            // Palette start of every component
+    std::unordered_map<BonePoseKey, unsigned int, BonePoseKeyHash> framePoses; // Palette offset of every pose
+    std::size_t boneUploadCount     = 0;                                       // Palette matrices written last frame
+
+    unsigned int totalVertexCount   = 0;
+    unsigned int totalIndexCount    = 0;
+
+    unsigned int indirect           = 0;
+    unsigned int vao                = 0;
+    unsigned int vbo                = 0;
+    unsigned int skinVbo            = 0; // Joints and weights, only for compact batches with bones
+    unsigned int ebo                = 0;
+    unsigned int materials          = 0;
+    unsigned int materialIndices    = 0;
+    std::size_t materialsSize       = 0;
+    unsigned int instanceIndices    = 0;
+    unsigned int quantization       = 0;
+    std::size_t indirectSize        = 0;
+    std::size_t instanceIndicesSize = 0;
 
-    bool updatedOnce           = false;
-    GLsync gSync[2]            = {nullptr, nullptr};
-    int currentBufferIndex     = 0;
-
-    GLuint models[2]           = {0, 0};
-    float4x4* ptrModels[2]     = {nullptr, nullptr};
-    std::size_t modelsSize     = 0;
-
-    GLuint bones[2]            = {0, 0};
-    GLuint bonesIndex          = 0;
-    float4x4* ptrBones[2]      = {nullptr, nullptr};
-    std::size_t bonesSize      = 0;
-    std::size_t bonesIndexSize = 0;
-    std::vector<unsigned int> bonesCount;
-
-    unsigned int totalVertexCount = 0;
-    unsigned int totalIndexCount  = 0;
-
-    unsigned int indirect         = 0;
-    unsigned int vao              = 0;
-    unsigned int vbo              = 0;
-    unsigned int ebo              = 0;
-    unsigned int materials        = 0;
-
-    unsigned int mode             = 0;
-    bool isMetallic               = false;
-    bool hasBones                 = false;
+    unsigned int mode               = 0;
+    bool isMetallic                 = false;
+    bool hasBones                   = false;
+    bool isCompact                  = false; // Vertices stored as CompactVertex
 };
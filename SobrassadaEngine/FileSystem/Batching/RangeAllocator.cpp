@@ -0,0 +1,94 @@
+#include "RangeAllocator.h"
+
+#include <algorithm>
+
+void RangeAllocator::Reset(unsigned int newCapacity)
+{
+    freeRanges.clear();
+    capacity = newCapacity;
+    usedSize = 0;
+
+    if (capacity > 0) freeRanges[0] = capacity;
+}
+
+void RangeAllocator::Grow(unsigned int newCapacity)
+{
+    if (newCapacity <= capacity) return;
+
+    const unsigned int oldCapacity = capacity;
+    capacity                       = newCapacity;
+    Free(oldCapacity, newCapacity - oldCapacity);
+
+    // The appended space was never allocated
+    usedSize += newCapacity - oldCapacity;
+}
+
+unsigned int RangeAllocator::Allocate(unsigned int size)
+{
+    if (size == 0) return 0;
+
+    auto bestFit = freeRanges.end();
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+    {
+        if (it->second < size) continue;
+        if (bestFit == freeRanges.end() || it->second < bestFit->second) bestFit = it;
+        if (bestFit->second == size) break;
+    }
+
+    if (bestFit == freeRanges.end()) return INVALID_OFFSET;
+
+    const unsigned int offset    = bestFit->first;
+    const unsigned int remaining = bestFit->second - size;
+    freeRanges.erase(bestFit);
+    if (remaining > 0) freeRanges[offset + size] = remaining;
+
+    usedSize += size;
+    return offset;
+}
+
+void RangeAllocator::Free(unsigned int offset, unsigned int size)
+{
+    if (size == 0 || offset == INVALID_OFFSET) return;
+
+    usedSize          -= size;
+
+    auto next          = freeRanges.lower_bound(offset);
+    unsigned int start = offset;
+    unsigned int end   = offset + size;
+
+    // Merge with the previous free range when they touch
+    if (next != freeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start)
+        {
+            start = previous->first;
+            freeRanges.erase(previous);
+        }
+    }
+
+    // And with the next one
+    if (next != freeRanges.end() && next->first == end)
+    {
+        end = next->first + next->second;
+        freeRanges.erase(next);
+    }
+
+    freeRanges[start] = end - start;
+}
+
+unsigned int RangeAllocator::GetLargestFreeRange() const
+{
+    unsigned int largest = 0;
+    for (const auto& range : freeRanges)
+        largest = std::max(largest, range.second);
+    return largest;
+}
+
+float RangeAllocator::GetFragmentation() const
+{
+    const unsigned int freeSize = GetFreeSize();
+    if (freeSize == 0) return 0.f;
+
+    return 1.f - static_cast<float>(GetLargestFreeRange()) / freeSize;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+// Free list allocator of element ranges inside a growable arena. It only does the bookkeeping, the owner keeps the
+// GPU buffer the offsets point into and grows it when Allocate fails
+class RangeAllocator
+{
+  public:
+    static constexpr unsigned int INVALID_OFFSET = ~0u;
+
+    RangeAllocator() = default;
+
+    void Reset(unsigned int newCapacity);
+    // Appends the new space at the end of the arena, keeping every allocation where it is
+    void Grow(unsigned int newCapacity);
+
+    // Best fit, returns INVALID_OFFSET when no free range is big enough
+    unsigned int Allocate(unsigned int size);
+    void Free(unsigned int offset, unsigned int size);
+
+    unsigned int GetCapacity() const { return capacity; }
+    unsigned int GetUsedSize() const { return usedSize; }
+    unsigned int GetFreeSize() const { return capacity - usedSize; }
+    unsigned int GetLargestFreeRange() const;
+    size_t GetFreeRangeCount() const { return freeRanges.size(); }
+
+    float GetOccupancy() const { return capacity > 0 ? static_cast<float>(usedSize) / capacity : 0.f; }
+    // 0 when all the free space is contiguous, close to 1 when it is split in many small ranges
+    float GetFragmentation() const;
+
+  private:
+    std::map<unsigned int, unsigned int> freeRanges; // Offset -> size, adjacent ranges are always merged
+    unsigned int capacity = 0;
+    unsigned int usedSize = 0;
+};
@@ -0,0 +1,111 @@
+#include "RenderProxies.h"
+
+#include "FrustumPlanes.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <functional>
+
+// Projected size under which each simplified level is used, relative to half of the screen height
+constexpr float LOD_SCREEN_SIZES[MAX_MESH_LODS - 1] = {0.25f, 0.12f, 0.05f};
+constexpr float LOD_HYSTERESIS                      = 0.1f;
+
+std::size_t BonePoseKeyHash::operator()(const BonePoseKey& key) const
+{
+    // Same mixing as boost::hash_combine
+    std::size_t hash   = std::hash<UID>()(key.model);
+    const auto combine = [&hash](std::size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+    combine(std::hash<int>()(key.skin));
+    combine(std::hash<const void*>()(key.mesh));
+    combine(std::hash<const void*>()(key.clip));
+    combine(std::hash<float>()(key.time));
+    return hash;
+}
+
+unsigned int RenderProxies::Add(const MeshComponent* component)
+{
+    unsigned int handle = static_cast<unsigned int>(handleIndices.size());
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else handleIndices.push_back(0);
+
+    RenderProxy proxy;
+    proxy.component       = component;
+    proxy.handle          = handle;
+
+    handleIndices[handle] = static_cast<unsigned int>(proxies.size());
+    proxies.push_back(proxy);
+    return handle;
+}
+
+void RenderProxies::Remove(unsigned int handle)
+{
+    if (handle >= handleIndices.size()) return;
+
+    // The last record fills the hole, the array stays packed
+    const unsigned int index = handleIndices[handle];
+    if (index != proxies.size() - 1)
+    {
+        proxies[index]                       = proxies.back();
+        handleIndices[proxies[index].handle] = index;
+    }
+    proxies.pop_back();
+    freeHandles.push_back(handle);
+}
+
+void RenderProxies::Clear()
+{
+    proxies.clear();
+    handleIndices.clear();
+    freeHandles.clear();
+}
+
+void RenderProxies::OnBatchRemoved(const GeometryBatch* batch)
+{
+    for (RenderProxy& proxy : proxies)
+    {
+        if (proxy.batch == batch) proxy.batch = nullptr;
+    }
+}
+
+void RenderProxies::Cull(
+    const FrustumPlanes& frustumPlanes, const float4x4& projection, const float3& cameraPosition,
+    std::vector<unsigned int>& lodLevels, std::vector<VisibleProxy>& outVisible
+) const
+{
+    outVisible.clear();
+
+    // New handles start at the full detail level, reused ones keep the level of the record they had before
+    if (lodLevels.size() < handleIndices.size()) lodLevels.resize(handleIndices.size(), 0);
+
+    // Orthographic projections keep the same size at any distance
+    const bool isPerspective = projection[3][3] == 0.f;
+
+    for (const RenderProxy& proxy : proxies)
+    {
+        if (!(proxy.flags & RENDER_PROXY_ENABLED) || proxy.batch == nullptr) continue;
+        if (!frustumPlanes.Intersects(proxy.bounds)) continue;
+
+        // Radius of the bounding sphere projected on the screen, relative to half of its height
+        const float radius   = proxy.bounds.HalfSize().Length();
+        const float distance = std::max(proxy.bounds.CenterPoint().Distance(cameraPosition) - radius, 0.0001f);
+        unsigned int& level  = lodLevels[proxy.handle];
+        level                = SelectLodLevel(
+            level, isPerspective ? radius * projection[1][1] / distance : radius * projection[1][1]
+        );
+
+        outVisible.push_back({&proxy, level});
+    }
+}
+
+unsigned int RenderProxies::SelectLodLevel(unsigned int lodLevel, float screenSize)
+{
+    while (lodLevel < MAX_MESH_LODS - 1 && screenSize < LOD_SCREEN_SIZES[lodLevel] * (1.f - LOD_HYSTERESIS))
+        ++lodLevel;
+    while (lodLevel > 0 && screenSize > LOD_SCREEN_SIZES[lodLevel - 1] * (1.f + LOD_HYSTERESIS))
+        --lodLevel;
+    return lodLevel;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Globals.h"
+
+#include "Geometry/OBB.h"
+#include "Math/float4x4.h"
+#include <vector>
+
+class FrustumPlanes;
+class GeometryBatch;
+class MeshComponent;
+class ResourceAnimation;
+class ResourceMaterial;
+class ResourceMesh;
+
+constexpr unsigned int INVALID_RENDER_PROXY = ~0u;
+
+enum RenderProxyFlags : unsigned int
+{
+    RENDER_PROXY_ENABLED = 1 << 0, // The component and its whole branch are enabled
+    RENDER_PROXY_STATIC  = 1 << 1,
+};
+
+// What the renderer needs of a mesh component, copied when the component notifies a change
+struct RenderProxy
+{
+    float4x4 model;                     // Combined matrix of the mesh
+    OBB bounds;                         // World bounds of the owner, culled against the camera
+    const ResourceMesh* mesh         = nullptr;
+    const ResourceMaterial* material = nullptr;
+    GeometryBatch* batch             = nullptr;
+    const MeshComponent* component   = nullptr; // Key of the component in its batch, not read while rendering
+    unsigned int flags               = 0;
+    unsigned int handle              = INVALID_RENDER_PROXY;
+};
+
+// Record that passed the culling of a camera, with the level of detail picked for that camera
+struct VisibleProxy
+{
+    const RenderProxy* proxy;
+    unsigned int lodLevel;
+};
+
+// Skinned meshes of the same skin and mesh playing the same clip at the same time have the same bones relative to their
+// model, their batch writes the palette once and every one of them reads it
+struct BonePoseKey
+{
+    UID model                     = INVALID_UID; // Model and skin the bind matrices come from
+    int skin                      = -1;
+    const ResourceMesh* mesh      = nullptr;
+    const ResourceAnimation* clip = nullptr;
+    float time                    = 0.f;
+
+    bool operator==(const BonePoseKey& other) const
+    {
+        return model == other.model && skin == other.skin && mesh == other.mesh && clip == other.clip &&
+               time == other.time;
+    }
+};
+
+struct BonePoseKeyHash
+{
+    std::size_t operator()(const BonePoseKey& key) const;
+};
+
+// Render records of every mesh component, packed in a single array that the culling and the batches go through
+// instead of the scene. Handles stay valid while the records move to fill the holes of removed ones. Pointers to the
+// records are only valid until the next Add or Remove
+class RenderProxies
+{
+  public:
+    unsigned int Add(const MeshComponent* component);
+    void Remove(unsigned int handle);
+    void Clear();
+
+    RenderProxy& Get(unsigned int handle) { return proxies[handleIndices[handle]]; }
+    // Nullptr for INVALID_RENDER_PROXY, the component has no record yet
+    const RenderProxy* Find(unsigned int handle) const
+    {
+        return handle < handleIndices.size() ? &proxies[handleIndices[handle]] : nullptr;
+    }
+    std::size_t GetSize() const { return proxies.size(); }
+
+    // The batch is being deleted, its records draw nothing until their component gets a new one
+    void OnBatchRemoved(const GeometryBatch* batch);
+
+    // Enabled records with a batch that touch the frustum, with the level of detail for their projected size. The
+    // records are only read, the levels of the last frame of this camera come by handle and are updated in place
+    void Cull(
+        const FrustumPlanes& frustumPlanes, const float4x4& projection, const float3& cameraPosition,
+        std::vector<unsigned int>& lodLevels, std::vector<VisibleProxy>& outVisible
+    ) const;
+
+    // Picks the level of detail for the projected size, relative to half of the screen height, with a margin around
+    // every threshold so meshes right on one do not keep switching
+    static unsigned int SelectLodLevel(unsigned int lodLevel, float screenSize);
+
+  private:
+    std::vector<RenderProxy> proxies;
+    std::vector<unsigned int> handleIndices; // Handle -> position in proxies
+    std::vector<unsigned int> freeHandles;
+};
@@ -4,9 +4,12 @@
 #include "FileSystem.h"
 #include "LibraryModule.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 #include "MetaMesh.h"
 #include "ProjectModule.h"
 #include "ResourceMesh.h"
+#include "VertexQuantization.h"
 
 #include "Math/Quat.h"
 #include "rapidjson/document.h"
@@ -14,6 +17,14 @@
 #include <algorithm>
 #include <vector>
 
+// Set on the mode of the file header when the vertices are stored as CompactVertex
+constexpr unsigned int COMPACT_VERTICES_FLAG = 1u << 16;
+// Set on the mode of the file header when a SkinVertex stream follows the compact vertices
+constexpr unsigned int SKIN_STREAM_FLAG      = 1u << 17;
+constexpr unsigned int MODE_MASK             = ~(COMPACT_VERTICES_FLAG | SKIN_STREAM_FLAG);
+// Meshes with less triangles are culled as a whole, splitting them would only add draw commands
+constexpr unsigned int MESHLET_MIN_TRIANGLES = 4096;
+
 namespace MeshImporter
 {
 
@@ -33,6 +44,7 @@ namespace MeshImporter
         float3 minPos                        = {0.0f, 0.0f, 0.0f};
         float3 maxPos                        = {0.0f, 0.0f, 0.0f};
         bool generateTangents                = false;
+        bool isSkinned                       = false;
 
         const tinygltf::Primitive& primitive = model.meshes[meshIndex].primitives[primitiveIndex];
 
@@ -141,6 +153,7 @@ namespace MeshImporter
             if (itJoints != primitive.attributes.end())
             {
                 GLOG("GET JOINTS");
+                isSkinned                             = true;
                 const tinygltf::Accessor& jointAcc    = model.accessors[itJoints->second];
                 const tinygltf::BufferView& jointView = model.bufferViews[jointAcc.bufferView];
                 const tinygltf::Buffer& jointBuffer   = model.buffers[jointView.buffer];
@@ -164,6 +177,7 @@ namespace MeshImporter
             if (itWeights != primitive.attributes.end())
             {
                 GLOG("GET WEIGHTS");
+                isSkinned                               = true;
                 const tinygltf::Accessor& weightsAcc    = model.accessors[itWeights->second];
                 const tinygltf::BufferView& weightsView = model.bufferViews[weightsAcc.bufferView];
                 const tinygltf::Buffer& weightsBuffer   = model.buffers[weightsView.buffer];
@@ -248,6 +262,97 @@ namespace MeshImporter
         // Extract mode (0:points  1:lines  2:line loop  3:line strip  4:triangles)
         int mode               = (primitive.mode != -1) ? primitive.mode : 4;
 
+        // Triangle lists are reordered for the post-transform cache, then the vertices for the fetch, before the
+        // vertex streams and levels of detail are built from them
+        std::vector<unsigned int> triangleIndices;
+        std::vector<Meshlet> meshlets;
+        if (mode == 4 && itIndices != -1)
+        {
+            switch (indexType)
+            {
+            case (UNSIGNED_CHAR):
+                triangleIndices.assign(indexBufferChar.begin(), indexBufferChar.end());
+                break;
+            case (UNSIGNED_SHORT):
+                triangleIndices.assign(indexBufferShort.begin(), indexBufferShort.end());
+                break;
+            case (UNSIGNED_INT):
+                triangleIndices.assign(indexBufferInt.begin(), indexBufferInt.end());
+                break;
+            }
+
+            const unsigned int vertexCount = static_cast<unsigned int>(vertexBuffer.size());
+            const float acmrBefore         = MeshOptimizer::ComputeACMR(triangleIndices, vertexCount);
+
+            std::vector<unsigned int> clusterStarts;
+            MeshOptimizer::OptimizeVertexCache(
+                triangleIndices, vertexCount, MeshOptimizer::DEFAULT_CACHE_SIZE, &clusterStarts
+            );
+            MeshOptimizer::OptimizeOverdraw(triangleIndices, vertexBuffer, clusterStarts);
+            MeshOptimizer::OptimizeVertexFetch(vertexBuffer, triangleIndices);
+
+            GLOG(
+                "Mesh %s ACMR %.3f -> %.3f", name.c_str(), acmrBefore,
+                MeshOptimizer::ComputeACMR(triangleIndices, vertexCount)
+            );
+
+            if (triangleIndices.size() / 3 >= MESHLET_MIN_TRIANGLES)
+            {
+                MeshOptimizer::BuildMeshlets(triangleIndices, vertexBuffer, meshlets);
+                GLOG("Mesh %s split in %zu meshlets", name.c_str(), meshlets.size());
+            }
+
+            // The vertex count does not change, every index still fits its original type
+            switch (indexType)
+            {
+            case (UNSIGNED_CHAR):
+                std::copy(triangleIndices.begin(), triangleIndices.end(), indexBufferChar.begin());
+                break;
+            case (UNSIGNED_SHORT):
+                std::copy(triangleIndices.begin(), triangleIndices.end(), indexBufferShort.begin());
+                break;
+            case (UNSIGNED_INT):
+                indexBufferInt = triangleIndices;
+                break;
+            }
+        }
+
+        // Vertices are stored quantized against their bounds, which are also saved in the file. Joints and weights go
+        // to a separate stream that only skinned meshes have
+        const AABB bounds = VertexQuantization::ComputeBounds(vertexBuffer);
+        minPos            = bounds.minPoint;
+        maxPos            = bounds.maxPoint;
+
+        std::vector<CompactVertex> compactVertexBuffer;
+        std::vector<SkinVertex> skinVertexBuffer;
+        VertexQuantization::Encode(vertexBuffer, bounds, compactVertexBuffer);
+        if (isSkinned && !VertexQuantization::EncodeSkin(vertexBuffer, skinVertexBuffer))
+            GLOG("Mesh %s uses more than 256 joints, the exceeding ones are clamped", name.c_str());
+
+        const size_t vertexDataSize = sizeof(CompactVertex) * compactVertexBuffer.size();
+        const size_t skinDataSize   = sizeof(SkinVertex) * skinVertexBuffer.size();
+
+        // Simplified levels of detail index the same vertices, they are appended after the bounds
+        std::vector<std::vector<unsigned int>> lodBuffers;
+        if (mode == 4)
+        {
+            MeshSimplifier::GenerateLODs(vertexBuffer, triangleIndices, MAX_MESH_LODS - 1, lodBuffers);
+            if (lodBuffers.empty() && triangleIndices.size() / 3 >= MESH_LOD_MIN_TRIANGLES)
+                GLOG("Mesh %s could not be simplified, it is drawn at full detail at any distance", name.c_str());
+
+            for (std::vector<unsigned int>& lodBuffer : lodBuffers)
+                MeshOptimizer::OptimizeVertexCache(lodBuffer, static_cast<unsigned int>(vertexBuffer.size()));
+        }
+
+        // The level of detail count is also written, as zero, when only the meshlets follow
+        const bool hasExtraSections = !lodBuffers.empty() || !meshlets.empty();
+        size_t lodDataSize          = hasExtraSections ? sizeof(unsigned int) * (1 + lodBuffers.size()) : 0;
+        for (const std::vector<unsigned int>& lodBuffer : lodBuffers)
+            lodDataSize += sizeof(unsigned int) * lodBuffer.size();
+
+        const size_t meshletDataSize =
+            meshlets.empty() ? 0 : sizeof(unsigned int) + sizeof(Meshlet) * meshlets.size();
+
         // save to binary file.
         // 1 - NUMBER OF INDICES,  2 - NUMBER OF VERTICES  3 - MODE  4 - INDEX MODE
         unsigned int header[4] = {0, 0, 0, 0};
@@ -274,11 +379,12 @@ namespace MeshImporter
         }
 
         header[1]         = (unsigned int)(vertexBuffer.size());
-        header[2]         = (unsigned int)(mode);
+        header[2]         = (unsigned int)(mode) | COMPACT_VERTICES_FLAG | (isSkinned ? SKIN_STREAM_FLAG : 0);
         header[3]         = static_cast<unsigned int>(indexType);
 
         unsigned int size = static_cast<unsigned int>(
-            sizeof(header) + (sizeof(Vertex) * vertexBuffer.size()) + indexBufferSize + (sizeof(float3) * 2)
+            sizeof(header) + vertexDataSize + skinDataSize + indexBufferSize + (sizeof(float3) * 2) + lodDataSize +
+            meshletDataSize
         );
 
         char* fileBuffer = new char[size];
@@ -289,9 +395,13 @@ namespace MeshImporter
         cursor += sizeof(header);
 
         // order matters:
-        // interleaved vertex data (position + tangent + normal + texCoord + joints + weights)
-        memcpy(cursor, vertexBuffer.data(), sizeof(Vertex) * vertexBuffer.size());
-        cursor += sizeof(Vertex) * vertexBuffer.size();
+        // compact vertex data (position + normal + tangent + texCoord)
+        memcpy(cursor, compactVertexBuffer.data(), vertexDataSize);
+        cursor += vertexDataSize;
+
+        // skinning data (joints + weights)
+        memcpy(cursor, skinVertexBuffer.data(), skinDataSize);
+        cursor += skinDataSize;
 
         // index data
         if (indexType == DataType::UNSIGNED_CHAR)
@@ -313,6 +423,38 @@ namespace MeshImporter
         memcpy(cursor, &maxPos, sizeof(float3));
         cursor += sizeof(float3);
 
+        // levels of detail: count, index count of each level and their indices
+        if (hasExtraSections)
+        {
+            const unsigned int lodCount = static_cast<unsigned int>(lodBuffers.size());
+            memcpy(cursor, &lodCount, sizeof(unsigned int));
+            cursor += sizeof(unsigned int);
+
+            for (const std::vector<unsigned int>& lodBuffer : lodBuffers)
+            {
+                const unsigned int lodIndexCount = static_cast<unsigned int>(lodBuffer.size());
+                memcpy(cursor, &lodIndexCount, sizeof(unsigned int));
+                cursor += sizeof(unsigned int);
+            }
+
+            for (const std::vector<unsigned int>& lodBuffer : lodBuffers)
+            {
+                memcpy(cursor, lodBuffer.data(), sizeof(unsigned int) * lodBuffer.size());
+                cursor += sizeof(unsigned int) * lodBuffer.size();
+            }
+        }
+
+        // meshlets: count and their ranges and bounds
+        if (!meshlets.empty())
+        {
+            const unsigned int meshletCount = static_cast<unsigned int>(meshlets.size());
+            memcpy(cursor, &meshletCount, sizeof(unsigned int));
+            cursor += sizeof(unsigned int);
+
+            memcpy(cursor, meshlets.data(), sizeof(Meshlet) * meshlets.size());
+            cursor += sizeof(Meshlet) * meshlets.size();
+        }
+
         UID finalMeshUID;
         if (sourceUID == INVALID_UID)
         {
@@ -436,19 +578,40 @@ namespace MeshImporter
 
         unsigned int indexCount   = header[0];
         unsigned int vertexCount  = header[1];
-        unsigned int mode         = header[2];
+        unsigned int mode         = header[2] & MODE_MASK;
         unsigned int indexMode    = header[3];
+        const bool isCompact      = (header[2] & COMPACT_VERTICES_FLAG) != 0;
+        const bool hasSkinStream  = (header[2] & SKIN_STREAM_FLAG) != 0;
         // GLOG("The mode for the mesh is %d", mode);
 
         // Create Mesh
         std::vector<Vertex> tmpVertices;
-        tmpVertices.reserve(vertexCount);
+        std::vector<CompactVertex> tmpCompactVertices;
+        std::vector<SkinVertex> tmpSkinVertices;
+
+        if (isCompact)
+        {
+            const CompactVertex* bufferVertices = reinterpret_cast<const CompactVertex*>(cursor);
+            tmpCompactVertices.assign(bufferVertices, bufferVertices + vertexCount);
+            cursor += sizeof(CompactVertex) * vertexCount;
 
-        for (unsigned int i = 0; i < vertexCount; ++i)
+            if (hasSkinStream)
+            {
+                const SkinVertex* bufferSkin = reinterpret_cast<const SkinVertex*>(cursor);
+                tmpSkinVertices.assign(bufferSkin, bufferSkin + vertexCount);
+                cursor += sizeof(SkinVertex) * vertexCount;
+            }
+        }
+        else
         {
-            Vertex vertex = *reinterpret_cast<Vertex*>(cursor);
-            tmpVertices.push_back(vertex); // Add vertex to vector
-            cursor += sizeof(Vertex);      // Move cursor forward
+            tmpVertices.reserve(vertexCount);
+
+            for (unsigned int i = 0; i < vertexCount; ++i)
+            {
+                Vertex vertex = *reinterpret_cast<Vertex*>(cursor);
+                tmpVertices.push_back(vertex); // Add vertex to vector
+                cursor += sizeof(Vertex);      // Move cursor forward
+            }
         }
 
         std::vector<unsigned int> tmpIndices;
@@ -496,13 +659,52 @@ namespace MeshImporter
         float3 maxPos  = *reinterpret_cast<float3*>(cursor);
         cursor        += sizeof(float3);
 
+        // Files imported before levels of detail existed end here
+        std::vector<unsigned int> tmpLodIndices;
+        std::vector<unsigned int> tmpLodIndexCounts;
+        if (cursor + sizeof(unsigned int) <= buffer + fileSize)
+        {
+            const unsigned int lodCount = *reinterpret_cast<unsigned int*>(cursor);
+            cursor                     += sizeof(unsigned int);
+
+            const unsigned int* bufferCounts = reinterpret_cast<const unsigned int*>(cursor);
+            tmpLodIndexCounts.assign(bufferCounts, bufferCounts + lodCount);
+            cursor += sizeof(unsigned int) * lodCount;
+
+            unsigned int lodIndexCount = 0;
+            for (const unsigned int count : tmpLodIndexCounts)
+                lodIndexCount += count;
+
+            const unsigned int* bufferLodIndices = reinterpret_cast<const unsigned int*>(cursor);
+            tmpLodIndices.assign(bufferLodIndices, bufferLodIndices + lodIndexCount);
+            cursor += sizeof(unsigned int) * lodIndexCount;
+        }
+
+        std::vector<Meshlet> tmpMeshlets;
+        if (cursor + sizeof(unsigned int) <= buffer + fileSize)
+        {
+            const unsigned int meshletCount = *reinterpret_cast<unsigned int*>(cursor);
+            cursor                         += sizeof(unsigned int);
+
+            const Meshlet* bufferMeshlets = reinterpret_cast<const Meshlet*>(cursor);
+            tmpMeshlets.assign(bufferMeshlets, bufferMeshlets + meshletCount);
+            cursor += sizeof(Meshlet) * meshletCount;
+        }
+
         rapidjson::Document doc;
         rapidjson::Value importOptions;
         App->GetLibraryModule()->GetImportOptions(meshUID, doc, importOptions);
 
         ResourceMesh* mesh = new ResourceMesh(meshUID, name, maxPos, minPos, importOptions);
 
-        mesh->LoadData(mode, tmpVertices, tmpIndices);
+        if (isCompact)
+            mesh->LoadCompactData(
+                mode, std::move(tmpCompactVertices), std::move(tmpSkinVertices), tmpIndices, AABB(minPos, maxPos)
+            );
+        else mesh->LoadData(mode, tmpVertices, tmpIndices);
+
+        if (!tmpLodIndexCounts.empty()) mesh->LoadLODs(std::move(tmpLodIndices), tmpLodIndexCounts);
+        if (!tmpMeshlets.empty()) mesh->LoadMeshlets(std::move(tmpMeshlets));
 
         delete[] buffer;
 
@@ -3,6 +3,7 @@
 #include "Math/float2.h"
 #include "Math/float3.h"
 #include "Math/float4.h"
+#include <cstdint>
 #include <vector>
 
 // ORDER MATTERS
@@ -33,6 +34,47 @@ struct Vertex
     }
 };
 
+// ORDER MATTERS. Quantized layout for meshes without skinning, 20 bytes instead of the 88 of Vertex
+struct CompactVertex
+{
+    uint16_t position[4]; // xyz normalized against the mesh bounds, w is the tangent handedness (0: -1, max: +1)
+    int16_t normal[2];    // Octahedral encoded, snorm
+    int16_t tangent[2];   // Octahedral encoded, snorm
+    uint16_t texCoord[2]; // Half floats
+};
+
+// ORDER MATTERS. Skinning attributes, kept in their own vertex stream so only skinned batches fetch them
+struct SkinVertex
+{
+    uint8_t joint[4];    // Indices into the bone palette of the mesh
+    uint16_t weights[4]; // Unorm, they add up to one
+};
+
+// Levels of detail a mesh can have, the original one included
+constexpr unsigned int MAX_MESH_LODS = 4;
+
+// Range of the GPU index list of a mesh drawn for one level of detail
+struct MeshLOD
+{
+    unsigned int firstIndex; // Relative to the first index of the mesh, 0 for the original level
+    unsigned int indexCount;
+};
+
+// Big meshes are split in clusters of triangles the renderer culls one by one
+constexpr unsigned int MAX_MESHLET_VERTICES  = 64;
+constexpr unsigned int MAX_MESHLET_TRIANGLES = 124;
+
+// Triangle cluster of the original index list, with the bounds used to cull it
+struct Meshlet
+{
+    unsigned int firstIndex; // Relative to the first index of the mesh
+    unsigned int indexCount;
+    float3 center;           // Bounding sphere
+    float radius;
+    float3 coneAxis;         // Average normal of the triangles
+    float coneCutoff;        // Sine of the cone spread, 1 when the cluster can not be back face culled
+};
+
 class Mesh
 {
   public:
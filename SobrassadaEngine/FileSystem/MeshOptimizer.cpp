@@ -0,0 +1,339 @@
+#include "MeshOptimizer.h"
+
+#include "Mesh.h"
+
+#include "Geometry/AABB.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+
+namespace
+{
+    // Triangles using every vertex, stored contiguously
+    struct VertexAdjacency
+    {
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> triangles;
+    };
+
+    void BuildAdjacency(const std::vector<unsigned int>& indices, unsigned int vertexCount, VertexAdjacency& adjacency)
+    {
+        adjacency.offsets.assign(vertexCount + 1, 0);
+        for (const unsigned int index : indices)
+            ++adjacency.offsets[index + 1];
+
+        for (unsigned int v = 0; v < vertexCount; ++v)
+            adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+        std::vector<unsigned int> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        adjacency.triangles.resize(indices.size());
+        for (unsigned int i = 0; i < indices.size(); ++i)
+            adjacency.triangles[cursor[indices[i]]++] = i / 3;
+    }
+
+    void ComputeMeshletBounds(
+        Meshlet& meshlet, const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices
+    )
+    {
+        const unsigned int firstTriangle = meshlet.firstIndex / 3;
+        const unsigned int endTriangle   = firstTriangle + meshlet.indexCount / 3;
+
+        // Sphere centered on the bounds of the cluster, good enough for culling
+        AABB bounds;
+        bounds.SetNegativeInfinity();
+        for (unsigned int i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; ++i)
+            bounds.Enclose(vertices[indices[i]].position);
+
+        meshlet.center = bounds.CenterPoint();
+        meshlet.radius = 0.f;
+        for (unsigned int i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; ++i)
+            meshlet.radius = std::max(meshlet.radius, vertices[indices[i]].position.Distance(meshlet.center));
+
+        // The cone contains every triangle normal, a spread over 90 degrees can not be culled by its facing
+        std::vector<float3> normals;
+        normals.reserve(meshlet.indexCount / 3);
+        float3 axis = float3::zero;
+        for (unsigned int t = firstTriangle; t < endTriangle; ++t)
+        {
+            const float3& a = vertices[indices[t * 3]].position;
+            const float3& b = vertices[indices[t * 3 + 1]].position;
+            const float3& c = vertices[indices[t * 3 + 2]].position;
+            float3 normal   = (b - a).Cross(c - a);
+            if (normal.Normalize() == 0.f) continue;
+
+            normals.push_back(normal);
+            axis += normal;
+        }
+
+        meshlet.coneAxis   = axis.Normalized();
+        meshlet.coneCutoff = 1.f;
+        if (normals.empty() || axis.LengthSq() == 0.f) return;
+
+        float minDot = 1.f;
+        for (const float3& normal : normals)
+            minDot = std::min(minDot, normal.Dot(meshlet.coneAxis));
+
+        if (minDot > 0.f) meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+    }
+} // namespace
+
+namespace MeshOptimizer
+{
+    float ComputeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+    {
+        if (indices.size() < 3) return 0.f;
+
+        std::deque<unsigned int> cache;
+        std::vector<bool> inCache(vertexCount, false);
+        unsigned int misses = 0;
+
+        for (const unsigned int index : indices)
+        {
+            if (inCache[index]) continue;
+
+            ++misses;
+            inCache[index] = true;
+            cache.push_back(index);
+            if (cache.size() > cacheSize)
+            {
+                inCache[cache.front()] = false;
+                cache.pop_front();
+            }
+        }
+
+        return static_cast<float>(misses) / (indices.size() / 3);
+    }
+
+    void OptimizeVertexCache(
+        std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize,
+        std::vector<unsigned int>* clusterStarts
+    )
+    {
+        const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+        if (triangleCount == 0) return;
+
+        VertexAdjacency adjacency;
+        BuildAdjacency(indices, vertexCount, adjacency);
+
+        std::vector<unsigned int> liveTriangles(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+            liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+        std::vector<unsigned int> cacheTimes(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned int> deadEnd;
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+        if (clusterStarts) clusterStarts->assign(1, 0);
+
+        unsigned int timeStamp  = cacheSize + 1;
+        unsigned int scanCursor = 0;
+        int fanningVertex       = 0;
+
+        while (fanningVertex >= 0)
+        {
+            candidates.clear();
+
+            // Emit every triangle around the fanning vertex
+            for (unsigned int a = adjacency.offsets[fanningVertex]; a < adjacency.offsets[fanningVertex + 1]; ++a)
+            {
+                const unsigned int triangle = adjacency.triangles[a];
+                if (emitted[triangle]) continue;
+
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const unsigned int vertex = indices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveTriangles[vertex];
+
+                    if (timeStamp - cacheTimes[vertex] > cacheSize) cacheTimes[vertex] = timeStamp++;
+                }
+                emitted[triangle] = true;
+            }
+
+            // Next fan around the candidate that stays longest in the cache after emitting its triangles
+            int bestVertex   = -1;
+            int bestPriority = -1;
+            for (const unsigned int vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0) continue;
+
+                int priority = 0;
+                if (timeStamp - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+                    priority = static_cast<int>(timeStamp - cacheTimes[vertex]);
+
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    bestVertex   = static_cast<int>(vertex);
+                }
+            }
+
+            if (bestVertex >= 0)
+            {
+                fanningVertex = bestVertex;
+                continue;
+            }
+
+            // Dead end, go back to recently used vertices and then scan for any vertex with triangles left
+            while (!deadEnd.empty() && liveTriangles[deadEnd.back()] == 0)
+                deadEnd.pop_back();
+
+            if (!deadEnd.empty()) fanningVertex = static_cast<int>(deadEnd.back());
+            else
+            {
+                while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0)
+                    ++scanCursor;
+                fanningVertex = scanCursor < vertexCount ? static_cast<int>(scanCursor) : -1;
+            }
+
+            if (clusterStarts && fanningVertex >= 0)
+                clusterStarts->push_back(static_cast<unsigned int>(result.size() / 3));
+        }
+
+        indices = std::move(result);
+    }
+
+    void OptimizeOverdraw(
+        std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+        const std::vector<unsigned int>& clusterStarts
+    )
+    {
+        const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+        const unsigned int clusterCount  = static_cast<unsigned int>(clusterStarts.size());
+        if (clusterCount < 2) return;
+
+        float3 meshCentroid = float3::zero;
+        float meshArea      = 0.f;
+
+        std::vector<float3> clusterCentroids(clusterCount, float3::zero);
+        std::vector<float3> clusterNormals(clusterCount, float3::zero);
+        for (unsigned int cluster = 0; cluster < clusterCount; ++cluster)
+        {
+            const unsigned int end = cluster + 1 < clusterCount ? clusterStarts[cluster + 1] : triangleCount;
+            float clusterArea      = 0.f;
+
+            for (unsigned int t = clusterStarts[cluster]; t < end; ++t)
+            {
+                const float3& a       = vertices[indices[t * 3]].position;
+                const float3& b       = vertices[indices[t * 3 + 1]].position;
+                const float3& c       = vertices[indices[t * 3 + 2]].position;
+
+                // The cross product length is twice the area, it weights the normal and centroid of each triangle
+                const float3 normal   = (b - a).Cross(c - a);
+                const float area      = normal.Length();
+                const float3 centroid = (a + b + c) / 3.f;
+
+                clusterNormals[cluster]   += normal;
+                clusterCentroids[cluster] += centroid * area;
+                clusterArea               += area;
+            }
+
+            meshCentroid += clusterCentroids[cluster];
+            meshArea     += clusterArea;
+            if (clusterArea > 0.f) clusterCentroids[cluster] /= clusterArea;
+        }
+        if (meshArea > 0.f) meshCentroid /= meshArea;
+
+        // Clusters far along their own normal are on the outside of the mesh
+        std::vector<float> sortKeys(clusterCount);
+        std::vector<unsigned int> order(clusterCount);
+        for (unsigned int cluster = 0; cluster < clusterCount; ++cluster)
+        {
+            sortKeys[cluster] = (clusterCentroids[cluster] - meshCentroid).Dot(clusterNormals[cluster].Normalized());
+            order[cluster]    = cluster;
+        }
+        std::stable_sort(
+            order.begin(), order.end(),
+            [&sortKeys](unsigned int first, unsigned int second) { return sortKeys[first] > sortKeys[second]; }
+        );
+
+        std::vector<unsigned int> result;
+        result.reserve(indices.size());
+        for (const unsigned int cluster : order)
+        {
+            const unsigned int end = cluster + 1 < clusterCount ? clusterStarts[cluster + 1] : triangleCount;
+            result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + end * 3);
+        }
+
+        indices = std::move(result);
+    }
+
+    void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        constexpr unsigned int UNUSED = ~0u;
+
+        const unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+        std::vector<unsigned int> remap(vertexCount, UNUSED);
+        std::vector<Vertex> result;
+        result.reserve(vertexCount);
+
+        for (unsigned int& index : indices)
+        {
+            if (remap[index] == UNUSED)
+            {
+                remap[index] = static_cast<unsigned int>(result.size());
+                result.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            if (remap[v] == UNUSED) result.push_back(vertices[v]);
+        }
+
+        vertices = std::move(result);
+    }
+
+    void BuildMeshlets(
+        const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, std::vector<Meshlet>& meshlets
+    )
+    {
+        meshlets.clear();
+
+        // Vertices of the current cluster, marked with the cluster number to avoid clearing them every time
+        std::vector<unsigned int> vertexMeshlet(vertices.size(), ~0u);
+        unsigned int meshletVertexCount = 0;
+
+        Meshlet current                 = {};
+        for (unsigned int t = 0; t < indices.size() / 3; ++t)
+        {
+            unsigned int newVertices = 0;
+            for (int corner = 0; corner < 3; ++corner)
+                if (vertexMeshlet[indices[t * 3 + corner]] != meshlets.size()) ++newVertices;
+
+            // Close the cluster when the triangle does not fit, it starts the next one
+            if (meshletVertexCount + newVertices > MAX_MESHLET_VERTICES ||
+                current.indexCount / 3 == MAX_MESHLET_TRIANGLES)
+            {
+                ComputeMeshletBounds(current, indices, vertices);
+                meshlets.push_back(current);
+
+                current            = {};
+                current.firstIndex = t * 3;
+                meshletVertexCount = 0;
+            }
+
+            const unsigned int meshletIndex = static_cast<unsigned int>(meshlets.size());
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int& owner = vertexMeshlet[indices[t * 3 + corner]];
+                if (owner == meshletIndex) continue;
+
+                owner = meshletIndex;
+                ++meshletVertexCount;
+            }
+            current.indexCount += 3;
+        }
+
+        if (current.indexCount > 0)
+        {
+            ComputeMeshletBounds(current, indices, vertices);
+            meshlets.push_back(current);
+        }
+    }
+} // namespace MeshOptimizer
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+struct Vertex;
+struct Meshlet;
+
+// Reorders triangle lists at import time, the geometry itself is never modified
+namespace MeshOptimizer
+{
+    constexpr unsigned int DEFAULT_CACHE_SIZE = 16;
+
+    // Average cache miss ratio, transformed vertices per triangle of a FIFO post-transform cache. 0.5 is the best
+    // possible for big regular meshes, 3 the worst
+    float ComputeACMR(
+        const std::vector<unsigned int>& indices, unsigned int vertexCount,
+        unsigned int cacheSize = DEFAULT_CACHE_SIZE
+    );
+
+    // Tipsify (Sander et al. 2007). Fans triangles around vertices still in the cache. When clusterStarts is given it
+    // gets the first triangle of every cluster, the points where the fan had to jump to a vertex out of the cache
+    void OptimizeVertexCache(
+        std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+        std::vector<unsigned int>* clusterStarts = nullptr
+    );
+
+    // Sorts the clusters so the ones facing away from the mesh center come first, they tend to occlude the rest.
+    // Triangles inside a cluster keep their order, so the cache efficiency barely changes
+    void OptimizeOverdraw(
+        std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices,
+        const std::vector<unsigned int>& clusterStarts
+    );
+
+    // Renumbers the vertices in the order the indices first use them, so the vertex fetch reads memory linearly.
+    // Vertices no triangle uses are moved to the end
+    void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    // Splits the triangles in consecutive clusters of at most MAX_MESHLET_VERTICES vertices and
+    // MAX_MESHLET_TRIANGLES triangles. The indices are not reordered, run it after OptimizeVertexCache so the
+    // clusters are compact
+    void BuildMeshlets(
+        const std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, std::vector<Meshlet>& meshlets
+    );
+} // namespace MeshOptimizer
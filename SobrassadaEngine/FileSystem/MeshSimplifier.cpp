@@ -0,0 +1,375 @@
+#include "MeshSimplifier.h"
+
+#include "Mesh.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+    constexpr float MIN_LOD_REDUCTION    = 0.9f; // A level must keep less than this fraction of the previous one
+    constexpr double MAX_FLIP_COS        = 0.2;  // Collapses that turn a triangle more than ~78 degrees are rejected
+    constexpr float SEAM_PLANE_SCALE     = 1.f;  // Weight of the planes along seam edges, relative to the faces
+    constexpr unsigned int INVALID_WEDGE = ~0u;
+
+    // Symmetric 4x4 matrix accumulating squared distances to planes
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+        void AddPlane(double a, double b, double c, double d)
+        {
+            a2 += a * a;
+            ab += a * b;
+            ac += a * c;
+            ad += a * d;
+            b2 += b * b;
+            bc += b * c;
+            bd += b * d;
+            c2 += c * c;
+            cd += c * d;
+            d2 += d * d;
+        }
+
+        void Add(const Quadric& other)
+        {
+            a2 += other.a2;
+            ab += other.ab;
+            ac += other.ac;
+            ad += other.ad;
+            b2 += other.b2;
+            bc += other.bc;
+            bd += other.bd;
+            c2 += other.c2;
+            cd += other.cd;
+            d2 += other.d2;
+        }
+
+        double Evaluate(const float3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x + b2 * y * y + 2 * bc * y * z +
+                   2 * bd * y + c2 * z * z + 2 * cd * z + d2;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        unsigned int from;
+        unsigned int to;
+        unsigned int version; // Version of the source corner when the collapse was evaluated
+
+        bool operator>(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    struct PositionHash
+    {
+        size_t operator()(const float3& position) const
+        {
+            uint32_t bits[3];
+            std::memcpy(bits, position.ptr(), sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    struct PositionEqual
+    {
+        bool operator()(const float3& a, const float3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+    };
+
+    uint64_t EdgeKey(unsigned int from, unsigned int to)
+    {
+        return (static_cast<uint64_t>(from) << 32) | to;
+    }
+
+    unsigned int FindRemap(std::vector<unsigned int>& remap, unsigned int vertex)
+    {
+        while (remap[vertex] != vertex)
+        {
+            remap[vertex] = remap[remap[vertex]];
+            vertex        = remap[vertex];
+        }
+        return vertex;
+    }
+
+    float3 TriangleNormal(const float3& a, const float3& b, const float3& c)
+    {
+        return (b - a).Cross(c - a);
+    }
+} // namespace
+
+namespace MeshSimplifier
+{
+    float Simplify(
+        const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, size_t targetIndexCount,
+        std::vector<unsigned int>& outIndices
+    )
+    {
+        const unsigned int vertexCount   = static_cast<unsigned int>(vertices.size());
+        const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+        // Vertices sharing a position are wedges of the same corner, split by their attributes (uv or normal seams).
+        // Collapses move whole corners, identified by their first wedge, so a seam never opens
+        std::vector<unsigned int> canonical(vertexCount);
+        std::vector<std::vector<unsigned int>> wedges(vertexCount);
+        std::unordered_map<float3, unsigned int, PositionHash, PositionEqual> positions;
+        positions.reserve(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+        {
+            canonical[v] = positions.emplace(vertices[v].position, v).first->second;
+            wedges[canonical[v]].push_back(v);
+        }
+
+        std::unordered_set<uint64_t> edges;      // Between corners
+        std::unordered_set<uint64_t> wedgeEdges; // Between vertices
+        edges.reserve(indices.size());
+        wedgeEdges.reserve(indices.size());
+        for (unsigned int t = 0; t < triangleCount; ++t)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                const unsigned int from = indices[t * 3 + e];
+                const unsigned int to   = indices[t * 3 + (e + 1) % 3];
+                edges.insert(EdgeKey(canonical[from], canonical[to]));
+                wedgeEdges.insert(EdgeKey(from, to));
+            }
+        }
+
+        // Border corners are locked, so the silhouette of open meshes is kept. Seam edges add a plane perpendicular
+        // to their triangle, corners slide along the seam but leaving it costs like leaving a face
+        std::vector<bool> locked(vertexCount, false);
+        std::vector<Quadric> quadrics(vertexCount);
+        std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+        for (unsigned int t = 0; t < triangleCount; ++t)
+        {
+            const unsigned int* triangle = &indices[t * 3];
+            const float3& a              = vertices[triangle[0]].position;
+            const float3& b              = vertices[triangle[1]].position;
+            float3 normal                = TriangleNormal(a, b, vertices[triangle[2]].position);
+            const bool hasArea           = normal.Normalize() != 0.f;
+
+            for (int e = 0; e < 3; ++e)
+            {
+                const unsigned int from = triangle[e];
+                const unsigned int to   = triangle[(e + 1) % 3];
+                vertexTriangles[from].push_back(t);
+
+                if (edges.find(EdgeKey(canonical[to], canonical[from])) == edges.end())
+                {
+                    locked[canonical[from]] = true;
+                    locked[canonical[to]]   = true;
+                }
+                else if (hasArea && wedgeEdges.find(EdgeKey(to, from)) == wedgeEdges.end())
+                {
+                    const float3& start = vertices[from].position;
+                    float3 seamNormal   = (vertices[to].position - start).Cross(normal);
+                    if (seamNormal.Normalize() == 0.f) continue;
+
+                    seamNormal *= SEAM_PLANE_SCALE;
+                    Quadric seam;
+                    seam.AddPlane(seamNormal.x, seamNormal.y, seamNormal.z, -seamNormal.Dot(start));
+                    quadrics[canonical[from]].Add(seam);
+                    quadrics[canonical[to]].Add(seam);
+                }
+            }
+            if (!hasArea) continue;
+
+            Quadric plane;
+            plane.AddPlane(normal.x, normal.y, normal.z, -normal.Dot(a));
+            for (int e = 0; e < 3; ++e)
+                quadrics[canonical[triangle[e]]].Add(plane);
+        }
+
+        std::vector<unsigned int> triangles = indices;
+        std::vector<bool> removed(triangleCount, false);
+        std::vector<unsigned int> remap(vertexCount); // Corner each corner was collapsed into
+        std::vector<unsigned int> versions(vertexCount, 0);
+        for (unsigned int v = 0; v < vertexCount; ++v)
+            remap[v] = v;
+
+        auto collapseCost = [&](unsigned int from, unsigned int to)
+        {
+            Quadric quadric = quadrics[from];
+            quadric.Add(quadrics[to]);
+            return quadric.Evaluate(vertices[to].position);
+        };
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> candidates;
+        for (unsigned int t = 0; t < triangleCount; ++t)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                const unsigned int from = canonical[triangles[t * 3 + e]];
+                const unsigned int to   = canonical[triangles[t * 3 + (e + 1) % 3]];
+                if (from == to) continue;
+                if (!locked[from]) candidates.push({collapseCost(from, to), from, to, 0});
+                if (!locked[to]) candidates.push({collapseCost(to, from), to, from, 0});
+            }
+        }
+
+        size_t liveIndexCount = indices.size();
+        double maxError       = 0.0;
+        std::vector<unsigned int> wedgeTargets;
+
+        while (liveIndexCount > targetIndexCount && !candidates.empty())
+        {
+            const Collapse collapse = candidates.top();
+            candidates.pop();
+
+            const unsigned int from = collapse.from;
+            if (remap[from] != from || versions[from] != collapse.version) continue;
+
+            const unsigned int to = FindRemap(remap, collapse.to);
+            if (to == from) continue;
+
+            // The target may have gathered more error since this collapse was evaluated
+            const double cost = collapseCost(from, to);
+            if (cost > collapse.cost * 1.0001 + 1e-12)
+            {
+                candidates.push({cost, from, to, collapse.version});
+                continue;
+            }
+
+            // Every wedge goes to the single wedge of the target it shares a triangle with. A wedge with none would
+            // tear the seam away from the corner, one with several would stretch its side across the seam
+            bool tears = false;
+            wedgeTargets.clear();
+            for (const unsigned int wedge : wedges[from])
+            {
+                unsigned int target = INVALID_WEDGE;
+                for (const unsigned int t : vertexTriangles[wedge])
+                {
+                    if (removed[t]) continue;
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        const unsigned int corner = triangles[t * 3 + e];
+                        if (canonical[corner] != to) continue;
+                        if (target != INVALID_WEDGE && target != corner) tears = true;
+                        target = corner;
+                    }
+                }
+                if (target == INVALID_WEDGE) tears = true;
+                if (tears) break;
+                wedgeTargets.push_back(target);
+            }
+            if (tears) continue;
+
+            // Reject collapses that flip any of the triangles that survive them
+            bool flips = false;
+            for (const unsigned int wedge : wedges[from])
+            {
+                for (const unsigned int t : vertexTriangles[wedge])
+                {
+                    if (removed[t]) continue;
+
+                    const unsigned int* triangle = &triangles[t * 3];
+                    if (canonical[triangle[0]] == to || canonical[triangle[1]] == to || canonical[triangle[2]] == to)
+                        continue;
+
+                    float3 corners[3];
+                    for (int e = 0; e < 3; ++e)
+                        corners[e] = vertices[triangle[e]].position;
+                    const float3 before = TriangleNormal(corners[0], corners[1], corners[2]);
+
+                    for (int e = 0; e < 3; ++e)
+                        if (triangle[e] == wedge) corners[e] = vertices[to].position;
+                    const float3 after = TriangleNormal(corners[0], corners[1], corners[2]);
+
+                    if (before.Dot(after) < MAX_FLIP_COS * before.Length() * after.Length())
+                    {
+                        flips = true;
+                        break;
+                    }
+                }
+                if (flips) break;
+            }
+            if (flips) continue;
+
+            remap[from] = to;
+            quadrics[to].Add(quadrics[from]);
+            maxError = std::max(maxError, cost);
+
+            for (size_t w = 0; w < wedges[from].size(); ++w)
+            {
+                const unsigned int wedge  = wedges[from][w];
+                const unsigned int target = wedgeTargets[w];
+                for (const unsigned int t : vertexTriangles[wedge])
+                {
+                    if (removed[t]) continue;
+
+                    unsigned int* triangle = &triangles[t * 3];
+                    for (int e = 0; e < 3; ++e)
+                        if (triangle[e] == wedge) triangle[e] = target;
+
+                    if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+                    {
+                        removed[t]      = true;
+                        liveIndexCount -= 3;
+                    }
+                    else vertexTriangles[target].push_back(t);
+                }
+                vertexTriangles[wedge].clear();
+            }
+
+            // Evaluate again the edges around the merged corner
+            ++versions[to];
+            for (const unsigned int wedge : wedges[to])
+            {
+                for (const unsigned int t : vertexTriangles[wedge])
+                {
+                    if (removed[t]) continue;
+
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        const unsigned int neighbour = canonical[triangles[t * 3 + e]];
+                        if (neighbour == to) continue;
+
+                        if (!locked[to]) candidates.push({collapseCost(to, neighbour), to, neighbour, versions[to]});
+                        if (!locked[neighbour])
+                            candidates.push({collapseCost(neighbour, to), neighbour, to, versions[neighbour]});
+                    }
+                }
+            }
+        }
+
+        outIndices.clear();
+        outIndices.reserve(liveIndexCount);
+        for (unsigned int t = 0; t < triangleCount; ++t)
+        {
+            if (removed[t]) continue;
+            outIndices.insert(outIndices.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+        }
+
+        return static_cast<float>(std::sqrt(std::max(maxError, 0.0)));
+    }
+
+    void GenerateLODs(
+        const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, unsigned int maxLods,
+        std::vector<std::vector<unsigned int>>& outLods
+    )
+    {
+        outLods.clear();
+        if (indices.size() / 3 < MESH_LOD_MIN_TRIANGLES) return;
+
+        size_t previousIndexCount = indices.size();
+        for (unsigned int lod = 1; lod <= maxLods; ++lod)
+        {
+            // Every level is simplified from the original mesh, errors do not pile up between levels
+            const size_t targetIndexCount = (indices.size() >> lod) / 3 * 3;
+            if (targetIndexCount / 3 < MESH_LOD_MIN_TRIANGLES / 2) break;
+
+            std::vector<unsigned int> lodIndices;
+            Simplify(vertices, indices, targetIndexCount, lodIndices);
+
+            if (lodIndices.empty() || lodIndices.size() > previousIndexCount * MIN_LOD_REDUCTION) break;
+
+            previousIndexCount = lodIndices.size();
+            outLods.push_back(std::move(lodIndices));
+        }
+    }
+} // namespace MeshSimplifier
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct Vertex;
+
+// Meshes with fewer triangles are not worth simplifying
+constexpr unsigned int MESH_LOD_MIN_TRIANGLES = 64;
+
+// Quadric edge collapse simplification. Vertices are never moved nor created, collapses only remove triangles, so every
+// level of detail indexes the same vertex buffer as the original mesh. Vertices split by uv or normal seams collapse
+// together along the seam, only open borders are locked
+namespace MeshSimplifier
+{
+    // Returns the square root of the quadric error of the worst collapse done, an estimate in mesh units
+    float Simplify(
+        const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, size_t targetIndexCount,
+        std::vector<unsigned int>& outIndices
+    );
+
+    // Fills up to maxLods simplified index buffers, each one around half the triangles of the previous. Stops early
+    // when the mesh can not be reduced any further
+    void GenerateLODs(
+        const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, unsigned int maxLods,
+        std::vector<std::vector<unsigned int>>& outLods
+    );
+} // namespace MeshSimplifier
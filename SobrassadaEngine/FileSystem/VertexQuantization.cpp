@@ -0,0 +1,230 @@
+#include "VertexQuantization.h"
+
+#include "Mesh.h"
+
+#include "Math/MathFunc.h"
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr float UNORM16_MAX = 65535.f;
+    constexpr float SNORM16_MAX = 32767.f;
+
+    uint16_t ToUnorm16(float value)
+    {
+        return static_cast<uint16_t>(Clamp01(value) * UNORM16_MAX + 0.5f);
+    }
+
+    int16_t ToSnorm16(float value)
+    {
+        return static_cast<int16_t>(Round(Clamp(value, -1.f, 1.f) * SNORM16_MAX));
+    }
+
+    float FromSnorm16(int16_t value)
+    {
+        return Max(static_cast<float>(value) / SNORM16_MAX, -1.f);
+    }
+
+    float SignNotZero(float value)
+    {
+        return value >= 0.f ? 1.f : -1.f;
+    }
+} // namespace
+
+namespace VertexQuantization
+{
+    AABB ComputeBounds(const std::vector<Vertex>& vertices)
+    {
+        AABB bounds;
+        bounds.SetNegativeInfinity();
+        for (const Vertex& vertex : vertices)
+            bounds.Enclose(vertex.position);
+
+        if (vertices.empty()) bounds = AABB(float3::zero, float3::zero);
+        return bounds;
+    }
+
+    void Encode(const std::vector<Vertex>& vertices, const AABB& bounds, std::vector<CompactVertex>& outVertices)
+    {
+        const float3 extent = bounds.Size();
+        // Flat axes have no extent, every vertex sits on the minimum
+        const float3 inverseExtent(
+            extent.x > 0.f ? 1.f / extent.x : 0.f, extent.y > 0.f ? 1.f / extent.y : 0.f,
+            extent.z > 0.f ? 1.f / extent.z : 0.f
+        );
+
+        outVertices.clear();
+        outVertices.reserve(vertices.size());
+
+        for (const Vertex& vertex : vertices)
+        {
+            const float3 normalizedPosition = (vertex.position - bounds.minPoint).Mul(inverseExtent);
+            const float2 normal             = OctahedralEncode(vertex.normal);
+            const float2 tangent            = OctahedralEncode(vertex.tangent.xyz());
+
+            CompactVertex compact;
+            compact.position[0] = ToUnorm16(normalizedPosition.x);
+            compact.position[1] = ToUnorm16(normalizedPosition.y);
+            compact.position[2] = ToUnorm16(normalizedPosition.z);
+            compact.position[3] = vertex.tangent.w < 0.f ? 0 : UINT16_MAX;
+            compact.normal[0]   = ToSnorm16(normal.x);
+            compact.normal[1]   = ToSnorm16(normal.y);
+            compact.tangent[0]  = ToSnorm16(tangent.x);
+            compact.tangent[1]  = ToSnorm16(tangent.y);
+            compact.texCoord[0] = FloatToHalf(vertex.texCoord.x);
+            compact.texCoord[1] = FloatToHalf(vertex.texCoord.y);
+
+            outVertices.push_back(compact);
+        }
+    }
+
+    void Decode(const std::vector<CompactVertex>& vertices, const AABB& bounds, std::vector<Vertex>& outVertices)
+    {
+        const float3 extent = bounds.Size();
+
+        outVertices.clear();
+        outVertices.reserve(vertices.size());
+
+        for (const CompactVertex& compact : vertices)
+        {
+            const float3 normalizedPosition(
+                compact.position[0] / UNORM16_MAX, compact.position[1] / UNORM16_MAX, compact.position[2] / UNORM16_MAX
+            );
+
+            Vertex vertex;
+            vertex.position = bounds.minPoint + normalizedPosition.Mul(extent);
+            vertex.normal   = OctahedralDecode(float2(FromSnorm16(compact.normal[0]), FromSnorm16(compact.normal[1])));
+            vertex.tangent  = float4(
+                OctahedralDecode(float2(FromSnorm16(compact.tangent[0]), FromSnorm16(compact.tangent[1]))),
+                compact.position[3] == 0 ? -1.f : 1.f
+            );
+            vertex.texCoord = float2(HalfToFloat(compact.texCoord[0]), HalfToFloat(compact.texCoord[1]));
+            vertex.joint[0] = 0;
+            vertex.joint[1] = 0;
+            vertex.joint[2] = 0;
+            vertex.joint[3] = 1;
+            vertex.weights  = float4(0, 0, 0, 1);
+
+            outVertices.push_back(vertex);
+        }
+    }
+
+    bool EncodeSkin(const std::vector<Vertex>& vertices, std::vector<SkinVertex>& outVertices)
+    {
+        bool jointsFit = true;
+
+        outVertices.clear();
+        outVertices.reserve(vertices.size());
+
+        for (const Vertex& vertex : vertices)
+        {
+            float totalWeight = 0.f;
+            for (int i = 0; i < 4; ++i)
+                totalWeight += Max(vertex.weights[i], 0.f);
+
+            if (totalWeight <= 0.f)
+            {
+                outVertices.push_back(GetDefaultSkinVertex());
+                continue;
+            }
+
+            SkinVertex skin;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (vertex.joint[i] > UINT8_MAX) jointsFit = false;
+                skin.joint[i]   = static_cast<uint8_t>(Min(vertex.joint[i], static_cast<unsigned int>(UINT8_MAX)));
+                skin.weights[i] = ToUnorm16(Max(vertex.weights[i], 0.f) / totalWeight);
+            }
+            outVertices.push_back(skin);
+        }
+
+        return jointsFit;
+    }
+
+    SkinVertex GetDefaultSkinVertex()
+    {
+        // Fully bound to the first joint
+        return SkinVertex {
+            {0, 0, 0, 0},
+            {UINT16_MAX, 0, 0, 0}
+        };
+    }
+
+    uint16_t FloatToHalf(float value)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(float));
+
+        const uint32_t sign     = (bits >> 16) & 0x8000;
+        const uint32_t exponent = (bits >> 23) & 0xff;
+        uint32_t mantissa       = bits & 0x7fffff;
+        const int halfExponent  = static_cast<int>(exponent) - 127 + 15;
+
+        if (exponent == 0xff) return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0)); // Inf or NaN
+        if (halfExponent >= 31) return static_cast<uint16_t>(sign | 0x7c00);                        // Overflow to Inf
+
+        if (halfExponent <= 0)
+        {
+            // Subnormal half, or zero when too small
+            if (halfExponent < -10) return static_cast<uint16_t>(sign);
+
+            mantissa          |= 0x800000;
+            const int shift    = 14 - halfExponent;
+            uint32_t half      = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1) ++half;
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        // Rounding can carry into the exponent, which still gives the right value
+        uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000) ++half;
+        return static_cast<uint16_t>(half);
+    }
+
+    float HalfToFloat(uint16_t value)
+    {
+        const uint32_t sign     = static_cast<uint32_t>(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1f;
+        const uint32_t mantissa = value & 0x3ff;
+
+        if (exponent == 0)
+        {
+            const float subnormal = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -subnormal : subnormal;
+        }
+
+        uint32_t bits = 0;
+        if (exponent == 31) bits = sign | 0x7f800000 | (mantissa << 13);
+        else bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+        float result = 0.f;
+        std::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+
+    float2 OctahedralEncode(const float3& direction)
+    {
+        const float length = Abs(direction.x) + Abs(direction.y) + Abs(direction.z);
+        if (length == 0.f) return float2::zero;
+
+        float2 encoded(direction.x / length, direction.y / length);
+        if (direction.z < 0.f)
+        {
+            // Fold the lower hemisphere over the diagonals
+            encoded = float2(
+                (1.f - Abs(encoded.y)) * SignNotZero(encoded.x), (1.f - Abs(encoded.x)) * SignNotZero(encoded.y)
+            );
+        }
+        return encoded;
+    }
+
+    float3 OctahedralDecode(const float2& encoded)
+    {
+        float3 direction(encoded.x, encoded.y, 1.f - Abs(encoded.x) - Abs(encoded.y));
+        const float fold  = Max(-direction.z, 0.f);
+        direction.x      += direction.x >= 0.f ? -fold : fold;
+        direction.y      += direction.y >= 0.f ? -fold : fold;
+        return direction.Normalized();
+    }
+} // namespace VertexQuantization
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Geometry/AABB.h"
+#include "Math/float2.h"
+#include "Math/float3.h"
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+struct CompactVertex;
+struct SkinVertex;
+
+// Conversions between the full Vertex layout and the quantized CompactVertex one. Positions are quantized against the
+// given bounds, so the same bounds must be used to decode them
+namespace VertexQuantization
+{
+    AABB ComputeBounds(const std::vector<Vertex>& vertices);
+
+    void Encode(const std::vector<Vertex>& vertices, const AABB& bounds, std::vector<CompactVertex>& outVertices);
+    void Decode(const std::vector<CompactVertex>& vertices, const AABB& bounds, std::vector<Vertex>& outVertices);
+    // Returns false when a joint index does not fit in the 8 bits of the stream
+    bool EncodeSkin(const std::vector<Vertex>& vertices, std::vector<SkinVertex>& outVertices);
+    SkinVertex GetDefaultSkinVertex();
+
+    uint16_t FloatToHalf(float value);
+    float HalfToFloat(uint16_t value);
+
+    // Maps a unit vector to the [-1, 1] square of an octahedron unfolded on the z = 0 plane
+    float2 OctahedralEncode(const float3& direction);
+    float3 OctahedralDecode(const float2& encoded);
+} // namespace VertexQuantization
@@ -13,6 +13,7 @@
 #include "OpenGLModule.h"
 #include "PathfinderModule.h"
 #include "Quadtree.h"
+#include "RenderState.h"
 #include "ResourceNavmesh.h"
 #include "ResourcesModule.h"
 #include "SceneModule.h"
@@ -38,10 +39,11 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
         assert(points != nullptr);
         assert(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
 
-        glBindVertexArray(linePointVAO);
-        glUseProgram(linePointProgram);
+        RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+        renderState->BindVertexArray(linePointVAO);
+        renderState->UseProgram(linePointProgram);
 
-        glUniformMatrix4fv(linePointProgram_MvpMatrixLocation, 1, GL_TRUE, reinterpret_cast<float*>(&mvpMatrix));
+        renderState->SetUniform(linePointProgram_MvpMatrixLocation, mvpMatrix);
 
         bool already = glIsEnabled(GL_DEPTH_TEST);
 
@@ -61,8 +63,7 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
         // Issue the draw call:
         App->GetOpenGLModule()->DrawArrays(GL_POINTS, 0, count);
 
-        glUseProgram(0);
-        glBindVertexArray(0);
+        renderState->BindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         checkGLError(__FILE__, __LINE__);
 
@@ -81,10 +82,11 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
         assert(lines != nullptr);
         assert(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
 
-        glBindVertexArray(linePointVAO);
-        glUseProgram(linePointProgram);
+        RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+        renderState->BindVertexArray(linePointVAO);
+        renderState->UseProgram(linePointProgram);
 
-        glUniformMatrix4fv(linePointProgram_MvpMatrixLocation, 1, GL_TRUE, reinterpret_cast<const float*>(&mvpMatrix));
+        renderState->SetUniform(linePointProgram_MvpMatrixLocation, mvpMatrix);
 
         bool already = glIsEnabled(GL_DEPTH_TEST);
 
@@ -104,8 +106,7 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
         // Issue the draw call:
         App->GetOpenGLModule()->DrawArrays(GL_LINES, 0, count);
 
-        glUseProgram(0);
-        glBindVertexArray(0);
+        renderState->BindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         checkGLError(__FILE__, __LINE__);
 
@@ -124,18 +125,17 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
         assert(glyphs != nullptr);
         assert(count > 0 && count <= DEBUG_DRAW_VERTEX_BUFFER_SIZE);
 
-        glBindVertexArray(textVAO);
-        glUseProgram(textProgram);
+        RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+        renderState->BindVertexArray(textVAO);
+        renderState->UseProgram(textProgram);
 
-        // These doesn't have to be reset every draw call, I'm just being lazy ;)
-        glUniform1i(textProgram_GlyphTextureLocation, 0);
-        glUniform2f(textProgram_ScreenDimensions, static_cast<GLfloat>(width), static_cast<GLfloat>(height));
+        // Set every draw call, the render state skips them when they did not change
+        renderState->SetUniform(textProgram_GlyphTextureLocation, 0);
+        renderState->SetUniform(
+            textProgram_ScreenDimensions, float2(static_cast<float>(width), static_cast<float>(height))
+        );
 
-        if (glyphTex != nullptr)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, handleToGL(glyphTex));
-        }
+        if (glyphTex != nullptr) renderState->BindTexture(0, handleToGL(glyphTex));
 
         bool already_blend = glIsEnabled(GL_BLEND);
 
@@ -159,10 +159,8 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
             glDisable(GL_BLEND);
         }
 
-        glUseProgram(0);
-        glBindVertexArray(0);
+        renderState->BindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
         checkGLError(__FILE__, __LINE__);
 
         if (already)
@@ -208,9 +206,8 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
         glDeleteTextures(1, &textureId);
     }
 
-    // These two can also be implemented to perform GL render
-    // state setup/cleanup, but we don't use them in this sample.
-    // void beginDraw() override { }
+    // Lines are flushed after the scene and editor passes, the bindings they left are not known
+    void beginDraw() override { App->GetOpenGLModule()->GetRenderState()->Invalidate(); }
     // void endDraw()   override { }
 
     //
@@ -247,6 +244,8 @@ class DDRenderInterfaceCoreGL final : public dd::RenderInterface
     {
         glDeleteProgram(linePointProgram);
         glDeleteProgram(textProgram);
+        App->GetOpenGLModule()->GetRenderState()->ForgetProgram(linePointProgram);
+        App->GetOpenGLModule()->GetRenderState()->ForgetProgram(textProgram);
 
         glDeleteVertexArrays(1, &linePointVAO);
         glDeleteBuffers(1, &linePointVBO);
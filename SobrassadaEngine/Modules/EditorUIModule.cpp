@@ -1,6 +1,7 @@
 #include "EditorUIModule.h"
 
 #include "Application.h"
+#include "BatchManager.h"
 #include "CameraModule.h"
 #include "Component.h"
 #include "EngineEditorBase.h"
@@ -12,6 +13,7 @@
 #include "PathfinderModule.h"
 #include "PhysicsModule.h"
 #include "ProjectModule.h"
+#include "RenderState.h"
 #include "ResourceNavmesh.h"
 
 #include "GameObject.h"
@@ -170,6 +172,7 @@ update_status EditorUIModule::RenderEditor(float deltaTime)
 
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    App->GetOpenGLModule()->GetRenderState()->Invalidate(); // ImGui binds its own program and textures
 
 #endif
     return UPDATE_CONTINUE;
@@ -1642,22 +1645,105 @@ void EditorUIModule::OpenGLConfig()
     ImGui::SameLine();
     ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%d", App->GetOpenGLModule()->GetDrawCallsCount());
 
-    const float currentTime = App->GetEngineTimer()->GetTime() / 1000.f;
-
-    if (currentTime - lastTimeOpenGL > 1.f)
-    {
-        const unsigned int tps = static_cast<unsigned int>(App->GetOpenGLModule()->GetTrianglesPerSecond());
-        lastTimeOpenGL         = currentTime;
-        tpsStr                 = FormatWithCommas(tps);
-    }
-
-    ImGui::Text("Triangles per second:");
+    ImGui::Text("Triangles:");
     ImGui::SameLine();
-    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", tpsStr.c_str());
+    ImGui::TextColored(
+        ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", FormatWithCommas(App->GetOpenGLModule()->GetTrianglesCount()).c_str()
+    );
 
     ImGui::Text("Vertices:");
     ImGui::SameLine();
     ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%d", App->GetOpenGLModule()->GetVerticesCount());
+
+    ImGui::Text("Batch submission (CPU):");
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%.3f ms", App->GetOpenGLModule()->GetBatchSubmissionTime());
+
+    ImGui::Text("GPU buffer stalls:");
+    ImGui::SameLine();
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%.3f ms", App->GetOpenGLModule()->GetBufferStallTime());
+
+    const RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+    ImGui::Text("State calls:");
+    ImGui::SameLine();
+    ImGui::TextColored(
+        ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%u issued, %u skipped", renderState->GetIssuedCalls(),
+        renderState->GetStats().skipped
+    );
+
+    if (ImGui::TreeNode("State calls"))
+    {
+        for (int call = 0; call < static_cast<int>(RenderCall::Count); ++call)
+            ImGui::Text("%s: %u", RenderCallNames[call], renderState->GetStats().issued[call]);
+        ImGui::TreePop();
+    }
+
+    if (ImGui::TreeNode("Batches"))
+    {
+        BatchManager* batchManager                      = App->GetResourcesModule()->GetBatchManager();
+        const std::vector<BatchRenderStats>& batchStats = batchManager->GetBatchStats();
+
+        if (ImGui::Button("Compact batches")) batchManager->CompactBatches();
+        ImGui::SameLine();
+        bool staticBatching = batchManager->GetStaticBatching();
+        if (ImGui::Checkbox("Static batching", &staticBatching)) batchManager->SetStaticBatching(staticBatching);
+        ImGui::Text("Draw sort: %zu draws in %.3f ms", batchManager->GetSortedDrawCount(), batchManager->GetSortTime());
+
+        if (ImGui::BeginTable("BatchStats", 13, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Batch");
+            ImGui::TableSetupColumn("Meshes");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableSetupColumn("Vertices");
+            ImGui::TableSetupColumn("CPU (ms)");
+            ImGui::TableSetupColumn("Stall (ms)");
+            ImGui::TableSetupColumn("Regions");
+            ImGui::TableSetupColumn("Models sent");
+            ImGui::TableSetupColumn("Bones sent");
+            ImGui::TableSetupColumn("Static chunks");
+            ImGui::TableSetupColumn("VBO use");
+            ImGui::TableSetupColumn("EBO use");
+            ImGui::TableSetupColumn("Fragmentation");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < batchStats.size(); ++i)
+            {
+                const BatchRenderStats& stats = batchStats[i];
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", i);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", stats.meshCount);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", stats.triangleCount);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", stats.vertexCount);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.submissionTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", stats.stallTime);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", stats.bufferDepth);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", stats.modelUploads);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", stats.boneUploads);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", stats.staticChunks);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", stats.vertexOccupancy * 100.f);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", stats.indexOccupancy * 100.f);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", stats.fragmentation * 100.f);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::TreePop();
+    }
 }
 
 void EditorUIModule::GameTimerConfig() const
@@ -242,8 +242,6 @@ class EditorUIModule : public Module
     bool depthTest               = true;
     bool faceCulling             = true;
     int frontFaceMode            = 0;
-    float lastTimeOpenGL         = 0.f;
-    std::string tpsStr;
     std::unordered_map<HashString, ComponentType> standaloneComponents;
 
     ImGuiContext* context;
@@ -5,6 +5,7 @@
 #include "Framebuffer.h"
 #include "InputModule.h"
 #include "OpenGLModule.h"
+#include "RenderState.h"
 #include "Scene.h"
 #include "Scene/Components/Standalone/UI/CanvasComponent.h"
 #include "SceneModule.h"
@@ -74,6 +75,8 @@ update_status GameUIModule::Update(float deltaTime)
 
 update_status GameUIModule::Render(float deltaTime)
 {
+    App->GetOpenGLModule()->GetRenderState()->Invalidate();
+
     for (CanvasComponent* canvas : canvases)
     {
         canvas->RenderUI();
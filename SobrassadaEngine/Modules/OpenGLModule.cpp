@@ -3,6 +3,8 @@
 #include "Application.h"
 #include "Framebuffer.h"
 #include "GBuffer.h"
+#include "GLRenderBackend.h"
+#include "RenderState.h"
 #include "WindowModule.h"
 
 #include "glew.h"
@@ -124,6 +126,8 @@ bool OpenGLModule::Init()
 
     framebuffer = new Framebuffer(App->GetWindowModule()->GetWidth(), App->GetWindowModule()->GetHeight(), true);
     gBuffer     = new GBuffer(App->GetWindowModule()->GetWidth(), App->GetWindowModule()->GetHeight());
+    backend     = new GLRenderBackend();
+    renderState = new RenderState(backend);
 
     WindowModule* windowModule = App->GetWindowModule();
     windowModule->SetVsync(windowModule->GetVsync());
@@ -153,9 +157,15 @@ update_status OpenGLModule::PreUpdate(float deltaTime)
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     }
 
-    drawCallsCount     = 0;
-    verticesCount      = 0;
-    trianglesPerSecond = 0;
+    drawCallsCount      = 0;
+    verticesCount       = 0;
+    trianglesCount      = 0;
+    batchSubmissionTime = 0.f;
+    bufferStallTime     = 0.f;
+
+    // The editor draws ImGui and loads resources out of the cache between frames
+    renderState->Invalidate();
+    renderState->ResetStats();
 
     return UPDATE_CONTINUE;
 }
@@ -182,18 +192,20 @@ bool OpenGLModule::ShutDown()
     SDL_GL_DeleteContext(App->GetWindowModule()->window);
     delete framebuffer;
     delete gBuffer;
+    delete renderState;
+    delete backend;
     return true;
 }
 
 void OpenGLModule::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
 {
-    glDrawElements(mode, count, type, indices);
+    renderState->DrawElements(mode, count, type, indices);
     drawCallsCount++;
 }
 
 void OpenGLModule::DrawArrays(GLenum mode, GLint first, GLsizei count)
 {
-    glDrawArrays(mode, first, count);
+    renderState->DrawArrays(mode, first, count);
     drawCallsCount++;
 }
 
@@ -4,6 +4,8 @@
 
 class Framebuffer;
 class GBuffer;
+class GLRenderBackend;
+class RenderState;
 typedef unsigned int GLenum;
 typedef int GLsizei;
 typedef int GLint;
@@ -23,8 +25,10 @@ class OpenGLModule : public Module
     void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
     void DrawArrays(GLenum mode, GLint first, GLsizei count);
 
-    void AddTrianglesPerSecond(float meshTrianglesPerSecond) { trianglesPerSecond += meshTrianglesPerSecond; }
+    void AddTrianglesCount(int meshTriangles) { trianglesCount += meshTriangles; }
     void AddVerticesCount(int meshVertices) { verticesCount += meshVertices; }
+    void AddBatchSubmissionTime(float milliseconds) { batchSubmissionTime += milliseconds; }
+    void AddBufferStallTime(float milliseconds) { bufferStallTime += milliseconds; }
     void AddDrawCallsCount() { drawCallsCount += 1; }
 
     void* GetContext() const { return context; }
@@ -33,9 +37,12 @@ class OpenGLModule : public Module
     float GetClearBlue() const { return clearColorBlue; }
     Framebuffer* GetFramebuffer() const { return framebuffer; }
     GBuffer* GetGBuffer() const { return gBuffer; }
+    RenderState* GetRenderState() const { return renderState; }
     int GetDrawCallsCount() const { return drawCallsCount; }
-    float GetTrianglesPerSecond() const { return trianglesPerSecond; }
+    int GetTrianglesCount() const { return trianglesCount; }
     int GetVerticesCount() const { return verticesCount; }
+    float GetBatchSubmissionTime() const { return batchSubmissionTime; }
+    float GetBufferStallTime() const { return bufferStallTime; }
 
     void SetDepthTest(bool enable);
     void SetFaceCull(bool enable);
@@ -47,13 +54,17 @@ class OpenGLModule : public Module
     void SetRenderWireframe(bool renderWireframe);
 
   private:
-    void* context            = nullptr;
-    Framebuffer* framebuffer = nullptr;
-    GBuffer* gBuffer         = nullptr;
-    float clearColorRed      = DEFAULT_GL_CLEAR_COLOR_RED;
-    float clearColorGreen    = DEFAULT_GL_CLEAR_COLOR_GREEN;
-    float clearColorBlue     = DEFAULT_GL_CLEAR_COLOR_BLUE;
-    int drawCallsCount       = 0;
-    float trianglesPerSecond = 0;
-    int verticesCount        = 0;
+    void* context             = nullptr;
+    Framebuffer* framebuffer  = nullptr;
+    GBuffer* gBuffer          = nullptr;
+    GLRenderBackend* backend  = nullptr;
+    RenderState* renderState  = nullptr; // Every per frame program, binding, uniform and draw call goes through it
+    float clearColorRed       = DEFAULT_GL_CLEAR_COLOR_RED;
+    float clearColorGreen     = DEFAULT_GL_CLEAR_COLOR_GREEN;
+    float clearColorBlue      = DEFAULT_GL_CLEAR_COLOR_BLUE;
+    int drawCallsCount        = 0;
+    int trianglesCount        = 0;
+    int verticesCount         = 0;
+    float batchSubmissionTime = 0.f; // CPU milliseconds spent submitting geometry batches this frame
+    float bufferStallTime     = 0.f; // CPU milliseconds waiting for the GPU to release persistent buffers this frame
 };
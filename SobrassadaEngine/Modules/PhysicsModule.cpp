@@ -12,6 +12,123 @@
 
 #include "Math/float3.h"
 #include "btBulletDynamicsCommon.h"
+#include <algorithm>
+
+namespace
+{
+    GameObject* GetUserGameObject(const btCollisionObject* collisionObject)
+    {
+        const BulletUserPointer* userPointer = static_cast<const BulletUserPointer*>(collisionObject->getUserPointer());
+        if (userPointer == nullptr || userPointer->collider == nullptr) return nullptr;
+        return userPointer->collider->GetParent();
+    }
+
+    // Queries only filter by the layer of the body, the collision matrix of the layers is ignored. Bodies waiting for
+    // removal are skipped before reading their user pointer, their component may already be deleted
+    bool PassesQueryFilter(
+        const btBroadphaseProxy* proxy, int layerMask, const GameObject* ignoredGameObject,
+        const std::vector<btRigidBody*>& pendingBodies
+    )
+    {
+        if ((proxy->m_collisionFilterGroup & layerMask) == 0) return false;
+
+        const btCollisionObject* collisionObject = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+        for (const btRigidBody* pendingBody : pendingBodies)
+        {
+            if (pendingBody == collisionObject) return false;
+        }
+
+        if (ignoredGameObject == nullptr) return true;
+        return GetUserGameObject(collisionObject) != ignoredGameObject;
+    }
+
+    btVector3 ToBullet(const float3& vector)
+    {
+        return btVector3(btScalar(vector.x), btScalar(vector.y), btScalar(vector.z));
+    }
+
+    struct LayerRayCallback : public btCollisionWorld::ClosestRayResultCallback
+    {
+        LayerRayCallback(
+            const btVector3& from, const btVector3& to, int layerMask, const GameObject* ignored,
+            const std::vector<btRigidBody*>& pendingBodies
+        )
+            : ClosestRayResultCallback(from, to), layerMask(layerMask), ignoredGameObject(ignored),
+              pendingBodies(pendingBodies)
+        {
+        }
+
+        bool needsCollision(btBroadphaseProxy* proxy) const override
+        {
+            return PassesQueryFilter(proxy, layerMask, ignoredGameObject, pendingBodies);
+        }
+
+        int layerMask;
+        const GameObject* ignoredGameObject;
+        const std::vector<btRigidBody*>& pendingBodies;
+    };
+
+    struct LayerConvexCallback : public btCollisionWorld::ClosestConvexResultCallback
+    {
+        LayerConvexCallback(
+            const btVector3& from, const btVector3& to, int layerMask, const GameObject* ignored,
+            const std::vector<btRigidBody*>& pendingBodies
+        )
+            : ClosestConvexResultCallback(from, to), layerMask(layerMask), ignoredGameObject(ignored),
+              pendingBodies(pendingBodies)
+        {
+        }
+
+        bool needsCollision(btBroadphaseProxy* proxy) const override
+        {
+            return PassesQueryFilter(proxy, layerMask, ignoredGameObject, pendingBodies);
+        }
+
+        int layerMask;
+        const GameObject* ignoredGameObject;
+        const std::vector<btRigidBody*>& pendingBodies;
+    };
+
+    struct OverlapCallback : public btCollisionWorld::ContactResultCallback
+    {
+        OverlapCallback(
+            const btCollisionObject* queryObject, int layerMask, std::vector<GameObject*>& found,
+            const std::vector<btRigidBody*>& pendingBodies
+        )
+            : queryObject(queryObject), layerMask(layerMask), foundGameObjects(found), pendingBodies(pendingBodies)
+        {
+        }
+
+        bool needsCollision(btBroadphaseProxy* proxy) const override
+        {
+            return PassesQueryFilter(proxy, layerMask, nullptr, pendingBodies);
+        }
+
+        btScalar addSingleResult(
+            btManifoldPoint& contactPoint, const btCollisionObjectWrapper* firstWrapper, int, int,
+            const btCollisionObjectWrapper* secondWrapper, int, int
+        ) override
+        {
+            if (contactPoint.getDistance() > 0.f) return 0.f;
+
+            const btCollisionObject* other = firstWrapper->getCollisionObject() == queryObject
+                                               ? secondWrapper->getCollisionObject()
+                                               : firstWrapper->getCollisionObject();
+
+            GameObject* gameObject         = GetUserGameObject(other);
+            if (gameObject != nullptr &&
+                std::find(foundGameObjects.begin(), foundGameObjects.end(), gameObject) == foundGameObjects.end())
+                foundGameObjects.push_back(gameObject);
+
+            return 0.f;
+        }
+
+        const btCollisionObject* queryObject;
+        int layerMask;
+        std::vector<GameObject*>& foundGameObjects;
+        const std::vector<btRigidBody*>& pendingBodies;
+    };
+} // namespace
 
 PhysicsModule::PhysicsModule()
 {
@@ -41,15 +158,7 @@ update_status PhysicsModule::PreUpdate(float time)
 {
     float deltaTime = App->GetGameTimer()->GetDeltaTime() / 1000.0f;
 
-    // REMOVE RIGID BODIES
-    for (btRigidBody* rigidBody : bodiesToRemove)
-    {
-        dynamicsWorld->removeRigidBody(rigidBody);
-        btCollisionShape* shape = rigidBody->getCollisionShape();
-        delete shape;
-        delete rigidBody;
-    }
-    bodiesToRemove.clear();
+    RemovePendingBodies();
 
     if (!App->GetSceneModule()->GetInPlayMode()) return UPDATE_CONTINUE;
 
@@ -255,6 +364,151 @@ void PhysicsModule::DeleteCapsuleRigidBody(CapsuleColliderComponent* colliderCom
     colliderComponent->rigidBody = nullptr;
 }
 
+bool PhysicsModule::RayCast(
+    const float3& from, const float3& to, PhysicsHit& outHit, int layerMask, const GameObject* ignoredGameObject
+)
+{
+    // Queries may run from collision callbacks, they never change the world. Pending bodies are removed in PreUpdate
+    outHit = PhysicsHit();
+
+    const btVector3 rayFrom = ToBullet(from);
+    const btVector3 rayTo   = ToBullet(to);
+    LayerRayCallback callback(rayFrom, rayTo, layerMask, ignoredGameObject, bodiesToRemove);
+    dynamicsWorld->rayTest(rayFrom, rayTo, callback);
+
+    if (!callback.hasHit()) return false;
+
+    outHit.gameObject = GetUserGameObject(callback.m_collisionObject);
+    outHit.hitPoint   = float3(callback.m_hitPointWorld);
+    outHit.hitNormal  = float3(callback.m_hitNormalWorld);
+    outHit.distance   = callback.m_closestHitFraction * from.Distance(to);
+
+    return outHit.HasHit();
+}
+
+bool PhysicsModule::SphereSweep(
+    const float3& from, const float3& to, float radius, PhysicsHit& outHit, int layerMask,
+    const GameObject* ignoredGameObject
+)
+{
+    const btSphereShape sphere(radius);
+    return ConvexSweep(&sphere, from, to, Quat::identity, outHit, layerMask, ignoredGameObject);
+}
+
+bool PhysicsModule::CapsuleSweep(
+    const float3& from, const float3& to, float radius, float length, const Quat& rotation, PhysicsHit& outHit,
+    int layerMask, const GameObject* ignoredGameObject
+)
+{
+    const btCapsuleShape capsule(radius, length);
+    return ConvexSweep(&capsule, from, to, rotation, outHit, layerMask, ignoredGameObject);
+}
+
+void PhysicsModule::RayCastBatch(const std::vector<PhysicsRayQuery>& queries, std::vector<PhysicsHit>& outHits)
+{
+    outHits.resize(queries.size());
+
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        const PhysicsRayQuery& query = queries[i];
+        RayCast(query.from, query.to, outHits[i], query.layerMask, query.ignoredGameObject);
+    }
+}
+
+void PhysicsModule::SphereSweepBatch(const std::vector<PhysicsSweepQuery>& queries, std::vector<PhysicsHit>& outHits)
+{
+    outHits.resize(queries.size());
+
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        const PhysicsSweepQuery& query = queries[i];
+        SphereSweep(query.from, query.to, query.radius, outHits[i], query.layerMask, query.ignoredGameObject);
+    }
+}
+
+void PhysicsModule::CapsuleSweepBatch(
+    const std::vector<PhysicsCapsuleSweepQuery>& queries, std::vector<PhysicsHit>& outHits
+)
+{
+    outHits.resize(queries.size());
+
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        const PhysicsCapsuleSweepQuery& query = queries[i];
+        CapsuleSweep(
+            query.from, query.to, query.radius, query.length, query.rotation, outHits[i], query.layerMask,
+            query.ignoredGameObject
+        );
+    }
+}
+
+int PhysicsModule::OverlapBox(
+    const float3& center, const float3& halfExtents, const Quat& rotation, std::vector<GameObject*>& outGameObjects,
+    int layerMask
+)
+{
+    btBoxShape box(ToBullet(halfExtents));
+
+    btCollisionObject queryObject;
+    queryObject.setCollisionShape(&box);
+    queryObject.setWorldTransform(
+        btTransform(btQuaternion(rotation.x, rotation.y, rotation.z, rotation.w), ToBullet(center))
+    );
+
+    return Overlap(&queryObject, outGameObjects, layerMask);
+}
+
+int PhysicsModule::OverlapSphere(
+    const float3& center, float radius, std::vector<GameObject*>& outGameObjects, int layerMask
+)
+{
+    btSphereShape sphere(radius);
+
+    btCollisionObject queryObject;
+    queryObject.setCollisionShape(&sphere);
+    queryObject.setWorldTransform(btTransform(btQuaternion::getIdentity(), ToBullet(center)));
+
+    return Overlap(&queryObject, outGameObjects, layerMask);
+}
+
+bool PhysicsModule::ConvexSweep(
+    const btConvexShape* shape, const float3& from, const float3& to, const Quat& rotation, PhysicsHit& outHit,
+    int layerMask, const GameObject* ignoredGameObject
+)
+{
+    outHit = PhysicsHit();
+
+    // Bullet can not sweep a shape without moving it
+    if (from.Equals(to)) return false;
+
+    const btVector3 sweepFrom = ToBullet(from);
+    const btVector3 sweepTo   = ToBullet(to);
+    const btQuaternion sweepRotation(rotation.x, rotation.y, rotation.z, rotation.w);
+    LayerConvexCallback callback(sweepFrom, sweepTo, layerMask, ignoredGameObject, bodiesToRemove);
+    dynamicsWorld->convexSweepTest(
+        shape, btTransform(sweepRotation, sweepFrom), btTransform(sweepRotation, sweepTo), callback
+    );
+
+    if (!callback.hasHit()) return false;
+
+    outHit.gameObject = GetUserGameObject(callback.m_hitCollisionObject);
+    outHit.hitPoint   = float3(callback.m_hitPointWorld);
+    outHit.hitNormal  = float3(callback.m_hitNormalWorld);
+    outHit.distance   = callback.m_closestHitFraction * from.Distance(to);
+
+    return outHit.HasHit();
+}
+
+int PhysicsModule::Overlap(btCollisionObject* queryObject, std::vector<GameObject*>& outGameObjects, int layerMask)
+{
+    outGameObjects.clear();
+
+    OverlapCallback callback(queryObject, layerMask, outGameObjects, bodiesToRemove);
+    dynamicsWorld->contactTest(queryObject, callback);
+
+    return static_cast<int>(outGameObjects.size());
+}
+
 void PhysicsModule::SetDebugOption(int option)
 {
     debugDraw->setDebugMode(option);
@@ -406,6 +660,11 @@ void PhysicsModule::SaveLayerData(rapidjson::Value& targetState, rapidjson::Docu
 }
 
 void PhysicsModule::EmptyWorld()
+{
+    RemovePendingBodies();
+}
+
+void PhysicsModule::RemovePendingBodies()
 {
     // REMOVE RIGID BODIES
     for (btRigidBody* rigidBody : bodiesToRemove)
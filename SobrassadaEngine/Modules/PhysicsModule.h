@@ -3,6 +3,8 @@
 #include "ComponentUtils.h"
 #include "Module.h"
 
+#include "Math/Quat.h"
+#include "Math/float3.h"
 #include <bitset>
 #include <vector>
 
@@ -13,6 +15,9 @@ class btSequentialImpulseConstraintSolver;
 class btDiscreteDynamicsWorld;
 class BulletDebugDraw;
 class btRigidBody;
+class btCollisionObject;
+class btConvexShape;
+class GameObject;
 
 class CubeColliderComponent;
 class SphereColliderComponent;
@@ -22,6 +27,44 @@ constexpr float DEFAULT_GRAVITY = -9.81f;
 
 typedef std::bitset<sizeof(ColliderLayerStrings) / sizeof(char*)> LayerBitset;
 
+struct PhysicsHit
+{
+    GameObject* gameObject = nullptr;
+    float3 hitPoint        = float3::zero;
+    float3 hitNormal       = float3::zero;
+    float distance         = 0.f;
+
+    bool HasHit() const { return gameObject != nullptr; }
+};
+
+struct PhysicsRayQuery
+{
+    float3 from                         = float3::zero;
+    float3 to                           = float3::zero;
+    int layerMask                       = ALL_COLLIDER_LAYERS;
+    const GameObject* ignoredGameObject = nullptr;
+};
+
+struct PhysicsSweepQuery
+{
+    float3 from                         = float3::zero;
+    float3 to                           = float3::zero;
+    float radius                        = 0.5f;
+    int layerMask                       = ALL_COLLIDER_LAYERS;
+    const GameObject* ignoredGameObject = nullptr;
+};
+
+struct PhysicsCapsuleSweepQuery
+{
+    float3 from                         = float3::zero;
+    float3 to                           = float3::zero;
+    Quat rotation                       = Quat::identity; // Of the Y axis of the capsule, kept along the whole sweep
+    float radius                        = 0.5f;
+    float length                        = 1.f;
+    int layerMask                       = ALL_COLLIDER_LAYERS;
+    const GameObject* ignoredGameObject = nullptr;
+};
+
 class SOBRASADA_API_ENGINE PhysicsModule : public Module
 {
   public:
@@ -51,6 +94,37 @@ class SOBRASADA_API_ENGINE PhysicsModule : public Module
     void UpdateCapsuleRigidBody(CapsuleColliderComponent* colliderComponent);
     void DeleteCapsuleRigidBody(CapsuleColliderComponent* colliderComponent);
 
+    // Closest hit queries against the rigid bodies of the world
+    bool RayCast(
+        const float3& from, const float3& to, PhysicsHit& outHit, int layerMask = ALL_COLLIDER_LAYERS,
+        const GameObject* ignoredGameObject = nullptr
+    );
+    bool SphereSweep(
+        const float3& from, const float3& to, float radius, PhysicsHit& outHit, int layerMask = ALL_COLLIDER_LAYERS,
+        const GameObject* ignoredGameObject = nullptr
+    );
+    // Capsule along its Y axis like the capsule colliders, turned by the rotation and kept so along the whole sweep
+    bool CapsuleSweep(
+        const float3& from, const float3& to, float radius, float length, const Quat& rotation, PhysicsHit& outHit,
+        int layerMask = ALL_COLLIDER_LAYERS, const GameObject* ignoredGameObject = nullptr
+    );
+
+    // Batched queries, outHits is resized to match the queries so it can be reused between frames
+    void RayCastBatch(const std::vector<PhysicsRayQuery>& queries, std::vector<PhysicsHit>& outHits);
+    void SphereSweepBatch(const std::vector<PhysicsSweepQuery>& queries, std::vector<PhysicsHit>& outHits);
+    void CapsuleSweepBatch(
+        const std::vector<PhysicsCapsuleSweepQuery>& queries, std::vector<PhysicsHit>& outHits
+    );
+
+    // Overlap queries clear outGameObjects and fill it with every object touching the shape. Returns the count
+    int OverlapBox(
+        const float3& center, const float3& halfExtents, const Quat& rotation, std::vector<GameObject*>& outGameObjects,
+        int layerMask = ALL_COLLIDER_LAYERS
+    );
+    int OverlapSphere(
+        const float3& center, float radius, std::vector<GameObject*>& outGameObjects, int layerMask = ALL_COLLIDER_LAYERS
+    );
+
     float GetGravity() const { return gravity; }
     std::vector<LayerBitset>& GetLayerConfig() { return colliderLayerConfig; }
 
@@ -64,6 +138,13 @@ class SOBRASADA_API_ENGINE PhysicsModule : public Module
 
   private:
     void AddRigidBody(btRigidBody* rigidBody, ColliderType colliderType, ColliderLayer layerType);
+    void RemovePendingBodies();
+
+    bool ConvexSweep(
+        const btConvexShape* shape, const float3& from, const float3& to, const Quat& rotation, PhysicsHit& outHit,
+        int layerMask, const GameObject* ignoredGameObject
+    );
+    int Overlap(btCollisionObject* queryObject, std::vector<GameObject*>& outGameObjects, int layerMask);
 
   private:
     float gravity                                           = DEFAULT_GRAVITY;
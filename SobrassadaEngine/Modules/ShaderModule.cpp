@@ -1,6 +1,10 @@
 #include "ShaderModule.h"
 #include "Application.h"
+#include "BatchManager.h"
 #include "DebugDrawModule.h"
+#include "OpenGLModule.h"
+#include "RenderState.h"
+#include "ResourcesModule.h"
 
 #include "glew.h"
 
@@ -51,6 +55,9 @@ unsigned int ShaderModule::CreateShaderProgram(const char* vertexPath, const cha
 
     program                 = CreateProgram(vertexId, fragmentId);
 
+    // GL reuses the names of deleted programs, even the ones deleted without this module
+    ForgetProgramState(program);
+
     free(vertexShader);
     free(fragmentShader);
 
@@ -142,6 +149,14 @@ unsigned int ShaderModule::CreateProgram(unsigned int vertexShader, unsigned fra
 void ShaderModule::DeleteProgram(unsigned int programID)
 {
     glDeleteProgram(programID);
+    ForgetProgramState(programID);
+}
+
+void ShaderModule::ForgetProgramState(unsigned int program) const
+{
+    // Uniform locations and block bindings are cached per program name
+    App->GetOpenGLModule()->GetRenderState()->ForgetProgram(program);
+    App->GetResourcesModule()->GetBatchManager()->ForgetProgram(program);
 }
 
 int ShaderModule::GetSpecularGlossinessProgram() const
@@ -25,6 +25,7 @@ class ShaderModule : public Module
     char* LoadShaderSource(const char* shaderPath);
     unsigned int CompileShader(unsigned int shaderType, const char* source);
     unsigned int CreateProgram(unsigned int vertexShader, unsigned fragmentShader);
+    void ForgetProgramState(unsigned int program) const;
 
   private:
     int specularGlossinessProgram      = -1;
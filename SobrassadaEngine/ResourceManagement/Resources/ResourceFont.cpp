@@ -1,5 +1,7 @@
 #include "ResourceFont.h"
 
+#include "TextManager.h"
+
 ResourceFont::ResourceFont(UID uid, const std::string& name) : Resource(uid, name, ResourceType::Font)
 {
 
@@ -7,4 +9,20 @@ ResourceFont::ResourceFont(UID uid, const std::string& name) : Resource(uid, nam
 
 ResourceFont::~ResourceFont()
 {
+    for (auto& fontSize : fontSizes)
+    {
+        fontSize.second->Clean();
+        delete fontSize.second;
+    }
 }
+
+const TextManager::FontData* ResourceFont::GetFontData(unsigned int fontSize)
+{
+    TextManager::FontData*& fontData = fontSizes[fontSize];
+    if (fontData == nullptr)
+    {
+        fontData = new TextManager::FontData();
+        fontData->Init(filepath.c_str(), fontSize);
+    }
+    return fontData;
+}
\ No newline at end of file
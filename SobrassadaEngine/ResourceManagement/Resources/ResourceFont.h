@@ -2,6 +2,13 @@
 
 #include "Resource.h"
 
+#include <unordered_map>
+
+namespace TextManager
+{
+    struct FontData;
+}
+
 class ResourceFont : public Resource
 {
   public:
@@ -11,6 +18,10 @@ class ResourceFont : public Resource
     const std::string& GetFilepath() const { return filepath; }
     void SetFilepath(const std::string& filepath) { this->filepath = filepath; }
 
+    // Glyph atlas of the size, built the first time it is asked for and shared by every label using it
+    const TextManager::FontData* GetFontData(unsigned int fontSize);
+
   private:
     std::string filepath;
+    std::unordered_map<unsigned int, TextManager::FontData*> fontSizes;
 };
\ No newline at end of file
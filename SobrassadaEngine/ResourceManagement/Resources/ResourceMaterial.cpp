@@ -25,7 +25,7 @@ ResourceMaterial::~ResourceMaterial()
     FreeMaterials();
 }
 
-void ResourceMaterial::OnEditorUpdate()
+bool ResourceMaterial::OnEditorUpdate()
 {
     bool updated = false;
 
@@ -174,6 +174,7 @@ void ResourceMaterial::OnEditorUpdate()
 
     // TODO: override metadata material
     // if (updated)
+    return updated;
 }
 
 UID ResourceMaterial::ChangeTexture(UID newTexture, TextureInfo& textureToChange, UID textureGPU)
@@ -35,7 +35,8 @@ class ResourceMaterial : public Resource
     ResourceMaterial(UID uid, const std::string& name, const rapidjson::Value& importOptions);
     ~ResourceMaterial() override;
 
-    void OnEditorUpdate();
+    // Returns true if the material was edited
+    bool OnEditorUpdate();
     void LoadMaterialData(Material mat);
     void FreeMaterials() const;
 
@@ -1,6 +1,7 @@
 #include "ResourceMesh.h"
 
 #include "Mesh.h"
+#include "VertexQuantization.h"
 
 #include "Math/float3.h"
 
@@ -57,4 +58,45 @@ void ResourceMesh::LoadData(
         this->indexCount = static_cast<unsigned int>(indices.size());
         this->indices    = indices;
     }
+
+    lodIndices.clear();
+    lods.assign(1, {0, indexCount});
+
+    // Only triangle lists can be raycasted against
+    if (mode == 4) bvh.Build(this->vertices, this->indices);
+}
+
+void ResourceMesh::LoadCompactData(
+    unsigned int mode, std::vector<CompactVertex>&& compactVertices, std::vector<SkinVertex>&& skinVertices,
+    const std::vector<unsigned int>& indices, const AABB& quantizationBounds
+)
+{
+    std::vector<Vertex> decodedVertices;
+    VertexQuantization::Decode(compactVertices, quantizationBounds, decodedVertices);
+
+    this->compactVertices    = std::move(compactVertices);
+    this->skinVertices       = std::move(skinVertices);
+    this->quantizationBounds = quantizationBounds;
+
+    LoadData(mode, decodedVertices, indices);
+}
+
+void ResourceMesh::LoadLODs(std::vector<unsigned int>&& lodIndices, const std::vector<unsigned int>& lodIndexCounts)
+{
+    this->lodIndices = std::move(lodIndices);
+
+    lods.resize(1);
+    unsigned int firstIndex = indexCount;
+    for (const unsigned int lodIndexCount : lodIndexCounts)
+    {
+        if (lods.size() == MAX_MESH_LODS) break;
+
+        lods.push_back({firstIndex, lodIndexCount});
+        firstIndex += lodIndexCount;
+    }
+}
+
+void ResourceMesh::LoadMeshlets(std::vector<Meshlet>&& meshlets)
+{
+    this->meshlets = std::move(meshlets);
 }
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "MeshBVH.h"
 #include "Resource.h"
 
 #include "Geometry/AABB.h"
@@ -21,6 +22,10 @@ namespace math
 
 class GameObject;
 struct Vertex;
+struct CompactVertex;
+struct SkinVertex;
+struct MeshLOD;
+struct Meshlet;
 
 class ResourceMesh : public Resource
 {
@@ -32,6 +37,14 @@ class ResourceMesh : public Resource
     ~ResourceMesh() override;
 
     void LoadData(unsigned int mode, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    // Keeps the quantized vertices for the GPU and decodes them for the CPU side users (raycasts, navmesh...)
+    void LoadCompactData(
+        unsigned int mode, std::vector<CompactVertex>&& compactVertices, std::vector<SkinVertex>&& skinVertices,
+        const std::vector<unsigned int>& indices, const AABB& quantizationBounds
+    );
+    // Simplified index lists concatenated, lodIndexCounts has the size of each one
+    void LoadLODs(std::vector<unsigned int>&& lodIndices, const std::vector<unsigned int>& lodIndexCounts);
+    void LoadMeshlets(std::vector<Meshlet>&& meshlets);
 
     const AABB& GetAABB() const { return aabb; }
     int GetIndexCount() const { return indexCount; }
@@ -40,6 +53,19 @@ class ResourceMesh : public Resource
     const std::vector<unsigned int>& GetIndices() const { return indices; }
     const float4x4& GetDefaultTransform() const { return defaultTransform; }
     const unsigned int GetMode() const { return mode; }
+    const MeshBVH& GetBVH() const { return bvh; }
+    bool IsCompact() const { return !compactVertices.empty(); }
+    const std::vector<CompactVertex>& GetCompactVertices() const { return compactVertices; }
+    bool HasSkinStream() const { return !skinVertices.empty(); }
+    const std::vector<SkinVertex>& GetSkinVertices() const { return skinVertices; }
+    const AABB& GetQuantizationBounds() const { return quantizationBounds; }
+    // The original level is always the first one, the indices of the others follow it in the GPU index list
+    const std::vector<MeshLOD>& GetLODs() const { return lods; }
+    unsigned int GetLODCount() const { return static_cast<unsigned int>(lods.size()); }
+    const std::vector<unsigned int>& GetLODIndices() const { return lodIndices; }
+    unsigned int GetTotalIndexCount() const { return indexCount + static_cast<unsigned int>(lodIndices.size()); }
+    // Clusters of the original level, empty for meshes too small to be split
+    const std::vector<Meshlet>& GetMeshlets() const { return meshlets; }
 
     const UID GetDefaultMaterialUID() const { return defaultMaterialUID; }
 
@@ -52,6 +78,13 @@ class ResourceMesh : public Resource
 
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+    std::vector<CompactVertex> compactVertices; // Only filled for meshes imported with the compact layout
+    std::vector<SkinVertex> skinVertices;       // Joints and weights of skinned compact meshes
+    AABB quantizationBounds;                    // Mesh local bounds the compact positions are quantized against
+    std::vector<unsigned int> lodIndices;       // Indices of the simplified levels, LOD0 uses indices
+    std::vector<MeshLOD> lods;
+    std::vector<Meshlet> meshlets;
+    MeshBVH bvh;
 
     bool generateTangents     = false;
     float4x4 defaultTransform = float4x4::identity;
@@ -1,12 +1,14 @@
 #include "CameraComponent.h"
 
 #include "Application.h"
+#include "BatchManager.h"
 #include "DebugDrawModule.h"
 #include "Framebuffer.h"
 #include "GBuffer.h"
 #include "GameObject.h"
 #include "InputModule.h"
 #include "OpenGLModule.h"
+#include "ResourcesModule.h"
 #include "SceneModule.h"
 
 #include "ImGui.h"
@@ -151,6 +153,7 @@ CameraComponent::~CameraComponent()
     {
         App->GetSceneModule()->GetScene()->SetMainCamera(nullptr);
     }
+    App->GetResourcesModule()->GetBatchManager()->ForgetCamera(this);
     glDeleteBuffers(1, &ubo);
     delete previewFramebuffer;
     previewFramebuffer = nullptr;
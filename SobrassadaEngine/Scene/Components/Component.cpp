@@ -39,7 +39,7 @@ void Component::RenderEditorInspector()
 {
     ImGui::InputText("Name", name, sizeof(name));
     ImGui::SameLine();
-    ImGui::Checkbox("Enabled", &enabled);
+    if (ImGui::Checkbox("Enabled", &enabled)) EnabledUpdated();
 }
 
 UID Component::GetParentUID() const
@@ -25,6 +25,7 @@ class SOBRASADA_API_ENGINE Component
     virtual void RenderDebug(float deltaTime)  = 0;
     virtual void RenderEditorInspector();
     virtual void ParentUpdated() { return; };
+    virtual void EnabledUpdated() { return; };
 
     UID GetUID() const { return uid; }
     UID GetParentUID() const;
@@ -39,7 +40,11 @@ class SOBRASADA_API_ENGINE Component
     const float4x4& GetGlobalTransform() const;
     bool IsEffectivelyEnabled() const;
 
-    void SetEnabled(bool newEnabled) { enabled = newEnabled; }
+    void SetEnabled(bool newEnabled)
+    {
+        enabled = newEnabled;
+        EnabledUpdated();
+    }
 
   protected:
     const UID uid;
@@ -62,6 +62,9 @@ enum class ColliderLayer : uint8_t
 constexpr const char* ColliderLayerStrings[] = {"World Objects", "Triggers",          "Enemies",
                                                 "Player",        "Player projectile", "Enemy projectile"};
 
+// Layer masks for the queries use the same bits as the collider layers, 1 << (int)ColliderLayer
+constexpr int ALL_COLLIDER_LAYERS = ~0;
+
 typedef Delegate<void, GameObject*, float3> CollisionDelegate;
 
 class ComponentUtils
@@ -28,6 +28,7 @@ class AnimController
 
     bool IsPlaying() const { return playAnimation; }
     bool IsFinished() const { return animationFinished; }
+    bool IsTransitioning() const { return targetAnimation != nullptr; }
 
   private:
     void GetChannelPosition(const Channel* animChannel, float3& pos, float time) const;
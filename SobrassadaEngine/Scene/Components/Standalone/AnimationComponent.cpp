@@ -51,6 +51,8 @@ AnimationComponent::AnimationComponent(const rapidjson::Value& initialState, Gam
     {
         resourceStateMachine = nullptr;
     }
+
+    if (initialState.HasMember("SharePose")) sharePose = initialState["SharePose"].GetBool();
 }
 
 AnimationComponent::~AnimationComponent()
@@ -359,6 +361,8 @@ void AnimationComponent::RenderEditorInspector()
     Component::RenderEditorInspector();
     if (enabled)
     {
+        // Off when scripts move the bones, the pose is no longer told by the clip and its time
+        ImGui::Checkbox("Share pose", &sharePose);
         OnInspector();
     }
 }
@@ -369,6 +373,7 @@ void AnimationComponent::Clone(const Component* other)
     {
         const AnimationComponent* otherAnimation = static_cast<const AnimationComponent*>(other);
         enabled                                  = otherAnimation->enabled;
+        sharePose                                = otherAnimation->sharePose;
 
         resource                                 = otherAnimation->resource;
         AddAnimation(resource);
@@ -471,6 +476,7 @@ void AnimationComponent::Save(rapidjson::Value& targetState, rapidjson::Document
     targetState.AddMember(
         "StateMachine", resourceStateMachine != nullptr ? resourceStateMachine->GetUID() : INVALID_UID, allocator
     );
+    targetState.AddMember("SharePose", sharePose, allocator);
 }
 
 void AnimationComponent::AddAnimation(UID animationUID)
@@ -40,10 +40,12 @@ class SOBRASADA_API_ENGINE AnimationComponent : public Component
     UID GetAnimationResource() const { return resource; }
     ResourceAnimation* GetCurrentAnimation() const { return currentAnimResource; }
     AnimController* GetAnimationController() { return animController; }
+    const AnimController* GetAnimationController() const { return animController; }
     ResourceStateMachine* GetResourceStateMachine() const { return resourceStateMachine; }
     const std::unordered_map<std::string, GameObject*>& GetBoneMapping() const { return boneMapping; }
     bool IsPlaying() const;
     bool IsFinished() const;
+    bool GetSharePose() const { return sharePose; }
 
     void SetAnimationResource(UID animResource);
     void UpdateBoneHierarchy(GameObject* bone);
@@ -65,4 +67,5 @@ class SOBRASADA_API_ENGINE AnimationComponent : public Component
     bool playing            = false;
     float currentTime       = 0.0f;
     float fadeTime          = 0.0f;
+    bool sharePose          = true; // Meshes in the same clip and time share their palette, off if scripts move bones
 };
\ No newline at end of file
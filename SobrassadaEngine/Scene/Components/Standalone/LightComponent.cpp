@@ -55,8 +55,8 @@ void LightComponent::RenderEditorInspector()
     if (enabled)
     {
         ImGui::SeparatorText("Light");
-        ImGui::SliderFloat3("Color", &color[0], 0.0f, 1.0f);
-        ImGui::SliderFloat("Intensity", &intensity, 0.0f, 100.0f);
+        if (ImGui::SliderFloat3("Color", &color[0], 0.0f, 1.0f)) dirty = true;
+        if (ImGui::SliderFloat("Intensity", &intensity, 0.0f, 100.0f)) dirty = true;
         ImGui::Checkbox("Draw gizmos", &drawGizmos);
         ImGui::Spacing();
     }
@@ -20,11 +20,25 @@ class LightComponent : public Component
     float GetIntensity() const { return intensity; }
     float3 GetColor() const { return color; }
 
-    void SetIntensity(const float newIntensity) { intensity = newIntensity; }
-    void SetColor(const float3& newColor) { color = newColor; }
+    void SetIntensity(const float newIntensity)
+    {
+        intensity = newIntensity;
+        dirty     = true;
+    }
+    void SetColor(const float3& newColor)
+    {
+        color = newColor;
+        dirty = true;
+    }
+
+    // Set when the light changes, the lights config uploads it again and clears it
+    bool IsDirty() const { return dirty; }
+    void MarkDirty() { dirty = true; }
+    void ClearDirty() { dirty = false; }
 
   protected:
     float intensity;
     float3 color;
     bool drawGizmos;
+    bool dirty = true;
 };
@@ -58,6 +58,7 @@ void PointLightComponent::Clone(const Component* other)
 
         range                                 = otherLight->range;
         gizmosMode                            = otherLight->gizmosMode;
+        dirty                                 = true;
     }
     else
     {
@@ -72,7 +73,7 @@ void PointLightComponent::RenderEditorInspector()
     if (enabled)
     {
         ImGui::Text("Point light parameters");
-        ImGui::SliderFloat("Range", &range, 0.0f, 10.0f);
+        if (ImGui::SliderFloat("Range", &range, 0.0f, 10.0f)) dirty = true;
 
         ImGui::Text("Gizmos mode");
         if (ImGui::RadioButton("Lines", &gizmosMode, 0))
@@ -66,6 +66,7 @@ void SpotLightComponent::Clone(const Component* other)
         range                                = otherLight->range;
         innerAngle                           = otherLight->innerAngle;
         outerAngle                           = otherLight->outerAngle;
+        dirty                                = true;
     }
     else
     {
@@ -81,14 +82,16 @@ void SpotLightComponent::RenderEditorInspector()
     {
         ImGui::Text("Spot light parameters");
 
-        ImGui::SliderFloat("Range", &range, 0.0f, 10.0f);
+        if (ImGui::SliderFloat("Range", &range, 0.0f, 10.0f)) dirty = true;
         if (ImGui::SliderFloat("Inner angle", &innerAngle, 0.0f, 90.0f))
         {
             if (innerAngle > outerAngle) outerAngle = innerAngle;
+            dirty = true;
         }
         if (ImGui::SliderFloat("Outer angle", &outerAngle, 0.0f, 90.0f))
         {
             if (outerAngle < innerAngle) innerAngle = outerAngle;
+            dirty = true;
         }
     }
 }
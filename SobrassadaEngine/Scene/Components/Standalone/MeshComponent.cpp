@@ -1,5 +1,7 @@
 #include "MeshComponent.h"
 
+#include "AnimController.h"
+#include "AnimationComponent.h"
 #include "Application.h"
 #include "BatchManager.h"
 #include "CameraComponent.h"
@@ -8,6 +10,7 @@
 #include "GameObject.h"
 #include "GeometryBatch.h"
 #include "LibraryModule.h"
+#include "Mesh.h"
 #include "MeshImporter.h"
 #include "ResourceMaterial.h"
 #include "ResourceMesh.h"
@@ -60,10 +63,14 @@ MeshComponent::MeshComponent(const rapidjson::Value& initialState, GameObject* p
 
 MeshComponent::~MeshComponent()
 {
+    // Leave the batch first, it still needs the mesh to find the geometry it frees
+    if (uniqueBatch) App->GetResourcesModule()->GetBatchManager()->RemoveBatch(batch);
+    else if (batch) App->GetResourcesModule()->GetBatchManager()->RemoveComponent(batch, this);
+    if (renderProxy != INVALID_RENDER_PROXY)
+        App->GetResourcesModule()->GetBatchManager()->GetRenderProxies().Remove(renderProxy);
+
     App->GetResourcesModule()->ReleaseResource(currentMaterial);
     App->GetResourcesModule()->ReleaseResource(currentMesh);
-
-    if (uniqueBatch) App->GetResourcesModule()->GetBatchManager()->RemoveBatch(batch);
 }
 
 void MeshComponent::Init()
@@ -72,6 +79,7 @@ void MeshComponent::Init()
     {
         batch = App->GetResourcesModule()->GetBatchManager()->RequestBatch(this);
         batch->AddComponent(this);
+        AddRenderProxy();
     }
 }
 
@@ -167,7 +175,8 @@ void MeshComponent::RenderEditorInspector()
             if (chosenMatUID != INVALID_UID) AddMaterial(chosenMatUID);
         }
 
-        if (currentMaterial != nullptr) currentMaterial->OnEditorUpdate();
+        if (currentMaterial != nullptr && currentMaterial->OnEditorUpdate())
+            App->GetResourcesModule()->GetBatchManager()->OnMaterialUpdated(currentMaterial);
     }
 }
 
@@ -207,6 +216,14 @@ void MeshComponent::AddMesh(UID resource, bool updateParent)
     ResourceMesh* newMesh = dynamic_cast<ResourceMesh*>(App->GetResourcesModule()->RequestResource(resource));
     if (newMesh != nullptr)
     {
+        // The shared batch frees the geometry of the old mesh, and is deleted if it is left empty
+        const bool wasBatched = batch != nullptr;
+        if (batch && !uniqueBatch)
+        {
+            App->GetResourcesModule()->GetBatchManager()->RemoveComponent(batch, this);
+            batch = nullptr;
+        }
+
         App->GetResourcesModule()->ReleaseResource(currentMesh);
         currentMeshName = newMesh->GetName();
         currentMesh     = newMesh;
@@ -220,7 +237,7 @@ void MeshComponent::AddMesh(UID resource, bool updateParent)
         localComponentAABB = AABB(currentMesh->GetAABB());
         if (updateParent) parent->OnAABBUpdated();
 
-        if (batch) BatchEditorMode();
+        if (wasBatched) BatchEditorMode();
     }
 }
 
@@ -249,10 +266,12 @@ void MeshComponent::AddMaterial(UID resource, bool setDefaultMaterial)
 void MeshComponent::BatchEditorMode()
 {
     if (uniqueBatch) App->GetResourcesModule()->GetBatchManager()->RemoveBatch(batch);
+    else if (batch) App->GetResourcesModule()->GetBatchManager()->RemoveComponent(batch, this);
     batch = App->GetResourcesModule()->GetBatchManager()->CreateNewBatch(this);
     batch->AddComponent(this);
     batch->LoadData();
     uniqueBatch = true;
+    AddRenderProxy();
 }
 
 void MeshComponent::OnTransformUpdated()
@@ -262,4 +281,51 @@ void MeshComponent::OnTransformUpdated()
     {
         combinedMatrix = combinedMatrix * currentMesh->GetDefaultTransform();
     }
+    if (batch) batch->OnTransformUpdated(this);
+    UpdateRenderProxy();
+}
+
+void MeshComponent::UpdateRenderProxy()
+{
+    if (renderProxy == INVALID_RENDER_PROXY) return;
+
+    RenderProxy& proxy = App->GetResourcesModule()->GetBatchManager()->GetRenderProxies().Get(renderProxy);
+    proxy.model        = combinedMatrix;
+    proxy.bounds       = parent->GetGlobalOBB();
+    proxy.mesh         = currentMesh;
+    proxy.material     = currentMaterial;
+    proxy.batch        = batch;
+    proxy.flags        = 0;
+    if (IsEffectivelyEnabled()) proxy.flags |= RENDER_PROXY_ENABLED;
+    if (parent->IsStatic()) proxy.flags |= RENDER_PROXY_STATIC;
+}
+
+bool MeshComponent::GetBonePoseKey(BonePoseKey& outKey) const
+{
+    if (!hasBones || modelUID == INVALID_UID || skinIndex == -1) return false;
+
+    // Not cached, the mesh can be reparented and the animation added, moved or removed at any time
+    const AnimationComponent* animation = parent->GetComponent<AnimationComponent*>();
+    if (animation == nullptr) animation = parent->GetComponentParent<AnimationComponent*>(App);
+    if (animation == nullptr || !animation->IsEffectivelyEnabled() || !animation->GetSharePose()) return false;
+
+    // Poses blending two clips depend on the time of both, they are not shared
+    const AnimController* controller = animation->GetAnimationController();
+    if (controller == nullptr || !controller->IsPlaying() || controller->IsTransitioning()) return false;
+    if (controller->GetCurrentAnimation() == nullptr) return false;
+
+    outKey.model = modelUID;
+    outKey.skin  = skinIndex;
+    outKey.mesh  = currentMesh;
+    outKey.clip  = controller->GetCurrentAnimation();
+    outKey.time  = controller->GetTime();
+    return true;
+}
+
+void MeshComponent::AddRenderProxy()
+{
+    // Kept while the component lives, a new batch only updates it
+    if (renderProxy == INVALID_RENDER_PROXY)
+        renderProxy = App->GetResourcesModule()->GetBatchManager()->GetRenderProxies().Add(this);
+    UpdateRenderProxy();
 }
\ No newline at end of file
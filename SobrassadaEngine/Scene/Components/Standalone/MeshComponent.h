@@ -3,6 +3,8 @@
 #include "Component.h"
 #include "Globals.h"
 
+#include "RenderProxies.h"
+
 #include "Math/float4x4.h"
 #include "rapidjson/document.h"
 #include <cstdint>
@@ -32,6 +34,9 @@ class MeshComponent : public Component
 
     void InitSkin();
     void OnTransformUpdated();
+    // Copies what the renderer needs to the render proxy, after any change to the mesh or its object
+    void UpdateRenderProxy();
+    void EnabledUpdated() override { UpdateRenderProxy(); }
 
     void BatchEditorMode();
 
@@ -47,6 +52,9 @@ class MeshComponent : public Component
     const std::vector<float4x4>& GetBindMatrices() const { return bindMatrices; }
     const float4x4& GetCombinedMatrix() const { return combinedMatrix; }
     GeometryBatch* GetBatch() const { return batch; }
+    unsigned int GetRenderProxy() const { return renderProxy; }
+    // False when the pose of the bones can't be told apart from the animation playing, the palette is not shared
+    bool GetBonePoseKey(BonePoseKey& outKey) const;
 
     void SetBones(const std::vector<GameObject*>& bones, const std::vector<UID> bonesIds)
     {
@@ -61,6 +69,9 @@ class MeshComponent : public Component
         hasBones        = true;
     }
 
+  private:
+    void AddRenderProxy();
+
   private:
     std::string currentMeshName       = "Not selected";
     ResourceMesh* currentMesh         = nullptr;
@@ -72,13 +83,15 @@ class MeshComponent : public Component
     std::vector<UID> bonesUIDs;
     std::vector<GameObject*> bones;
     std::vector<float4x4> bindMatrices;
-    bool hasBones           = false;
+    bool hasBones            = false;
+
+    UID modelUID             = INVALID_UID;
+    int skinIndex            = -1;
 
-    UID modelUID            = INVALID_UID;
-    int skinIndex           = -1;
+    float4x4 combinedMatrix  = float4x4::identity;
 
-    float4x4 combinedMatrix = float4x4::identity;
+    GeometryBatch* batch     = nullptr;
+    bool uniqueBatch         = false;
 
-    GeometryBatch* batch    = nullptr;
-    bool uniqueBatch        = false;
+    unsigned int renderProxy = INVALID_RENDER_PROXY;
 };
@@ -5,6 +5,7 @@
 #include "GameObject.h"
 #include "ImageComponent.h"
 #include "Transform2DComponent.h"
+#include "UIHitGrid.h"
 
 #include "imgui.h"
 
@@ -80,6 +81,7 @@ void ButtonComponent::Init()
 
         if (parentCanvas == nullptr) GLOG("[WARNING] Button has no parent canvas, it won't be rendered");
     }
+    if (parentCanvas) parentCanvas->MarkHitGridDirty();
 
     // Get the image
     image = parent->GetComponent<ImageComponent*>();
@@ -158,30 +160,13 @@ void ButtonComponent::RenderEditorInspector()
     ImGui::ColorEdit3("Disabled color", disabledColor.ptr());
 }
 
-bool ButtonComponent::UpdateMousePosition(const float2& mousePos, bool dismiss)
+void ButtonComponent::SetHovered(bool hovered)
 {
-    if (!isInteractable || !IsEffectivelyEnabled()) return false;
+    // A button that stopped being interactable keeps the disabled color
+    if (!IsInteractable()) hovered = false;
+    else if (hovered != isHovered && image) image->SetColor(hovered ? hoverColor : defaultColor); // On mouse enter/exit
 
-    if (!dismiss && IsWithinBounds(mousePos))
-    {
-        if (!isHovered)
-        {
-            // On mouse enter
-            if (image) image->SetColor(hoverColor);
-            isHovered = true;
-        }
-        return true;
-    }
-    else
-    {
-        if (isHovered)
-        {
-            // On mouse exit
-            if (image) image->SetColor(defaultColor);
-            isHovered = false;
-        }
-        return false;
-    }
+    isHovered = hovered;
 }
 
 void ButtonComponent::OnClick()
@@ -196,18 +181,19 @@ void ButtonComponent::OnRelease() const
     if (image) image->SetColor(hoverColor);
 }
 
-bool ButtonComponent::IsWithinBounds(const float2& pos) const
+bool ButtonComponent::GetHitRect(UIHitRect& outRect) const
 {
     if (transform2D == nullptr || parentCanvas == nullptr) return false;
 
-    // Get the position in button local space
+    // The mouse position has its origin at the bottom left corner of the canvas
     const float2 canvasCenter = float2(parentCanvas->GetWidth(), parentCanvas->GetHeight()) * 0.5f;
-    const float2 localPos     = pos - (transform2D->GetCenterPosition() + canvasCenter);
-    const float3 localRotated =
-        parent->GetGlobalTransform().RotatePart().Inverted() * float3(localPos.x, localPos.y, 0.0f);
+    const float3x3 toLocal    = parent->GetGlobalTransform().RotatePart().Inverted();
 
-    // Check if it is inside the button's AABB in local space
-    return abs(localRotated.x) <= transform2D->size.x * 0.5f && abs(localRotated.y) <= transform2D->size.y * 0.5f;
+    outRect.center            = transform2D->GetCenterPosition() + canvasCenter;
+    outRect.halfSize          = transform2D->size * 0.5f;
+    outRect.toLocalX          = float2(toLocal[0][0], toLocal[0][1]);
+    outRect.toLocalY          = float2(toLocal[1][0], toLocal[1][1]);
+    return true;
 }
 
 std::list<Delegate<void>>::iterator ButtonComponent::AddOnClickCallback(Delegate<void> newDelegate)
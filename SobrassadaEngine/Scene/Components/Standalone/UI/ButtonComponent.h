@@ -8,6 +8,7 @@
 class Transform2DComponent;
 class CanvasComponent;
 class ImageComponent;
+struct UIHitRect;
 
 class SOBRASADA_API_ENGINE ButtonComponent : public Component
 {
@@ -24,7 +25,10 @@ class SOBRASADA_API_ENGINE ButtonComponent : public Component
     void RenderDebug(float deltaTime) override;
     void RenderEditorInspector() override;
 
-    bool UpdateMousePosition(const float2& mousePos, bool dismiss = false);
+    bool IsInteractable() const { return isInteractable && IsEffectivelyEnabled(); }
+    // Rectangle the canvas hit tests, false when the button is not on a canvas
+    bool GetHitRect(UIHitRect& outRect) const;
+    void SetHovered(bool hovered);
     void OnClick();
     void OnRelease() const;
 
@@ -34,7 +38,6 @@ class SOBRASADA_API_ENGINE ButtonComponent : public Component
     void ClearAllCallbacks();
 
   private:
-    bool IsWithinBounds(const float2& pos) const;
     void OnInteractionChange() const;
 
   private:
@@ -7,6 +7,8 @@
 #include "GameObject.h"
 #include "GameUIModule.h"
 #include "ImageComponent.h"
+#include "OpenGLModule.h"
+#include "RenderState.h"
 #include "SceneModule.h"
 #include "ShaderModule.h"
 #include "Transform2DComponent.h"
@@ -15,6 +17,7 @@
 
 #include "glew.h"
 #include "imgui.h"
+#include <algorithm>
 #include <queue>
 
 CanvasComponent::CanvasComponent(UID uid, GameObject* parent) : Component(uid, parent, "Canvas", COMPONENT_CANVAS)
@@ -35,6 +38,9 @@ CanvasComponent::CanvasComponent(const rapidjson::Value& initialState, GameObjec
 CanvasComponent::~CanvasComponent()
 {
     App->GetGameUIModule()->RemoveCanvas(this);
+
+    if (vbo != 0) glDeleteBuffers(1, &vbo);
+    if (vao != 0) glDeleteVertexArrays(1, &vao);
 }
 
 void CanvasComponent::Init()
@@ -142,12 +148,12 @@ void CanvasComponent::RenderUI()
         GLOG("Error with UI Program");
         return;
     }
-    glUseProgram(uiProgram);
 
     const float4x4& view = isInWorldSpaceEditor ? App->GetCameraModule()->GetViewMatrix() : float4x4::identity;
     const float4x4& proj = isInWorldSpaceEditor ? App->GetCameraModule()->GetProjectionMatrix()
                                                 : float4x4::D3DOrthoProjLH(-1, 1, width, height);
 
+    batcher.Clear();
     for (const GameObject* child : sortedChildren)
     {
         if (!child->IsGloballyEnabled()) continue;
@@ -157,11 +163,65 @@ void CanvasComponent::RenderUI()
         if (transform) transform->RenderWidgets();
 
         UILabelComponent* uiLabel = child->GetComponent<UILabelComponent*>();
-        if (uiLabel) uiLabel->RenderUI(view, proj);
+        if (uiLabel) uiLabel->AddToBatch(batcher);
 
         ImageComponent* image = child->GetComponent<ImageComponent*>();
-        if (image) image->RenderUI(view, proj);
+        if (image) image->AddToBatch(batcher);
+    }
+    batcher.Build();
+
+    const std::vector<float>& vertices = batcher.GetVertices();
+    if (vertices.empty()) return;
+
+    if (vao == 0) InitBuffers();
+
+    // Orphans the storage of the last frame, the driver doesn't wait for the draws still reading it
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+    renderState->UseProgram(uiProgram);
+    renderState->SetUniform(1, view);
+    renderState->SetUniform(2, proj);
+    renderState->BindVertexArray(vao);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    for (const UIBatch& batch : batcher.GetBatches())
+    {
+        const GLuint lower  = static_cast<GLuint>(batch.texture & 0xFFFFFFFF);
+        const GLuint higher = static_cast<GLuint>(batch.texture >> 32);
+        renderState->SetUniform(4, lower, higher);
+        renderState->SetUniform(5, static_cast<unsigned int>(batch.type));
+        App->GetOpenGLModule()->DrawArrays(GL_TRIANGLES, batch.firstVertex, batch.vertexCount);
     }
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void CanvasComponent::InitBuffers()
+{
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    constexpr GLsizei stride = UI_BATCH_VERTEX_FLOATS * sizeof(float);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
 }
 
 void CanvasComponent::RenderEditorInspector()
@@ -180,6 +240,7 @@ void CanvasComponent::OnWindowResize(const float width, const float height)
 {
     this->width        = width;
     this->height       = height;
+    hitGridDirty       = true;
 
     localComponentAABB = AABB(
         float3(
@@ -199,6 +260,7 @@ void CanvasComponent::UpdateChildren()
 
     // TODO: Right now this updates the children list every frame in case they are reordered in hierarchy.
     // To be more optimal, this could be called only when a gameObject is dragged around the hierarchy
+    previousChildren.swap(sortedChildren);
     sortedChildren.clear();
 
     std::queue<UID> children;
@@ -219,6 +281,14 @@ void CanvasComponent::UpdateChildren()
             children.push(child);
         }
     }
+
+    // The draw order is the hit test order
+    if (sortedChildren == previousChildren) return;
+    hitGridDirty = true;
+
+    // A hovered object out of the canvas now can't be looked up anymore
+    if (std::find(sortedChildren.begin(), sortedChildren.end(), hoveredObject) == sortedChildren.end())
+        hoveredObject = nullptr;
 }
 
 void CanvasComponent::UpdateMousePosition(const float2& mousePos)
@@ -228,27 +298,55 @@ void CanvasComponent::UpdateMousePosition(const float2& mousePos)
     // Only interact with elements if canvas is in screen mode
     if (isInWorldSpaceEditor) return;
 
-    hoveredButton    = nullptr;
-    bool buttonFound = false;
+    ButtonComponent* button = FindButtonAt(mousePos);
+    if (button != GetHoveredButton())
+    {
+        if (ButtonComponent* previousButton = GetHoveredButton()) previousButton->SetHovered(false);
+        hoveredObject = button != nullptr ? button->GetParent() : nullptr;
+    }
+    if (button) button->SetHovered(true);
+}
 
-    for (int i = (int)sortedChildren.size() - 1; i >= 0; --i)
+ButtonComponent* CanvasComponent::FindButtonAt(const float2& point)
+{
+    if (hitGridDirty) BuildHitGrid();
+
+    hitGrid.FindAll(point, hits);
+    for (const unsigned int hit : hits)
     {
-        // Update all buttons
-        ButtonComponent* currentButton = sortedChildren[i]->GetComponent<ButtonComponent*>();
-        if (currentButton && currentButton->UpdateMousePosition(mousePos, buttonFound))
-        {
-            hoveredButton = currentButton;
-            buttonFound   = true;
-        }
+        ButtonComponent* button = sortedChildren[hitGrid.GetRects()[hit].order]->GetComponent<ButtonComponent*>();
+        if (button && button->IsInteractable()) return button;
     }
+    return nullptr;
+}
+
+void CanvasComponent::BuildHitGrid()
+{
+    hitRects.clear();
+    for (size_t i = 0; i < sortedChildren.size(); ++i)
+    {
+        const ButtonComponent* button = sortedChildren[i]->GetComponent<ButtonComponent*>();
+        UIHitRect rect;
+        if (button == nullptr || !button->GetHitRect(rect)) continue;
+
+        rect.order = static_cast<unsigned int>(i);
+        hitRects.push_back(rect);
+    }
+    hitGrid.Build(float2(width, height), hitRects);
+    hitGridDirty = false;
+}
+
+ButtonComponent* CanvasComponent::GetHoveredButton() const
+{
+    return hoveredObject != nullptr ? hoveredObject->GetComponent<ButtonComponent*>() : nullptr;
 }
 
 void CanvasComponent::OnMouseButtonPressed() const
 {
-    if (hoveredButton) hoveredButton->OnClick();
+    if (ButtonComponent* hoveredButton = GetHoveredButton()) hoveredButton->OnClick();
 }
 
 void CanvasComponent::OnMouseButtonReleased() const
 {
-    if (hoveredButton) hoveredButton->OnRelease();
+    if (ButtonComponent* hoveredButton = GetHoveredButton()) hoveredButton->OnRelease();
 }
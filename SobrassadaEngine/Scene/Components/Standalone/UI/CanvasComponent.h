@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Component.h"
+#include "UIBatcher.h"
+#include "UIHitGrid.h"
 
 #include <vector>
 
@@ -31,10 +33,14 @@ class CanvasComponent : public Component
     void RenderEditorInspector() override;
 
     void RenderUI();
+    const UIBatcher& GetBatcher() const { return batcher; }
     void OnWindowResize(const float width, const float height);
 
     void UpdateChildren();
     void UpdateMousePosition(const float2& mousePos);
+    // Interactable button on top at a point of the canvas, with the origin at the bottom left corner
+    ButtonComponent* FindButtonAt(const float2& point);
+    void MarkHitGridDirty() { hitGridDirty = true; }
     void OnMouseButtonPressed() const;
     void OnMouseButtonReleased() const;
 
@@ -43,6 +49,11 @@ class CanvasComponent : public Component
     float GetWidth() const { return width; }
     float GetHeight() const { return height; }
 
+  private:
+    void InitBuffers();
+    void BuildHitGrid();
+    ButtonComponent* GetHoveredButton() const;
+
   private:
     float width               = SCREEN_WIDTH;
     float height              = SCREEN_HEIGHT;
@@ -50,5 +61,17 @@ class CanvasComponent : public Component
     bool isInWorldSpaceGame   = true;
 
     std::vector<const GameObject*> sortedChildren;
-    ButtonComponent* hoveredButton = nullptr;
+    std::vector<const GameObject*> previousChildren;
+    const GameObject* hoveredObject = nullptr; // The button is looked up again, it can be removed from the object
+
+    // Buttons by the cells of the canvas they touch, only built again when the hierarchy or a Transform2D changes
+    UIHitGrid hitGrid;
+    std::vector<UIHitRect> hitRects;
+    std::vector<unsigned int> hits;
+    bool hitGridDirty = true;
+
+    // Every widget of the canvas goes in one vertex buffer, drawn in as few batches as the overlaps allow
+    UIBatcher batcher;
+    unsigned int vbo = 0;
+    unsigned int vao = 0;
 };
\ No newline at end of file
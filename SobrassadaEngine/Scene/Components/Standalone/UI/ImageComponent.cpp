@@ -5,10 +5,10 @@
 #include "EditorUIModule.h"
 #include "GameObject.h"
 #include "LibraryModule.h"
-#include "OpenGLModule.h"
 #include "ResourcesModule.h"
 #include "SceneModule.h"
 #include "Transform2DComponent.h"
+#include "UIBatcher.h"
 
 #include "ImGui.h"
 #include "glew.h"
@@ -53,7 +53,7 @@ ImageComponent::ImageComponent(const rapidjson::Value& initialState, GameObject*
 
 ImageComponent::~ImageComponent()
 {
-    ClearBuffers();
+    ReleaseTexture();
 }
 
 void ImageComponent::Init()
@@ -77,7 +77,8 @@ void ImageComponent::Init()
         if (parentCanvas == nullptr) GLOG("[WARNING] Image has no parent canvas, it won't be rendered");
     }
 
-    InitBuffers();
+    bindlessUID = glGetTextureHandleARB(texture->GetTextureID());
+    glMakeTextureHandleResidentARB(bindlessUID);
 }
 void ImageComponent::Save(rapidjson::Value& targetState, rapidjson::Document::AllocatorType& allocator) const
 {
@@ -147,92 +148,25 @@ void ImageComponent::RenderEditorInspector()
     ImGui::ColorEdit3("Image color", color.ptr());
 }
 
-void ImageComponent::RenderUI(const float4x4& view, const float4x4& proj) const
+void ImageComponent::AddToBatch(UIBatcher& batcher) const
 {
     if (parentCanvas == nullptr || transform2D == nullptr || !IsEffectivelyEnabled()) return;
 
     const float3 startPos =
         float3(transform2D->GetRenderingPosition(), 0) - parent->GetGlobalTransform().TranslatePart();
-    glUniformMatrix4fv(0, 1, GL_TRUE, parent->GetGlobalTransform().ptr());
-    glUniformMatrix4fv(1, 1, GL_TRUE, view.ptr());
-    glUniformMatrix4fv(2, 1, GL_TRUE, proj.ptr());
-
-    glUniform3fv(3, 1, color.ptr());
-    glUniform1ui(5, 1); // Tell the shader this widget is an image = 1
-
-    glBindVertexArray(vao);
-
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-    const float vertices[] = {
-        startPos.x,
-        startPos.y,
-        0.0f,
-        0.0f,
-        startPos.x,
-        startPos.y - transform2D->size.y,
-        0.0f,
-        1.0f,
-        startPos.x + transform2D->size.x,
-        startPos.y - transform2D->size.y,
-        1.0f,
-        1.0f,
-
-        startPos.x + transform2D->size.x,
-        startPos.y,
-        1.0f,
-        0.0f,
-        startPos.x,
-        startPos.y,
-        0.0f,
-        0.0f,
-        startPos.x + transform2D->size.x,
-        startPos.y - transform2D->size.y,
-        1.0f,
-        1.0f
-    };
-
-    const GLuint lower  = static_cast<GLuint>(bindlessUID & 0xFFFFFFFF);
-    const GLuint higher = static_cast<GLuint>(bindlessUID >> 32);
-    glUniform2ui(4, lower, higher);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    App->GetOpenGLModule()->DrawArrays(GL_TRIANGLES, 0, 6);
-
-    // glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-}
-
-void ImageComponent::InitBuffers()
-{
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glBindVertexArray(vao);
+    const float right  = startPos.x + transform2D->size.x;
+    const float bottom = startPos.y - transform2D->size.y;
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 24, NULL, GL_DYNAMIC_DRAW);
+    // Positions - Uvs interleaved
+    const float vertices[] = {startPos.x, startPos.y, 0.0f, 0.0f, startPos.x, bottom,     0.0f, 1.0f,
+                              right,      bottom,     1.0f, 1.0f, right,      startPos.y, 1.0f, 0.0f,
+                              startPos.x, startPos.y, 0.0f, 0.0f, right,      bottom,     1.0f, 1.0f};
 
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    bindlessUID = glGetTextureHandleARB(texture->GetTextureID());
-    glMakeTextureHandleResidentARB(bindlessUID);
+    batcher.AddWidget(bindlessUID, UIWidgetType::Image, parent->GetGlobalTransform(), color, vertices, 6);
 }
 
-void ImageComponent::ClearBuffers() const
+void ImageComponent::ReleaseTexture() const
 {
-    if (vbo != 0) glDeleteBuffers(1, &vbo);
-    if (vao != 0) glDeleteVertexArrays(1, &vao);
-
     glMakeTextureHandleNonResidentARB(bindlessUID);
     App->GetResourcesModule()->ReleaseResource(texture);
 }
@@ -261,19 +195,19 @@ void ImageComponent::MatchParentSize()
     const UID parentUID  = parent->GetParent();
     GameObject* parentGO = App->GetSceneModule()->GetScene()->GetGameObjectByUID(parentUID);
 
-    // Check if parent has transform 2D
-    if (Transform2DComponent* parentT2D = parentGO->GetComponent<Transform2DComponent*>())
-    {
-        transform2D->size     = parentT2D->size;
-        transform2D->position = float2(0, 0);
-        return;
-    }
+    float2 parentSize;
 
+    // Check if parent has transform 2D
+    if (Transform2DComponent* parentT2D = parentGO->GetComponent<Transform2DComponent*>()) parentSize = parentT2D->size;
     // Check if parent is a canvas
-    if (CanvasComponent* canvas = parentGO->GetComponent<CanvasComponent*>())
-    {
-        transform2D->size     = float2(canvas->GetWidth(), canvas->GetHeight());
-        transform2D->position = float2(0, 0);
-        return;
-    }
+    else if (CanvasComponent* canvas = parentGO->GetComponent<CanvasComponent*>())
+        parentSize = float2(canvas->GetWidth(), canvas->GetHeight());
+    else return;
+
+    // Called every frame, only tell the canvas when the rect really changes
+    if (transform2D->size.Equals(parentSize) && transform2D->position.Equals(float2::zero)) return;
+
+    transform2D->size     = parentSize;
+    transform2D->position = float2(0, 0);
+    transform2D->OnRectChanged();
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 class Transform2DComponent;
 class CanvasComponent;
+class UIBatcher;
 
 class ImageComponent : public Component
 {
@@ -21,13 +22,12 @@ class ImageComponent : public Component
     void RenderDebug(float deltaTime) override;
     void RenderEditorInspector() override;
 
-    void RenderUI(const float4x4& view, const float4x4& proj) const;
+    void AddToBatch(UIBatcher& batcher) const;
     void RemoveTransform() { transform2D = nullptr; }
     void SetColor(const float3& newColor) { color = newColor; }
 
   private:
-    void InitBuffers();
-    void ClearBuffers() const;
+    void ReleaseTexture() const;
     void ChangeTexture(const UID textureUID);
     void MatchParentSize();
 
@@ -38,8 +38,6 @@ class ImageComponent : public Component
     ResourceTexture* texture;
     float3 color;
 
-    unsigned int vbo     = 0;
-    unsigned int vao     = 0;
     bool matchParentSize = false;
     UID bindlessUID;
 };
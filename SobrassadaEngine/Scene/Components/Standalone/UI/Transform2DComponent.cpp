@@ -216,8 +216,8 @@ void Transform2DComponent::RenderEditorInspector()
         if (ImGui::DragFloat2("Y-axis bounds", &anchorsY.x, 0.001f, 0.0f, 1.0f)) OnAnchorsUpdated();
 
         ImGui::Separator();
-        ImGui::InputFloat2("Debug pos", &position.x);
-        ImGui::InputFloat2("Debug size", &size.x);
+        if (ImGui::InputFloat2("Debug pos", &position.x)) OnRectChanged();
+        if (ImGui::InputFloat2("Debug size", &size.x)) OnRectChanged();
     }
 }
 
@@ -294,6 +294,7 @@ void Transform2DComponent::UpdateParent3DTransform()
 void Transform2DComponent::OnTransform3DUpdated(const float4x4& globalTransform3D)
 {
     // When the 3D transform of the gameObject is modified this is called
+    OnRectChanged();
 
     if (transform2DUpdated || parentCanvas == nullptr)
     {
@@ -425,6 +426,8 @@ void Transform2DComponent::OnAnchorsUpdated()
 
 void Transform2DComponent::OnSizeChanged()
 {
+    OnRectChanged();
+
     // When the size is changed, update the children anchors and margins as well
     for (const auto& child : childTransforms)
     {
@@ -432,6 +435,11 @@ void Transform2DComponent::OnSizeChanged()
     }
 }
 
+void Transform2DComponent::OnRectChanged() const
+{
+    if (parentCanvas) parentCanvas->MarkHitGridDirty();
+}
+
 void Transform2DComponent::AdaptToParentChanges()
 {
     OnAnchorsUpdated();
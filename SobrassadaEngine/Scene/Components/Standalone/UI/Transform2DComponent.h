@@ -30,6 +30,8 @@ class Transform2DComponent : public Component
     void OnParentChange();
     void GetCanvas();
     void AdaptToParentChanges();
+    // The canvas hit tests the buttons by their rects, it builds them again after this
+    void OnRectChanged() const;
 
     float2 GetRenderingPosition() const;
     float2 GetGlobalPosition() const;
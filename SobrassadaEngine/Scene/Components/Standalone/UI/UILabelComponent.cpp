@@ -12,17 +12,15 @@
 #include "ShaderModule.h"
 #include "TextManager.h"
 #include "Transform2DComponent.h"
+#include "UIBatcher.h"
 #include "WindowModule.h"
 #include "HashString.h"
 
-#include "glew.h"
 #include "imgui.h"
 
 UILabelComponent::UILabelComponent(UID uid, GameObject* parent)
     : text("Le Sobrassada"), Component(uid, parent, "Label", COMPONENT_LABEL)
 {
-    fontData = new TextManager::FontData();
-
     // Set the default font resource
     fontType = static_cast<ResourceFont*>(
         App->GetResourcesModule()->RequestResource(App->GetLibraryModule()->GetFontMap().at(HashString("Roboto-Regular")))
@@ -32,8 +30,6 @@ UILabelComponent::UILabelComponent(UID uid, GameObject* parent)
 UILabelComponent::UILabelComponent(const rapidjson::Value& initialState, GameObject* parent)
     : Component(initialState, parent)
 {
-    fontData            = new TextManager::FontData();
-
     const char* textPtr = initialState["Text"].GetString();
     strcpy_s(text, sizeof(text), textPtr);
     fontSize = initialState["FontSize"].GetInt();
@@ -63,13 +59,7 @@ UILabelComponent::UILabelComponent(const rapidjson::Value& initialState, GameObj
 
 UILabelComponent::~UILabelComponent()
 {
-    fontData->Clean();
-    delete fontData;
-
     App->GetResourcesModule()->ReleaseResource(fontType);
-
-    if (vbo != 0) glDeleteBuffers(1, &vbo);
-    if (vao != 0) glDeleteVertexArrays(1, &vao);
 }
 
 void UILabelComponent::Init()
@@ -92,9 +82,7 @@ void UILabelComponent::Init()
         if (parentCanvas == nullptr) GLOG("[WARNING] Label has no parent canvas, it won't be rendered");
     }
 
-    fontData->Clean();
-    fontData->Init(fontType->GetFilepath().c_str(), fontSize);
-    InitBuffers();
+    fontData = fontType->GetFontData(fontSize);
 }
 
 void UILabelComponent::Save(rapidjson::Value& targetState, rapidjson::Document::AllocatorType& allocator) const
@@ -129,8 +117,8 @@ void UILabelComponent::Clone(const Component* other)
         fontType  = otherLabel->fontType;
         fontType->AddReference();
 
-        fontData->Clean();
-        fontData->Init(fontType->GetFilepath().c_str(), fontSize);
+        fontData           = fontType->GetFontData(fontSize);
+        layout.textChanged = true;
     }
     else
     {
@@ -143,9 +131,9 @@ void UILabelComponent::RenderDebug(float deltaTime)
 
 }
 
-void UILabelComponent::RenderUI(const float4x4& view, const float4x4 proj) const
+void UILabelComponent::AddToBatch(UIBatcher& batcher)
 {
-    if (parentCanvas == nullptr || !IsEffectivelyEnabled()) return;
+    if (parentCanvas == nullptr || fontData == nullptr || fontData->textureID == 0 || !IsEffectivelyEnabled()) return;
 
     float width = 0;
     float3 startPos;
@@ -154,15 +142,12 @@ void UILabelComponent::RenderUI(const float4x4& view, const float4x4 proj) const
         startPos = float3(transform2D->GetRenderingPosition(), 0) - parent->GetGlobalTransform().TranslatePart();
         width = transform2D->size.x;
     }
-    glUniformMatrix4fv(0, 1, GL_TRUE, parent->GetGlobalTransform().ptr());
-    glUniformMatrix4fv(1, 1, GL_TRUE, view.ptr());
-    glUniformMatrix4fv(2, 1, GL_TRUE, proj.ptr());
 
-    glUniform3fv(3, 1, fontColor.ptr()); // Font color
-    glUniform1ui(5, 0);                  // Tell the shader this widget is a label = 0
-
-    glBindVertexArray(vao);
-    TextManager::RenderText(*fontData, text, startPos, vbo, width);
+    TextManager::UpdateTextLayout(*fontData, text, startPos, width, layout);
+    batcher.AddWidget(
+        fontData->bindlessUID, UIWidgetType::Label, parent->GetGlobalTransform(), fontColor, layout.vertices.data(),
+        static_cast<unsigned int>(layout.vertices.size() / UI_WIDGET_VERTEX_FLOATS)
+    );
 }
 
 void UILabelComponent::RenderEditorInspector()
@@ -172,7 +157,7 @@ void UILabelComponent::RenderEditorInspector()
     if (enabled)
     {
         ImGui::Text("Label");
-        ImGui::InputTextMultiline("Label Text", &text[0], sizeof(text));
+        if (ImGui::InputTextMultiline("Label Text", &text[0], sizeof(text))) layout.textChanged = true;
 
         if (ImGui::InputInt("Font Size", &fontSize))
         {
@@ -192,9 +177,12 @@ void UILabelComponent::RenderEditorInspector()
                 {
                     selectedItemIndex = i;
 
-                    fontType = static_cast<ResourceFont*>(App->GetResourcesModule()->RequestResource(font.second));
-                    fontData->Clean();
-                    fontData->Init(fontType->GetFilepath().c_str(), fontSize);
+                    // Requested before releasing the old one, picking the same font keeps its atlases alive
+                    const ResourceFont* oldFont = fontType;
+                    fontType                    =
+                        static_cast<ResourceFont*>(App->GetResourcesModule()->RequestResource(font.second));
+                    App->GetResourcesModule()->ReleaseResource(oldFont);
+                    OnFontChange();
                 }
 
                 if (is_selected) ImGui::SetItemDefaultFocus();
@@ -207,27 +195,9 @@ void UILabelComponent::RenderEditorInspector()
     }
 }
 
-void UILabelComponent::InitBuffers()
-{
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glBindVertexArray(vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 24, NULL, GL_DYNAMIC_DRAW);
-
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
-
 void UILabelComponent::OnFontChange()
 {
-    fontData->Clean();
-    fontData->Init(fontType->GetFilepath().c_str(), fontSize);
+    // A new font can be allocated where the released one was, the pointer alone can't tell
+    fontData           = fontType->GetFontData(fontSize);
+    layout.textChanged = true;
 }
\ No newline at end of file
@@ -1,22 +1,14 @@
 #pragma once
 
 #include "Component.h"
+#include "TextManager.h"
 
 #include "Math/float3.h"
 
-namespace TextManager
-{
-    struct FontData;
-}
-
-namespace Math
-{
-    class float4x4;
-}
-
 class Transform2DComponent;
 class CanvasComponent;
 class ResourceFont;
+class UIBatcher;
 
 class UILabelComponent : public Component
 {
@@ -33,24 +25,21 @@ class UILabelComponent : public Component
     void RenderDebug(float deltaTime) override;
     void RenderEditorInspector() override;
 
-    void RenderUI(const float4x4& view, const float4x4 proj) const;
+    void AddToBatch(UIBatcher& batcher);
     void RemoveTransform() { transform2D = nullptr; }
 
   private:
-    void InitBuffers();
     void OnFontChange();
 
   private:
     Transform2DComponent* transform2D;
-    TextManager::FontData* fontData;
+    const TextManager::FontData* fontData = nullptr; // Owned by the font resource, shared by the labels of its size
+    TextManager::TextLayout layout;
 
     char text[512];
     int fontSize = 48;
     float3 fontColor;
     ResourceFont* fontType;
 
-    unsigned int vbo = 0;
-    unsigned int vao = 0;
-
     CanvasComponent* parentCanvas;
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Component.h"
 #include "DebugDrawModule.h"
 #include "EditorUIModule.h"
+#include "GeometryBatch.h"
 #include "PrefabManager.h"
 #include "SceneModule.h"
 
@@ -421,7 +422,8 @@ void GameObject::RenderEditorInspector()
     ImGui::Text(name.c_str());
 
     ImGui::SameLine();
-    ImGui::Checkbox("Enabled", &enabled);
+    bool isEnabled = enabled;
+    if (ImGui::Checkbox("Enabled", &isEnabled)) SetEnabled(isEnabled);
 
     if (uid != App->GetSceneModule()->GetScene()->GetGameObjectRootUID())
     {
@@ -571,6 +573,12 @@ void GameObject::OnTransformUpdated()
     Transform2DComponent* transform2D = GetComponent<Transform2DComponent*>();
     if (transform2D) transform2D->OnTransform3DUpdated(globalTransform);
 
+    // Lights are only uploaded again when they change
+    PointLightComponent* pointLight = GetComponent<PointLightComponent*>();
+    if (pointLight) pointLight->MarkDirty();
+    SpotLightComponent* spotLight = GetComponent<SpotLightComponent*>();
+    if (spotLight) spotLight->MarkDirty();
+
     if (mobilitySettings == STATIC) App->GetSceneModule()->GetScene()->SetStaticModified();
     else App->GetSceneModule()->GetScene()->SetDynamicModified();
 }
@@ -1107,6 +1115,42 @@ void GameObject::CreatePrefab()
     }
 }
 
+void GameObject::SetEnabled(bool state)
+{
+    if (enabled == state) return;
+    enabled = state;
+
+    // The render proxies of the branch change visibility, and static chunks only merge enabled meshes
+    std::stack<UID> childrenBuffer;
+    childrenBuffer.push(uid);
+
+    while (!childrenBuffer.empty())
+    {
+        GameObject* gameObject = App->GetSceneModule()->GetScene()->GetGameObjectByUID(childrenBuffer.top());
+        childrenBuffer.pop();
+        if (gameObject == nullptr) continue;
+
+        MeshComponent* meshComponent = gameObject->GetComponent<MeshComponent*>();
+        if (meshComponent != nullptr)
+        {
+            meshComponent->UpdateRenderProxy();
+            if (gameObject->IsStatic() && meshComponent->GetBatch() != nullptr)
+                meshComponent->GetBatch()->MarkStaticChunksDirty();
+        }
+
+        for (UID child : gameObject->GetChildren())
+            childrenBuffer.push(child);
+    }
+}
+
+void GameObject::SetMobility(MobilitySettings newMobility)
+{
+    mobilitySettings             = newMobility;
+
+    MeshComponent* meshComponent = GetComponent<MeshComponent*>();
+    if (meshComponent != nullptr) meshComponent->UpdateRenderProxy();
+}
+
 bool GameObject::IsGloballyEnabled() const
 {
     if (!enabled) return false;
@@ -140,7 +140,7 @@ class SOBRASADA_API_ENGINE GameObject
     void SetPosition(float3& newPosition) { position = newPosition; };
     void SetWillUpdate(bool willUpdate) { this->willUpdate = willUpdate; };
     bool IsEnabled() const { return enabled; }
-    void SetEnabled(bool state) { enabled = state; }
+    void SetEnabled(bool state);
     void SetComponentCreated(int position) { createdComponents[position] = true; }
     void SetComponentRemoved(int position) { createdComponents[position] = false; }
     void SetSelectParent(bool newSelectParent) { selectParent = newSelectParent; }
@@ -150,7 +150,7 @@ class SOBRASADA_API_ENGINE GameObject
     void DrawNodes() const;
     void OnDrawConnectionsToggle();
 
-    void SetMobility(MobilitySettings newMobility) { mobilitySettings = newMobility; };
+    void SetMobility(MobilitySettings newMobility);
 
   public:
     inline static UID currentRenamingUID = INVALID_UID;
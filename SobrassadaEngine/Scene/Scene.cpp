@@ -23,6 +23,7 @@
 #include "PhysicsModule.h"
 #include "ProjectModule.h"
 #include "Quadtree.h"
+#include "RenderState.h"
 #include "Resource.h"
 #include "ResourceModel.h"
 #include "ResourcePrefab.h"
@@ -46,6 +47,7 @@
 #include "optick.h"
 #endif
 
+#include <algorithm>
 #include <set>
 
 Scene::Scene(const char* sceneName) : sceneUID(GenerateUID())
@@ -287,6 +289,9 @@ void Scene::RenderScene(float deltaTime, CameraComponent* camera)
                              : camera != nullptr                      ? camera->GetFramebuffer()
                                                                       : App->GetOpenGLModule()->GetFramebuffer();
 
+    // Resources loaded since the last pass may have changed the bindings
+    App->GetOpenGLModule()->GetRenderState()->Invalidate();
+
     std::vector<GameObject*> objectsToRender;
     CheckObjectsToRender(objectsToRender, camera);
 
@@ -295,7 +300,7 @@ void Scene::RenderScene(float deltaTime, CameraComponent* camera)
 #endif
     glEnable(GL_STENCIL_TEST);
 
-    GeometryPassRender(objectsToRender, camera, gbuffer);
+    GeometryPassRender(camera, gbuffer);
 
     LightingPassRender(objectsToRender, camera, gbuffer, framebuffer);
 
@@ -870,25 +875,22 @@ void Scene::CheckObjectsToRender(std::vector<GameObject*>& outRenderGameObjects,
 #endif
     std::vector<GameObject*> queriedObjects;
 
-    FrustumPlanes frustumPlanes;
-    if (camera == nullptr) frustumPlanes = App->GetCameraModule()->GetFrustrumPlanes();
-    else frustumPlanes = camera->GetFrustrumPlanes();
+    const FrustumPlanes& frustumPlanes =
+        camera == nullptr ? App->GetCameraModule()->GetFrustrumPlanes() : camera->GetFrustrumPlanes();
 
     sceneOctree->QueryElements<FrustumPlanes>(frustumPlanes, queriedObjects);
 
     dynamicTree->QueryElements<FrustumPlanes>(frustumPlanes, queriedObjects);
 
+    // Meshes are culled again by the BatchManager on its render proxies, these are for the components that render
+    // on their own
     for (auto gameObject : queriedObjects)
     {
-        OBB objectOBB = gameObject->GetGlobalOBB();
-
-        if (frustumPlanes.Intersects(objectOBB)) outRenderGameObjects.push_back(gameObject);
+        if (frustumPlanes.Intersects(gameObject->GetGlobalOBB())) outRenderGameObjects.push_back(gameObject);
     }
 }
 
-void Scene::GeometryPassRender(
-    const std::vector<GameObject*>& objectsToRender, CameraComponent* camera, GBuffer* gbuffer
-) const
+void Scene::GeometryPassRender(CameraComponent* camera, GBuffer* gbuffer) const
 {
     gbuffer->Bind();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
@@ -898,16 +900,7 @@ void Scene::GeometryPassRender(
 
     glDisable(GL_BLEND);
 
-    BatchManager* batchManager = App->GetResourcesModule()->GetBatchManager();
-    std::vector<MeshComponent*> meshesToRender;
-
-    for (const auto& gameObject : objectsToRender)
-    {
-        MeshComponent* mesh = gameObject->GetComponent<MeshComponent*>();
-        if (mesh != nullptr && mesh->GetEnabled() && mesh->GetBatch() != nullptr) meshesToRender.push_back(mesh);
-    }
-
-    batchManager->Render(meshesToRender, camera);
+    App->GetResourcesModule()->GetBatchManager()->Render(camera);
     gbuffer->Unbind();
 
     glEnable(GL_BLEND);
@@ -976,31 +969,31 @@ void Scene::LightingPassRender(
     glStencilFunc(GL_EQUAL, 1, 0xFF);
     glStencilMask(0xFF);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gbuffer->diffuseTexture);
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, gbuffer->specularTexture);
-
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, gbuffer->positionTexture);
-
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, gbuffer->normalTexture);
+    RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+    renderState->BindTexture(0, gbuffer->diffuseTexture);
+    renderState->BindTexture(1, gbuffer->specularTexture);
+    renderState->BindTexture(2, gbuffer->positionTexture);
+    renderState->BindTexture(3, gbuffer->normalTexture);
 
-    lightsConfig->SetLightsShaderData();
+    // The light clusters are built for the camera that renders the frame
+    if (camera == nullptr)
+        lightsConfig->SetLightsShaderData(
+            App->GetCameraModule()->GetViewMatrix(), App->GetCameraModule()->GetProjectionMatrix()
+        );
+    else lightsConfig->SetLightsShaderData(camera->GetViewMatrix(), camera->GetProjectionMatrix());
 
     unsigned int lightingPassProgram = App->GetShaderModule()->GetLightingPassProgram();
 
-    glUseProgram(lightingPassProgram);
+    renderState->UseProgram(lightingPassProgram);
 
     float3 cameraPos;
     if (camera == nullptr) cameraPos = App->GetCameraModule()->GetCameraPosition();
     else cameraPos = camera->GetCameraPosition();
 
-    glUniform3fv(glGetUniformLocation(lightingPassProgram, "cameraPos"), 1, &cameraPos[0]);
+    renderState->SetUniform(renderState->GetUniformLocation(lightingPassProgram, "cameraPos"), cameraPos);
 
     App->GetOpenGLModule()->DrawArrays(GL_TRIANGLES, 0, 3);
+    lightsConfig->LockLightBuffers();
 
     glDisable(GL_STENCIL_TEST);
 
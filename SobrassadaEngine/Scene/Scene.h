@@ -126,8 +126,7 @@ class SOBRASADA_API_ENGINE Scene
     void CreateStaticSpatialDataStruct();
     void CreateDynamicSpatialDataStruct();
     void CheckObjectsToRender(std::vector<GameObject*>& outRenderGameObjects, CameraComponent* camera) const;
-    void GeometryPassRender(const std::vector<GameObject*>& objectsToRender, CameraComponent* camera, GBuffer* gbuffer)
-        const;
+    void GeometryPassRender(CameraComponent* camera, GBuffer* gbuffer) const;
     void LightingPassRender(
         const std::vector<GameObject*>& renderGameObjects, CameraComponent* camera, GBuffer* gbuffer,
         Framebuffer* framebuffer
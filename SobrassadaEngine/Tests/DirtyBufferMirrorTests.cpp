@@ -0,0 +1,59 @@
+#include "DirtyBufferMirror.h"
+#include "TestCheck.h"
+
+namespace
+{
+    void TestMergedRanges()
+    {
+        DirtyBufferMirror<int> mirror(2);
+        mirror.Resize(64);
+        mirror.ClearDirty();
+
+        // Slots within the merge distance join the last range, the clean ones between them are uploaded too
+        CHECK(mirror.Set(10, 1));
+        CHECK(mirror.Set(12, 1));
+        CHECK(!mirror.Set(12, 1));
+        CHECK(mirror.Set(20, 1));
+        CHECK(mirror.GetDirtyRanges().size() == 2);
+        CHECK(mirror.GetDirtyCount() == 4);
+    }
+
+    void TestOverlappingRanges()
+    {
+        DirtyBufferMirror<int> mirror(4);
+        mirror.Resize(64);
+        mirror.ClearDirty();
+
+        // Writing back before the last range opens a new one, over slots already dirty
+        mirror.Set(10, 1);
+        mirror.Set(14, 1); // Merged, 10 to 14
+        mirror.Set(30, 1);
+        mirror.Set(12, 1); // Inside 10 to 14
+        mirror.Set(40, 1);
+        mirror.Set(11, 1); // Inside 10 to 14 too
+        CHECK(mirror.GetDirtyRanges().size() == 5);
+        CHECK(mirror.GetDirtyCount() == 7);
+    }
+
+    void TestResize()
+    {
+        DirtyBufferMirror<int> mirror;
+        mirror.Resize(16);
+        CHECK(mirror.GetDirtyCount() == 16);
+
+        mirror.Set(3, 1);
+        CHECK(mirror.GetDirtyCount() == 16);
+
+        mirror.ClearDirty();
+        CHECK(mirror.GetDirtyCount() == 0);
+        CHECK(!mirror.IsDirty());
+    }
+} // namespace
+
+int main()
+{
+    TestMergedRanges();
+    TestOverlappingRanges();
+    TestResize();
+    return TEST_RESULT();
+}
@@ -0,0 +1,298 @@
+#include "GlyphAtlas.h"
+#include "TestCheck.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Every glyph is filled with its own value, so the copy into the atlas can be told apart
+    GlyphBitmap MakeGlyph(uint32_t codepoint, unsigned int width, unsigned int height, unsigned char value)
+    {
+        GlyphBitmap glyph;
+        glyph.codepoint = codepoint;
+        glyph.width     = width;
+        glyph.height    = height;
+        glyph.left      = 1;
+        glyph.top       = static_cast<int>(height);
+        glyph.advance   = (width + 2) * 64;
+        glyph.pixels.assign(static_cast<size_t>(width) * height, value);
+        return glyph;
+    }
+
+    // Top left pixel of a packed glyph, back from its uvs
+    void GetRect(const GlyphAtlas& atlas, uint32_t codepoint, unsigned int& x, unsigned int& y)
+    {
+        const AtlasGlyph* glyph = atlas.FindGlyph(codepoint);
+        x                       = static_cast<unsigned int>(glyph->uvMin.x * atlas.GetSize() + 0.5f);
+        y                       = static_cast<unsigned int>(glyph->uvMin.y * atlas.GetSize() + 0.5f);
+    }
+
+    void TestSmallestSize()
+    {
+        // Three 20 pixel glyphs and their padding fill a 64 pixel shelf, three shelves fill the atlas
+        std::vector<GlyphBitmap> glyphs;
+        for (unsigned int i = 0; i < 9; ++i)
+            glyphs.push_back(MakeGlyph('A' + i, 20, 20, static_cast<unsigned char>(i + 1)));
+
+        GlyphAtlas atlas;
+        CHECK(atlas.Pack(glyphs));
+        CHECK(atlas.GetSize() == 64);
+        CHECK(atlas.GetPixels().size() == 64 * 64);
+
+        // One more doesn't fit, the next power of two does
+        glyphs.push_back(MakeGlyph('J', 20, 20, 10));
+        CHECK(atlas.Pack(glyphs));
+        CHECK(atlas.GetSize() == 128);
+        CHECK(atlas.GetPixels().size() == 128 * 128);
+    }
+
+    void TestPadding()
+    {
+        // Mixed heights, so the shelves start at different heights and glyphs of a shelf differ
+        std::vector<GlyphBitmap> glyphs;
+        for (unsigned int i = 0; i < 40; ++i)
+            glyphs.push_back(MakeGlyph('A' + i, 3 + (i * 7) % 17, 2 + (i * 5) % 23, static_cast<unsigned char>(i + 1)));
+        glyphs.push_back(MakeGlyph(' ', 0, 0, 0));
+
+        GlyphAtlas atlas;
+        CHECK(atlas.Pack(glyphs));
+        const unsigned int size                  = atlas.GetSize();
+        const std::vector<unsigned char>& pixels = atlas.GetPixels();
+
+        for (size_t i = 0; i < glyphs.size(); ++i)
+        {
+            const GlyphBitmap& glyph = glyphs[i];
+            if (glyph.width == 0) continue;
+
+            unsigned int x;
+            unsigned int y;
+            GetRect(atlas, glyph.codepoint, x, y);
+
+            // Inside the atlas with the padding around it
+            CHECK(x >= GLYPH_ATLAS_PADDING && y >= GLYPH_ATLAS_PADDING);
+            CHECK(x + glyph.width + GLYPH_ATLAS_PADDING <= size);
+            CHECK(y + glyph.height + GLYPH_ATLAS_PADDING <= size);
+
+            // The size in uvs is the bitmap size
+            const AtlasGlyph* packed = atlas.FindGlyph(glyph.codepoint);
+            CHECK_NEAR((packed->uvMax.x - packed->uvMin.x) * size, float(glyph.width), 1e-3f);
+            CHECK_NEAR((packed->uvMax.y - packed->uvMin.y) * size, float(glyph.height), 1e-3f);
+
+            // No other glyph comes closer than the padding
+            for (size_t j = 0; j < i; ++j)
+            {
+                const GlyphBitmap& other = glyphs[j];
+                if (other.width == 0) continue;
+
+                unsigned int otherX;
+                unsigned int otherY;
+                GetRect(atlas, other.codepoint, otherX, otherY);
+                const bool apart = x >= otherX + other.width + GLYPH_ATLAS_PADDING ||
+                                   otherX >= x + glyph.width + GLYPH_ATLAS_PADDING ||
+                                   y >= otherY + other.height + GLYPH_ATLAS_PADDING ||
+                                   otherY >= y + glyph.height + GLYPH_ATLAS_PADDING;
+                CHECK(apart);
+            }
+
+            // The bitmap was copied to its place, the padding around it is left empty
+            CHECK(pixels[static_cast<size_t>(y) * size + x] == glyph.pixels[0]);
+            CHECK(pixels[static_cast<size_t>(y + glyph.height - 1) * size + x + glyph.width - 1] == glyph.pixels[0]);
+            CHECK(pixels[static_cast<size_t>(y - 1) * size + x] == 0);
+            CHECK(pixels[static_cast<size_t>(y) * size + x - 1] == 0);
+        }
+
+        // Empty glyphs take no room but are still found
+        CHECK(atlas.FindGlyph(' ') != nullptr);
+    }
+
+    void TestTooBig()
+    {
+        GlyphAtlas atlas;
+        CHECK(atlas.Pack({MakeGlyph('A', 10, 10, 1)}));
+        CHECK(atlas.GetSize() == GLYPH_ATLAS_MIN_SIZE);
+
+        // The padding doesn't fit next to a glyph as wide as the biggest atlas
+        CHECK(!atlas.Pack({MakeGlyph('B', GLYPH_ATLAS_MAX_SIZE, 1, 1)}));
+
+        // A failed pack keeps the previous atlas
+        CHECK(atlas.GetSize() == GLYPH_ATLAS_MIN_SIZE);
+        CHECK(atlas.FindGlyph('A') != nullptr);
+        CHECK(atlas.FindGlyph('B') == nullptr);
+    }
+
+    void TestQuads()
+    {
+        // A sits on the baseline, g goes 3 pixels below it
+        GlyphBitmap a = MakeGlyph('A', 10, 12, 1);
+        GlyphBitmap g = MakeGlyph('g', 8, 11, 2);
+        g.left        = 2;
+        g.top         = 8;
+        g.advance     = 9 * 64 + 16;
+
+        GlyphAtlas atlas;
+        CHECK(atlas.Pack({a, g}));
+
+        std::vector<float> vertices;
+        CHECK(atlas.BuildQuads("Ag", float3(100.f, 200.f, 0.f), 20, 0.f, vertices) == 2);
+        CHECK(vertices.size() == 2 * GLYPH_QUAD_FLOATS);
+        if (vertices.size() != 2 * GLYPH_QUAD_FLOATS) return;
+
+        // First vertex is the top left corner, second the bottom left, third the bottom right
+        const AtlasGlyph* glyphA = atlas.FindGlyph('A');
+        const float* quadA       = vertices.data();
+        CHECK_NEAR(quadA[0], 101.f, 1e-4f);
+        CHECK_NEAR(quadA[1], 192.f, 1e-4f);
+        CHECK_NEAR(quadA[2], glyphA->uvMin.x, 1e-6f);
+        CHECK_NEAR(quadA[3], glyphA->uvMin.y, 1e-6f);
+        CHECK_NEAR(quadA[4], 101.f, 1e-4f);
+        CHECK_NEAR(quadA[5], 180.f, 1e-4f);
+        CHECK_NEAR(quadA[7], glyphA->uvMax.y, 1e-6f);
+        CHECK_NEAR(quadA[8], 111.f, 1e-4f);
+        CHECK_NEAR(quadA[10], glyphA->uvMax.x, 1e-6f);
+
+        // The pen moved by the advance of A, 12 pixels
+        const AtlasGlyph* glyphG = atlas.FindGlyph('g');
+        const float* quadG       = vertices.data() + GLYPH_QUAD_FLOATS;
+        CHECK_NEAR(quadG[0], 114.f, 1e-4f);
+        CHECK_NEAR(quadG[1], 188.f, 1e-4f);
+        CHECK_NEAR(quadG[5], 177.f, 1e-4f);
+        CHECK_NEAR(quadG[8], 122.f, 1e-4f);
+        CHECK_NEAR(quadG[2], glyphG->uvMin.x, 1e-6f);
+        CHECK_NEAR(quadG[11], glyphG->uvMax.y, 1e-6f);
+
+        // Characters out of the atlas without a fallback glyph are dropped
+        vertices.clear();
+        CHECK(atlas.BuildQuads("AxA", float3(0.f, 0.f, 0.f), 20, 0.f, vertices) == 2);
+    }
+    void TestDecodeUTF8()
+    {
+        // 2, 3 and 4 byte sequences, the position moves past the whole sequence
+        const std::string text = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+        size_t position        = 0;
+        CHECK(DecodeUTF8(text, position) == 'a' && position == 1);
+        CHECK(DecodeUTF8(text, position) == 0xE9 && position == 3);
+        CHECK(DecodeUTF8(text, position) == 0x20AC && position == 6);
+        CHECK(DecodeUTF8(text, position) == 0x1F600 && position == 10);
+
+        // Malformed input is replaced and only its first byte is skipped, so decoding picks up again after it
+        const auto decodeFirst = [](const std::string& bytes, size_t& next)
+        {
+            next = 0;
+            return DecodeUTF8(bytes, next);
+        };
+        size_t next = 0;
+        CHECK(decodeFirst("\xC0\xAF", next) == GLYPH_REPLACEMENT && next == 1);         // Overlong '/'
+        CHECK(decodeFirst("\xE0\x80\xAF", next) == GLYPH_REPLACEMENT && next == 1);     // Overlong '/' in 3 bytes
+        CHECK(decodeFirst("\xED\xA0\x80", next) == GLYPH_REPLACEMENT && next == 1);     // Surrogate U+D800
+        CHECK(decodeFirst("\xF4\x90\x80\x80", next) == GLYPH_REPLACEMENT && next == 1); // Past U+10FFFF
+        CHECK(decodeFirst("\xE2\x82", next) == GLYPH_REPLACEMENT && next == 1);         // Truncated at the end
+        CHECK(decodeFirst("\xE2\x82" "a", next) == GLYPH_REPLACEMENT && next == 1);    // Truncated by an ASCII byte
+        CHECK(decodeFirst("\x80", next) == GLYPH_REPLACEMENT && next == 1);             // Lone continuation byte
+
+        const std::string truncated = "\xE2\x82z";
+        position                    = 0;
+        CHECK(DecodeUTF8(truncated, position) == GLYPH_REPLACEMENT);
+        CHECK(DecodeUTF8(truncated, position) == GLYPH_REPLACEMENT);
+        CHECK(DecodeUTF8(truncated, position) == 'z' && position == 3);
+    }
+
+    // Letters of 8 pixels that advance 10, spaces of 5
+    GlyphAtlas MakeTextAtlas()
+    {
+        std::vector<GlyphBitmap> glyphs;
+        for (uint32_t letter = 'a'; letter <= 'z'; ++letter)
+            glyphs.push_back(MakeGlyph(letter, 8, 8, 1));
+        GlyphBitmap space = MakeGlyph(' ', 0, 0, 0);
+        space.advance     = 5 * 64;
+        glyphs.push_back(space);
+
+        GlyphAtlas atlas;
+        CHECK(atlas.Pack(glyphs));
+        return atlas;
+    }
+
+    float QuadLeft(const std::vector<float>& vertices, unsigned int quad)
+    {
+        return vertices[quad * GLYPH_QUAD_FLOATS];
+    }
+
+    float QuadTop(const std::vector<float>& vertices, unsigned int quad)
+    {
+        return vertices[quad * GLYPH_QUAD_FLOATS + 1];
+    }
+
+    void TestWordWrap()
+    {
+        const GlyphAtlas atlas = MakeTextAtlas();
+        std::vector<float> vertices;
+
+        // "ab " takes 25 pixels, "cd" would end at 45 past the 30 pixel box, so it starts the next line
+        CHECK(atlas.BuildQuads("ab cd", float3(0.f, 100.f, 0.f), 20, 30.f, vertices) == 4);
+        if (vertices.size() != 4 * GLYPH_QUAD_FLOATS) return;
+        CHECK_NEAR(QuadLeft(vertices, 0), 1.f, 1e-4f);
+        CHECK_NEAR(QuadLeft(vertices, 1), 11.f, 1e-4f);
+        CHECK_NEAR(QuadLeft(vertices, 2), 1.f, 1e-4f);
+        CHECK_NEAR(QuadLeft(vertices, 3), 11.f, 1e-4f);
+        CHECK_NEAR(QuadTop(vertices, 0), 88.f, 1e-4f);
+        CHECK_NEAR(QuadTop(vertices, 2), 68.f, 1e-4f);
+
+        // The same text fits in a wider box
+        vertices.clear();
+        CHECK(atlas.BuildQuads("ab cd", float3(0.f, 100.f, 0.f), 20, 50.f, vertices) == 4);
+        if (vertices.size() != 4 * GLYPH_QUAD_FLOATS) return;
+        CHECK_NEAR(QuadLeft(vertices, 2), 26.f, 1e-4f);
+        CHECK_NEAR(QuadTop(vertices, 2), 88.f, 1e-4f);
+    }
+
+    void TestLongWord()
+    {
+        const GlyphAtlas atlas = MakeTextAtlas();
+        std::vector<float> vertices;
+
+        // A word wider than the box is broken between characters, three of them fit in each line
+        CHECK(atlas.BuildQuads("abcdefg", float3(0.f, 100.f, 0.f), 20, 30.f, vertices) == 7);
+        if (vertices.size() != 7 * GLYPH_QUAD_FLOATS) return;
+        for (unsigned int quad = 0; quad < 7; ++quad)
+        {
+            CHECK_NEAR(QuadLeft(vertices, quad), 1.f + 10.f * (quad % 3), 1e-4f);
+            CHECK_NEAR(QuadTop(vertices, quad), 88.f - 20.f * (quad / 3), 1e-4f);
+        }
+    }
+
+    void TestKerning()
+    {
+        GlyphAtlas atlas = MakeTextAtlas();
+        atlas.SetKerning('a', 'v', -2 * 64 - 16);
+        CHECK(atlas.GetKerning('a', 'v') == -2 * 64 - 16);
+        CHECK(atlas.GetKerning('v', 'a') == 0);
+
+        // The offset moves the right character and everything after it, rounded to whole pixels
+        std::vector<float> vertices;
+        CHECK(atlas.BuildQuads("avav", float3(0.f, 100.f, 0.f), 20, 0.f, vertices) == 4);
+        if (vertices.size() != 4 * GLYPH_QUAD_FLOATS) return;
+        CHECK_NEAR(QuadLeft(vertices, 0), 1.f, 1e-4f);
+        CHECK_NEAR(QuadLeft(vertices, 1), 9.f, 1e-4f);
+        CHECK_NEAR(QuadLeft(vertices, 2), 19.f, 1e-4f);
+        CHECK_NEAR(QuadLeft(vertices, 3), 27.f, 1e-4f);
+
+        // Only the pair is kerned, a space between them breaks it
+        vertices.clear();
+        CHECK(atlas.BuildQuads("a v", float3(0.f, 100.f, 0.f), 20, 0.f, vertices) == 2);
+        if (vertices.size() != 2 * GLYPH_QUAD_FLOATS) return;
+        CHECK_NEAR(QuadLeft(vertices, 1), 16.f, 1e-4f);
+    }
+} // namespace
+
+int main()
+{
+    TestSmallestSize();
+    TestPadding();
+    TestTooBig();
+    TestQuads();
+    TestDecodeUTF8();
+    TestWordWrap();
+    TestLongWord();
+    TestKerning();
+    return TEST_RESULT();
+}
@@ -0,0 +1,164 @@
+#include "LightClusterGrid.h"
+#include "TestCheck.h"
+
+#include "Geometry/Frustum.h"
+#include "Geometry/Sphere.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr float NEAR_PLANE = 0.1f;
+    constexpr float FAR_PLANE  = 1000.f;
+
+    // Camera at the origin looking down -Z, so world and view space are the same
+    Frustum MakeCamera()
+    {
+        Frustum frustum;
+        frustum.type              = PerspectiveFrustum;
+        frustum.pos               = float3::zero;
+        frustum.front             = -float3::unitZ;
+        frustum.up                = float3::unitY;
+        frustum.nearPlaneDistance = NEAR_PLANE;
+        frustum.farPlaneDistance  = FAR_PLANE;
+        frustum.horizontalFov     = 1.4f;
+        frustum.verticalFov       = 2.f * std::atan(std::tan(0.7f) * 9.f / 16.f);
+        return frustum;
+    }
+
+    float SliceStart(unsigned int slice)
+    {
+        return NEAR_PLANE * std::pow(FAR_PLANE / NEAR_PLANE, float(slice) / LIGHT_CLUSTER_SLICES);
+    }
+
+    bool ClusterHasLight(const LightClusterGrid& grid, unsigned int cluster, unsigned int light, bool spot)
+    {
+        const LightCluster& lights = grid.GetClusters()[cluster];
+        const unsigned int first   = lights.firstLight + (spot ? lights.pointCount : 0);
+        const unsigned int count   = spot ? lights.spotCount : lights.pointCount;
+
+        const std::vector<unsigned int>& indices = grid.GetLightIndices();
+        const auto begin                         = indices.begin() + first;
+        return std::find(begin, begin + count, light) != begin + count;
+    }
+
+    void TestSlices()
+    {
+        const Frustum camera = MakeCamera();
+        LightClusterGrid grid;
+        grid.Build(camera.ViewMatrix(), camera.ProjectionMatrix(), {}, {});
+
+        CHECK_NEAR(grid.GetNearPlane(), NEAR_PLANE, 1e-3f);
+        CHECK_NEAR(grid.GetFarPlane(), FAR_PLANE, 1.f);
+
+        // Every slice spans the same ratio of depths, a point just past its start falls in it
+        for (unsigned int slice = 0; slice < LIGHT_CLUSTER_SLICES; ++slice)
+        {
+            const float start = SliceStart(slice);
+            const float end   = SliceStart(slice + 1);
+            CHECK(grid.GetSlice(start * 1.001f) == slice);
+            CHECK(grid.GetSlice(std::sqrt(start * end)) == slice);
+            CHECK(grid.GetSlice(end * 0.999f) == slice);
+        }
+
+        CHECK(grid.GetSlice(NEAR_PLANE * 0.5f) == 0);
+        CHECK(grid.GetSlice(FAR_PLANE * 2.f) == LIGHT_CLUSTER_SLICES - 1);
+    }
+
+    void TestTileBounds()
+    {
+        const Frustum camera = MakeCamera();
+        LightClusterGrid grid;
+        grid.Build(camera.ViewMatrix(), camera.ProjectionMatrix(), {}, {});
+
+        const float4x4 projection = camera.ProjectionMatrix();
+        for (unsigned int slice = 0; slice < LIGHT_CLUSTER_SLICES; slice += 5)
+        {
+            const float start = SliceStart(slice);
+            const float end   = SliceStart(slice + 1);
+            const float depth = std::sqrt(start * end);
+
+            for (unsigned int tileY = 0; tileY < LIGHT_CLUSTER_TILES_Y; ++tileY)
+            {
+                for (unsigned int tileX = 0; tileX < LIGHT_CLUSTER_TILES_X; ++tileX)
+                {
+                    const unsigned int cluster = LightClusterGrid::GetClusterIndex(tileX, tileY, slice);
+                    const AABB& bounds         = grid.GetClusterBounds(cluster);
+
+                    // The bounds span the whole slice in depth
+                    CHECK_NEAR(-bounds.maxPoint.z, start, start * 1e-3f);
+                    CHECK_NEAR(-bounds.minPoint.z, end, end * 1e-3f);
+
+                    // The center of the tile on screen is inside its bounds and looked up back into the same cluster
+                    const float ndcX = -1.f + 2.f * (tileX + 0.5f) / LIGHT_CLUSTER_TILES_X;
+                    const float ndcY = -1.f + 2.f * (tileY + 0.5f) / LIGHT_CLUSTER_TILES_Y;
+                    const float3 center(ndcX * depth / projection[0][0], ndcY * depth / projection[1][1], -depth);
+                    CHECK(bounds.Contains(center));
+                    CHECK(grid.FindCluster(center) == static_cast<int>(cluster));
+                }
+            }
+        }
+
+        // Tiles split the screen evenly, the left half of the screen is the left half of the tiles
+        CHECK(grid.FindCluster(float3(-0.01f, 0.f, -10.f)) % LIGHT_CLUSTER_TILES_X == LIGHT_CLUSTER_TILES_X / 2 - 1);
+        CHECK(grid.FindCluster(float3(0.01f, 0.f, -10.f)) % LIGHT_CLUSTER_TILES_X == LIGHT_CLUSTER_TILES_X / 2);
+        CHECK(grid.FindCluster(float3(0.f, 0.f, 10.f)) == -1);
+        CHECK(grid.FindCluster(float3(1000.f, 0.f, -10.f)) == -1);
+    }
+
+    void TestStraddlingLights()
+    {
+        const Frustum camera = MakeCamera();
+
+        // Both lights sit on the boundary between two slices, in front of the camera
+        const unsigned int slice = 12;
+        const float boundary     = SliceStart(slice + 1);
+        const float radius       = boundary * 0.01f;
+        const float3 center(0.01f, 0.01f, -boundary);
+
+        LightClusterGrid grid;
+        grid.Build(camera.ViewMatrix(), camera.ProjectionMatrix(), {{center, radius, 3}}, {{center, radius, 7}});
+
+        const int nearCluster = grid.FindCluster(center + float3(0.f, 0.f, radius * 0.5f));
+        const int farCluster  = grid.FindCluster(center - float3(0.f, 0.f, radius * 0.5f));
+        CHECK(nearCluster >= 0 && farCluster >= 0);
+        if (nearCluster < 0 || farCluster < 0) return;
+
+        CHECK(static_cast<unsigned int>(farCluster - nearCluster) == LIGHT_CLUSTER_TILES_X * LIGHT_CLUSTER_TILES_Y);
+
+        // The clusters on both sides of the boundary list the lights, points before spots
+        for (const int cluster : {nearCluster, farCluster})
+        {
+            CHECK(ClusterHasLight(grid, cluster, 3, false));
+            CHECK(ClusterHasLight(grid, cluster, 7, true));
+            CHECK(grid.GetClusters()[cluster].pointCount == 1);
+            CHECK(grid.GetClusters()[cluster].spotCount == 1);
+        }
+
+        // The sphere is far smaller than a slice, it reaches no other one
+        for (unsigned int c = 0; c < LIGHT_CLUSTER_COUNT; ++c)
+        {
+            const unsigned int clusterSlice = c / (LIGHT_CLUSTER_TILES_X * LIGHT_CLUSTER_TILES_Y);
+            if (clusterSlice == slice || clusterSlice == slice + 1) continue;
+            CHECK(grid.GetClusters()[c].pointCount == 0 && grid.GetClusters()[c].spotCount == 0);
+        }
+
+        // Every listed cluster actually touches the sphere
+        size_t listed = 0;
+        for (unsigned int c = 0; c < LIGHT_CLUSTER_COUNT; ++c)
+        {
+            if (grid.GetClusters()[c].pointCount == 0) continue;
+            CHECK(grid.GetClusterBounds(c).Intersects(Sphere(center, radius)));
+            ++listed;
+        }
+        CHECK(grid.GetLightIndices().size() == listed * 2);
+    }
+} // namespace
+
+int main()
+{
+    TestSlices();
+    TestTileBounds();
+    TestStraddlingLights();
+    return TEST_RESULT();
+}
@@ -0,0 +1,106 @@
+#include "RenderBackend.h"
+#include "RenderState.h"
+#include "TestCheck.h"
+
+namespace
+{
+    // GL values, the recording backend does not need the GL headers
+    constexpr unsigned int TRIANGLES             = 0x0004;
+    constexpr unsigned int UNSIGNED_INT          = 0x1405;
+    constexpr unsigned int SHADER_STORAGE_BUFFER = 0x90D2;
+    constexpr unsigned int UNIFORM_BUFFER        = 0x8A11;
+
+    constexpr unsigned int PROGRAM = 3;
+    constexpr unsigned int VAO     = 5;
+
+    // Two batches drawn with the same program and vertex array, as the geometry pass does
+    void RecordFrame(RenderState& renderState)
+    {
+        renderState.Invalidate();
+
+        for (unsigned int batch = 0; batch < 2; ++batch)
+        {
+            renderState.UseProgram(PROGRAM);
+            renderState.BindVertexArray(VAO);
+            renderState.BindTexture(0, 20);
+            renderState.BindTexture(1, 21 + batch);
+            renderState.BindBufferBase(UNIFORM_BUFFER, 0, 30);
+            renderState.BindBufferBase(SHADER_STORAGE_BUFFER, 10, 40 + batch);
+            renderState.BindBufferRange(SHADER_STORAGE_BUFFER, 12, 50, 0, 256);
+
+            renderState.SetUniform(renderState.GetUniformLocation(PROGRAM, "lightCount"), 4u);
+            renderState.SetUniform(renderState.GetUniformLocation(PROGRAM, "batch"), batch);
+            renderState.MultiDrawElementsIndirect(TRIANGLES, UNSIGNED_INT, nullptr, 8, 0);
+        }
+    }
+
+    void CheckCountersMatch(const RenderState& renderState, const RecordingRenderBackend& backend)
+    {
+        for (int call = 0; call < static_cast<int>(RenderCall::Count); ++call)
+            CHECK(renderState.GetStats().issued[call] == backend.CountCalls(static_cast<RenderCall>(call)));
+        CHECK(renderState.GetIssuedCalls() == backend.GetCalls().size());
+    }
+
+    void TestRedundantBindsSkipped()
+    {
+        RecordingRenderBackend backend;
+        RenderState renderState(&backend);
+        RecordFrame(renderState);
+
+        // Only the second batch texture and storage buffer change, the rest of its binds are skipped
+        CHECK(backend.CountCalls(RenderCall::UseProgram) == 1);
+        CHECK(backend.CountCalls(RenderCall::BindVertexArray) == 1);
+        CHECK(backend.CountCalls(RenderCall::BindTexture) == 3);
+        CHECK(backend.CountCalls(RenderCall::BindBufferBase) == 3);
+        CHECK(backend.CountCalls(RenderCall::BindBufferRange) == 1);
+        CHECK(backend.CountCalls(RenderCall::GetUniformLocation) == 2);
+        CHECK(backend.CountCalls(RenderCall::SetUniform) == 3);
+        CHECK(backend.CountCalls(RenderCall::MultiDrawElementsIndirect) == 2);
+        CHECK(renderState.GetStats().skipped == 8);
+        CheckCountersMatch(renderState, backend);
+
+        // The binds reach the backend with their arguments
+        const std::vector<RecordedCall>& calls = backend.GetCalls();
+        CHECK(calls[0].call == RenderCall::UseProgram && calls[0].arguments[0] == PROGRAM);
+        CHECK(calls[1].call == RenderCall::BindVertexArray && calls[1].arguments[0] == VAO);
+        CHECK(calls.back().call == RenderCall::MultiDrawElementsIndirect && calls.back().arguments[3] == 8);
+    }
+
+    void TestNextFrame()
+    {
+        RecordingRenderBackend backend;
+        RenderState renderState(&backend);
+        RecordFrame(renderState);
+
+        backend.Clear();
+        renderState.ResetStats();
+        RecordFrame(renderState);
+
+        // Bindings are forgotten at the start of the frame, uniform locations and values are kept with the program
+        CHECK(backend.CountCalls(RenderCall::UseProgram) == 1);
+        CHECK(backend.CountCalls(RenderCall::BindVertexArray) == 1);
+        CHECK(backend.CountCalls(RenderCall::BindTexture) == 3);
+        CHECK(backend.CountCalls(RenderCall::BindBufferBase) == 3);
+        CHECK(backend.CountCalls(RenderCall::BindBufferRange) == 1);
+        CHECK(backend.CountCalls(RenderCall::GetUniformLocation) == 0);
+        CHECK(backend.CountCalls(RenderCall::SetUniform) == 2);
+        CheckCountersMatch(renderState, backend);
+
+        // A new program with the id of a deleted one starts without cached uniforms
+        backend.Clear();
+        renderState.ResetStats();
+        renderState.ForgetProgram(PROGRAM);
+        RecordFrame(renderState);
+        CHECK(backend.CountCalls(RenderCall::UseProgram) == 1);
+        CHECK(backend.CountCalls(RenderCall::GetUniformLocation) == 2);
+        CHECK(backend.CountCalls(RenderCall::SetUniform) == 3);
+        CheckCountersMatch(renderState, backend);
+    }
+} // namespace
+
+int main()
+{
+    TestRedundantBindsSkipped();
+    TestNextFrame();
+    return TEST_RESULT();
+}
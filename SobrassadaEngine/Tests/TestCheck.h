@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal checks for the headless tests, a failed check is printed and the test keeps going. Main returns
+// TEST_RESULT() so ctest sees the failure
+inline int testFailures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(condition))                                                                                              \
+        {                                                                                                              \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);                                  \
+            ++testFailures;                                                                                            \
+        }                                                                                                              \
+    } while (0)
+
+#define CHECK_NEAR(a, b, epsilon) CHECK(std::abs((a) - (b)) <= (epsilon))
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
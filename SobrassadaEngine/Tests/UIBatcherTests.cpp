@@ -0,0 +1,159 @@
+#include "UIBatcher.h"
+#include "TestCheck.h"
+
+#include "Math/Quat.h"
+
+#include <vector>
+
+namespace
+{
+    constexpr uint64_t BACKGROUND = 1;
+    constexpr uint64_t SWORDS     = 2;
+    constexpr uint64_t POTIONS    = 3;
+    constexpr uint64_t FONT       = 4;
+
+    // Unit quad in the widget space, the model matrix places and sizes it as the widget transform does
+    void AddQuad(
+        UIBatcher& batcher, uint64_t texture, UIWidgetType type, float x, float y, float width, float height,
+        const float3& color = float3::one
+    )
+    {
+        const float vertices[6 * UI_WIDGET_VERTEX_FLOATS] = {0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                                                             1.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f, 0.f,
+                                                             0.f, 1.f, 0.f, 0.f, 1.f, 0.f, 1.f, 1.f};
+        const float4x4 model = float4x4::FromTRS(float3(x, y, 0.f), Quat::identity, float3(width, height, 1.f));
+        batcher.AddWidget(texture, type, model, color, vertices, 6);
+    }
+
+    bool SameBatch(const UIBatch& batch, uint64_t texture, UIWidgetType type, unsigned int first, unsigned int count)
+    {
+        return batch.texture == texture && batch.type == type && batch.firstVertex == first &&
+               batch.vertexCount == count;
+    }
+
+    // Canvas position of the first vertex of a widget, the top left corner of its quad
+    float3 FirstPosition(const UIBatcher& batcher, unsigned int vertex)
+    {
+        const float* packed = batcher.GetVertices().data() + vertex * UI_BATCH_VERTEX_FLOATS;
+        return float3(packed[0], packed[1], packed[2]);
+    }
+
+    // Inventory of 10 by 10 slots that touch each other. Every slot has a background, an icon from one of two sheets
+    // and a count label over the corner of the icon
+    void AddInventory(UIBatcher& batcher)
+    {
+        for (unsigned int slot = 0; slot < 100; ++slot)
+        {
+            const float x = 64.f * (slot % 10);
+            const float y = 64.f * (slot / 10);
+            AddQuad(batcher, BACKGROUND, UIWidgetType::Image, x, y, 64.f, 64.f);
+            AddQuad(batcher, slot % 2 == 0 ? SWORDS : POTIONS, UIWidgetType::Image, x + 8.f, y + 8.f, 48.f, 48.f);
+            AddQuad(batcher, FONT, UIWidgetType::Label, x + 44.f, y + 4.f, 12.f, 16.f);
+        }
+    }
+
+    void TestOverlapOrder()
+    {
+        // The potion sits over the background and the second background over the potion, so the second background
+        // can't move down to the batch of the first one
+        UIBatcher batcher;
+        AddQuad(batcher, BACKGROUND, UIWidgetType::Image, 0.f, 0.f, 10.f, 10.f);
+        AddQuad(batcher, POTIONS, UIWidgetType::Image, 5.f, 5.f, 10.f, 10.f);
+        AddQuad(batcher, BACKGROUND, UIWidgetType::Image, 12.f, 12.f, 10.f, 10.f);
+        batcher.Build();
+
+        const std::vector<UIBatch>& batches = batcher.GetBatches();
+        CHECK(batches.size() == 3);
+        if (batches.size() != 3) return;
+        CHECK(SameBatch(batches[0], BACKGROUND, UIWidgetType::Image, 0, 6));
+        CHECK(SameBatch(batches[1], POTIONS, UIWidgetType::Image, 6, 6));
+        CHECK(SameBatch(batches[2], BACKGROUND, UIWidgetType::Image, 12, 6));
+        CHECK(FirstPosition(batcher, 12).Equals(float3(12.f, 22.f, 0.f)));
+
+        // Same texture but another widget type can't share the batch either
+        batcher.Clear();
+        AddQuad(batcher, FONT, UIWidgetType::Image, 0.f, 0.f, 10.f, 10.f);
+        AddQuad(batcher, FONT, UIWidgetType::Label, 5.f, 5.f, 10.f, 10.f);
+        batcher.Build();
+        CHECK(batcher.GetBatches().size() == 2);
+        if (batcher.GetBatches().size() != 2) return;
+        CHECK(batcher.GetBatches()[0].type == UIWidgetType::Image);
+        CHECK(batcher.GetBatches()[1].type == UIWidgetType::Label);
+    }
+
+    void TestTouchingEdges()
+    {
+        // Each quad starts where the previous one ends, nothing overlaps so both backgrounds share one batch
+        UIBatcher batcher;
+        AddQuad(batcher, BACKGROUND, UIWidgetType::Image, 0.f, 0.f, 10.f, 10.f);
+        AddQuad(batcher, POTIONS, UIWidgetType::Image, 10.f, 0.f, 10.f, 10.f);
+        AddQuad(batcher, BACKGROUND, UIWidgetType::Image, 20.f, 0.f, 10.f, 10.f);
+        batcher.Build();
+
+        const std::vector<UIBatch>& batches = batcher.GetBatches();
+        CHECK(batches.size() == 2);
+        if (batches.size() != 2) return;
+        CHECK(SameBatch(batches[0], BACKGROUND, UIWidgetType::Image, 0, 12));
+        CHECK(SameBatch(batches[1], POTIONS, UIWidgetType::Image, 12, 6));
+
+        // The merged widgets keep the order they were added in
+        CHECK(FirstPosition(batcher, 0).Equals(float3(0.f, 10.f, 0.f)));
+        CHECK(FirstPosition(batcher, 6).Equals(float3(20.f, 10.f, 0.f)));
+    }
+
+    void TestInventory()
+    {
+        UIBatcher batcher;
+        AddInventory(batcher);
+        batcher.Build();
+        CHECK(batcher.GetWidgetCount() == 300);
+
+        // Backgrounds, then the icons of each sheet, then the labels over them
+        const std::vector<UIBatch>& batches = batcher.GetBatches();
+        CHECK(batches.size() == 4);
+        if (batches.size() != 4) return;
+        CHECK(SameBatch(batches[0], BACKGROUND, UIWidgetType::Image, 0, 600));
+        CHECK(SameBatch(batches[1], SWORDS, UIWidgetType::Image, 600, 300));
+        CHECK(SameBatch(batches[2], POTIONS, UIWidgetType::Image, 900, 300));
+        CHECK(SameBatch(batches[3], FONT, UIWidgetType::Label, 1200, 600));
+        CHECK(batcher.GetVertices().size() == 1800 * UI_BATCH_VERTEX_FLOATS);
+
+        // Slots in the order they were added within each batch
+        CHECK(FirstPosition(batcher, 6).Equals(float3(64.f, 64.f, 0.f)));
+        CHECK(FirstPosition(batcher, 606).Equals(float3(136.f, 56.f, 0.f)));
+        CHECK(FirstPosition(batcher, 906).Equals(float3(200.f, 56.f, 0.f)));
+    }
+
+    void TestDeterministic()
+    {
+        UIBatcher first;
+        AddInventory(first);
+        first.Build();
+
+        // A new batcher and a reused one give the same vertices and batches, bit for bit
+        UIBatcher second;
+        AddQuad(second, POTIONS, UIWidgetType::Image, 0.f, 0.f, 10.f, 10.f);
+        second.Build();
+        second.Clear();
+        AddInventory(second);
+        second.Build();
+        second.Build();
+
+        CHECK(first.GetVertices() == second.GetVertices());
+        CHECK(first.GetBatches().size() == second.GetBatches().size());
+        for (size_t i = 0; i < first.GetBatches().size() && i < second.GetBatches().size(); ++i)
+        {
+            const UIBatch& batch = second.GetBatches()[i];
+            CHECK(SameBatch(first.GetBatches()[i], batch.texture, batch.type, batch.firstVertex, batch.vertexCount));
+        }
+    }
+} // namespace
+
+int main()
+{
+    TestOverlapOrder();
+    TestTouchingEdges();
+    TestInventory();
+    TestDeterministic();
+    return TEST_RESULT();
+}
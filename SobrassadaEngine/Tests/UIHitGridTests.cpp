@@ -0,0 +1,133 @@
+#include "UIHitGrid.h"
+#include "TestCheck.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    // 10 pixel cells
+    const float2 CANVAS_SIZE = float2(160.f, 160.f);
+
+    // Rotated by angle and scaled along its own axes, toLocal is the inverse of that
+    UIHitRect MakeRect(
+        const float2& center, const float2& halfSize, unsigned int order, float angle = 0.f,
+        const float2& scale = float2::one
+    )
+    {
+        const float cosine = std::cos(angle);
+        const float sine   = std::sin(angle);
+
+        UIHitRect rect;
+        rect.center   = center;
+        rect.halfSize = halfSize;
+        rect.toLocalX = float2(cosine, sine) / scale.x;
+        rect.toLocalY = float2(-sine, cosine) / scale.y;
+        rect.order    = order;
+        return rect;
+    }
+
+    std::vector<unsigned int> Find(const UIHitGrid& grid, const float2& point)
+    {
+        std::vector<unsigned int> hits;
+        grid.FindAll(point, hits);
+        return hits;
+    }
+
+    void TestTopmost()
+    {
+        // The highest order is on top where they overlap, whatever order the rectangles are given in
+        UIHitGrid grid;
+        grid.Build(
+            CANVAS_SIZE,
+            {MakeRect(float2(50.f, 50.f), float2(20.f, 20.f), 7), MakeRect(float2(60.f, 60.f), float2(20.f, 20.f), 3),
+             MakeRect(float2(55.f, 55.f), float2(5.f, 5.f), 5)}
+        );
+
+        CHECK(Find(grid, float2(56.f, 56.f)) == std::vector<unsigned int>({0, 2, 1}));
+        CHECK(Find(grid, float2(75.f, 75.f)) == std::vector<unsigned int>({1}));
+        CHECK(Find(grid, float2(35.f, 35.f)) == std::vector<unsigned int>({0}));
+        CHECK(Find(grid, float2(100.f, 100.f)).empty());
+
+        // Equal orders keep the order the rectangles were given in
+        grid.Build(
+            CANVAS_SIZE,
+            {MakeRect(float2(50.f, 50.f), float2(20.f, 20.f), 1), MakeRect(float2(50.f, 50.f), float2(20.f, 20.f), 1)}
+        );
+        CHECK(Find(grid, float2(50.f, 50.f)) == std::vector<unsigned int>({0, 1}));
+    }
+
+    void TestTransformed()
+    {
+        // A thin bar turned 45 degrees, its tips reach cells the unrotated bar wouldn't
+        const float angle = 0.785398163f;
+        UIHitGrid grid;
+        grid.Build(CANVAS_SIZE, {MakeRect(float2(80.f, 80.f), float2(40.f, 2.f), 0, angle)});
+
+        CHECK(Find(grid, float2(80.f, 80.f)).size() == 1);
+        CHECK(Find(grid, float2(105.f, 105.f)).size() == 1);
+        CHECK(Find(grid, float2(55.f, 55.f)).size() == 1);
+        CHECK(Find(grid, float2(105.f, 55.f)).empty());
+        CHECK(Find(grid, float2(115.f, 80.f)).empty());
+
+        // Scaled twice as wide, the widget space half size of 10 covers 20 pixels of the canvas
+        grid.Build(CANVAS_SIZE, {MakeRect(float2(100.f, 100.f), float2(10.f, 10.f), 0, 0.f, float2(2.f, 1.f))});
+        CHECK(Find(grid, float2(118.f, 100.f)).size() == 1);
+        CHECK(Find(grid, float2(82.f, 109.f)).size() == 1);
+        CHECK(Find(grid, float2(122.f, 100.f)).empty());
+        CHECK(Find(grid, float2(100.f, 111.f)).empty());
+
+        // Both at once, the scaled axis turned a quarter
+        grid.Build(
+            CANVAS_SIZE, {MakeRect(float2(100.f, 100.f), float2(10.f, 10.f), 0, 1.570796327f, float2(2.f, 1.f))}
+        );
+        CHECK(Find(grid, float2(100.f, 118.f)).size() == 1);
+        CHECK(Find(grid, float2(118.f, 100.f)).empty());
+    }
+
+    void TestOutsideCanvas()
+    {
+        // Rectangles past the left and the top right border, the border cells list them
+        UIHitGrid grid;
+        grid.Build(
+            CANVAS_SIZE,
+            {MakeRect(float2(-30.f, 50.f), float2(20.f, 20.f), 0),
+             MakeRect(float2(190.f, 200.f), float2(40.f, 50.f), 1)}
+        );
+
+        CHECK(Find(grid, float2(-25.f, 50.f)) == std::vector<unsigned int>({0}));
+        CHECK(Find(grid, float2(-45.f, 60.f)) == std::vector<unsigned int>({0}));
+        CHECK(Find(grid, float2(-55.f, 50.f)).empty());
+        CHECK(Find(grid, float2(5.f, 50.f)).empty());
+
+        CHECK(Find(grid, float2(200.f, 220.f)) == std::vector<unsigned int>({1}));
+        CHECK(Find(grid, float2(155.f, 155.f)) == std::vector<unsigned int>({1}));
+        CHECK(Find(grid, float2(400.f, 400.f)).empty());
+
+        // Points that aren't numbers land in the first cell and hit nothing
+        CHECK(Find(grid, float2(std::numeric_limits<float>::quiet_NaN(), 50.f)).empty());
+    }
+
+    void TestCollapsed()
+    {
+        // Scaled to nothing along x, the inverse failed and toLocal has no area
+        UIHitRect collapsed = MakeRect(float2(80.f, 80.f), float2(20.f, 20.f), 1);
+        collapsed.toLocalX  = float2::zero;
+
+        UIHitGrid grid;
+        grid.Build(CANVAS_SIZE, {collapsed, MakeRect(float2(80.f, 80.f), float2(5.f, 5.f), 0)});
+        CHECK(!UIHitGrid::Contains(collapsed, float2(80.f, 80.f)));
+        CHECK(Find(grid, float2(80.f, 80.f)) == std::vector<unsigned int>({1}));
+        CHECK(Find(grid, float2(81.f, 95.f)).empty());
+    }
+} // namespace
+
+int main()
+{
+    TestTopmost();
+    TestTransformed();
+    TestOutsideCanvas();
+    TestCollapsed();
+    return TEST_RESULT();
+}
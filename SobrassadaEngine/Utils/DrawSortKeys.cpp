@@ -0,0 +1,77 @@
+#include "DrawSortKeys.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr unsigned int RADIX_BITS     = 8;
+    constexpr unsigned int RADIX_BUCKETS  = 1 << RADIX_BITS;
+    constexpr unsigned int RADIX_PASSES   = 64 / RADIX_BITS;
+
+    constexpr unsigned int MATERIAL_SHIFT = 0;
+    constexpr unsigned int DEPTH_SHIFT    = MATERIAL_SHIFT + SORT_KEY_MATERIAL_BITS;
+    constexpr unsigned int BATCH_SHIFT    = DEPTH_SHIFT + SORT_KEY_DEPTH_BITS;
+    constexpr unsigned int LAYER_SHIFT    = BATCH_SHIFT + SORT_KEY_BATCH_BITS;
+
+    constexpr uint64_t GetMask(unsigned int bits)
+    {
+        return (uint64_t(1) << bits) - 1;
+    }
+} // namespace
+
+uint64_t MakeDrawSortKey(DrawLayer layer, unsigned int batch, float depth, uint32_t material)
+{
+    // Bits of positive floats grow with their value, the highest ones are the exponent and the start of the mantissa
+    uint32_t depthBits = 0;
+    if (depth > 0.f) std::memcpy(&depthBits, &depth, sizeof(depth));
+
+    uint64_t depthBucket = depthBits >> (32 - 1 - SORT_KEY_DEPTH_BITS);
+    if (layer == DrawLayer::Transparent) depthBucket = GetMask(SORT_KEY_DEPTH_BITS) - depthBucket;
+
+    const uint64_t batchField = std::min<uint64_t>(batch, GetMask(SORT_KEY_BATCH_BITS));
+    return (static_cast<uint64_t>(layer) & GetMask(SORT_KEY_LAYER_BITS)) << LAYER_SHIFT | batchField << BATCH_SHIFT |
+           depthBucket << DEPTH_SHIFT | static_cast<uint64_t>(material) << MATERIAL_SHIFT;
+}
+
+unsigned int GetDrawSortBatch(uint64_t key)
+{
+    return static_cast<unsigned int>((key >> BATCH_SHIFT) & GetMask(SORT_KEY_BATCH_BITS));
+}
+
+void DrawSorter::Sort(std::vector<DrawSortEntry>& entries)
+{
+    const std::size_t count = entries.size();
+    if (count < 2) return;
+
+    // Histograms of every digit in a single read of the keys
+    unsigned int histograms[RADIX_PASSES][RADIX_BUCKETS] = {};
+    for (const DrawSortEntry& entry : entries)
+    {
+        for (unsigned int pass = 0; pass < RADIX_PASSES; ++pass)
+            ++histograms[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+    }
+
+    scratch.resize(count);
+    for (unsigned int pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+        unsigned int* histogram  = histograms[pass];
+        const unsigned int shift = pass * RADIX_BITS;
+
+        // Every key has this digit, the pass would not move anything
+        if (histogram[(entries[0].key >> shift) & (RADIX_BUCKETS - 1)] == count) continue;
+
+        unsigned int offset = 0;
+        for (unsigned int bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            const unsigned int bucketCount = histogram[bucket];
+            histogram[bucket]              = offset;
+            offset                        += bucketCount;
+        }
+
+        for (const DrawSortEntry& entry : entries)
+            scratch[histogram[(entry.key >> shift) & (RADIX_BUCKETS - 1)]++] = entry;
+
+        entries.swap(scratch);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Fields of a draw sort key, from the most significant bits. Draws are ordered by layer, then by batch so each batch
+// keeps its draws together, then by depth and last by material
+constexpr unsigned int SORT_KEY_LAYER_BITS    = 2;
+constexpr unsigned int SORT_KEY_BATCH_BITS    = 14;
+constexpr unsigned int SORT_KEY_DEPTH_BITS    = 16;
+constexpr unsigned int SORT_KEY_MATERIAL_BITS = 32;
+
+enum class DrawLayer : unsigned int
+{
+    Opaque      = 0, // Front to back, the closest draws fill the depth buffer first
+    Transparent = 1  // Back to front, after every opaque draw. No pass submits transparent draws yet
+};
+
+struct DrawSortEntry
+{
+    uint64_t key;
+    unsigned int draw; // Index of the draw the key belongs to
+};
+
+// Packs the fields of a draw. The depth is any value that grows with the distance to the camera, its float bits are
+// bucketed so closer draws get smaller buckets at any scale
+uint64_t MakeDrawSortKey(DrawLayer layer, unsigned int batch, float depth, uint32_t material);
+unsigned int GetDrawSortBatch(uint64_t key);
+
+// Least significant digit radix sort of 64 bit keys, 8 bits per pass. Passes where every key has the same digit are
+// skipped, so keys that only use their high fields sort in a few passes. Stable, equal keys keep the order they were
+// added in. No GL calls
+class DrawSorter
+{
+  public:
+    void Sort(std::vector<DrawSortEntry>& entries);
+
+  private:
+    std::vector<DrawSortEntry> scratch; // Keeps its capacity between frames
+};
@@ -2,6 +2,7 @@
 
 #include "Geometry/AABB.h"
 #include "Geometry/OBB.h"
+#include "Geometry/Sphere.h"
 #include "Math/float3.h"
 #include "Math/float4x4.h"
 
@@ -91,6 +92,18 @@ bool FrustumPlanes::Intersects(const OBB& boundingBox) const
     return CheckInsideFrustum(corners);
 }
 
+bool FrustumPlanes::Intersects(const Sphere& boundingSphere) const
+{
+    for (const float4& plane : frustumPlanes)
+    {
+        // The planes are normalized as 4D vectors, the distance is scaled by the length of the normal
+        const float3 normal  = plane.xyz();
+        const float distance = normal.Dot(boundingSphere.pos) + plane.w;
+        if (distance < -boundingSphere.r * normal.Length()) return false;
+    }
+    return true;
+}
+
 bool FrustumPlanes::CheckInsideFrustum(const float3 (&corners)[8]) const
 {
     bool allOutside = true;
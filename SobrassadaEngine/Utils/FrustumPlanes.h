@@ -12,6 +12,7 @@ namespace math
     class float3;
     class AABB;
     class OBB;
+    class Sphere;
 } // namespace math
 
 class FrustumPlanes
@@ -24,6 +25,7 @@ class FrustumPlanes
 
     bool Intersects(const AABB& boundingBox) const;
     bool Intersects(const OBB& boundingBox) const;
+    bool Intersects(const Sphere& boundingSphere) const;
 
   private:
     bool CheckInsideFrustum(const float3 (&corners)[8]) const;
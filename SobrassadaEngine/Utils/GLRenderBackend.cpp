@@ -0,0 +1,88 @@
+#include "GLRenderBackend.h"
+
+#include "glew.h"
+
+void GLRenderBackend::UseProgram(unsigned int program)
+{
+    glUseProgram(program);
+}
+
+void GLRenderBackend::BindVertexArray(unsigned int vao)
+{
+    glBindVertexArray(vao);
+}
+
+void GLRenderBackend::BindTexture(unsigned int unit, unsigned int texture)
+{
+    // Leaves the active texture unit alone, the texture creation code binds on it
+    glBindTextureUnit(unit, texture);
+}
+
+void GLRenderBackend::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+    glBindBufferBase(target, index, buffer);
+}
+
+void GLRenderBackend::BindBufferRange(
+    unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+)
+{
+    glBindBufferRange(target, index, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+}
+
+int GLRenderBackend::GetUniformLocation(unsigned int program, const char* name)
+{
+    return glGetUniformLocation(program, name);
+}
+
+void GLRenderBackend::SetUniform(int location, UniformType type, const void* value)
+{
+    const GLint* ints     = static_cast<const GLint*>(value);
+    const GLuint* uints   = static_cast<const GLuint*>(value);
+    const GLfloat* floats = static_cast<const GLfloat*>(value);
+
+    switch (type)
+    {
+    case UniformType::Int:
+        glUniform1i(location, ints[0]);
+        break;
+    case UniformType::UInt:
+        glUniform1ui(location, uints[0]);
+        break;
+    case UniformType::Float:
+        glUniform1f(location, floats[0]);
+        break;
+    case UniformType::Float2:
+        glUniform2f(location, floats[0], floats[1]);
+        break;
+    case UniformType::UInt2:
+        glUniform2ui(location, uints[0], uints[1]);
+        break;
+    case UniformType::Float3:
+        glUniform3fv(location, 1, floats);
+        break;
+    case UniformType::Matrix4:
+        glUniformMatrix4fv(location, 1, GL_TRUE, floats);
+        break;
+    case UniformType::Handle:
+        glUniformHandleui64ARB(location, *static_cast<const GLuint64*>(value));
+        break;
+    }
+}
+
+void GLRenderBackend::DrawArrays(unsigned int mode, int first, int count)
+{
+    glDrawArrays(mode, first, count);
+}
+
+void GLRenderBackend::DrawElements(unsigned int mode, int count, unsigned int type, const void* indices)
+{
+    glDrawElements(mode, count, type, indices);
+}
+
+void GLRenderBackend::MultiDrawElementsIndirect(
+    unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+)
+{
+    glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+}
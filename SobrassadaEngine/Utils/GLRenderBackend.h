@@ -0,0 +1,23 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+// Sends the calls to the current OpenGL context
+class GLRenderBackend : public RenderBackend
+{
+  public:
+    void UseProgram(unsigned int program) override;
+    void BindVertexArray(unsigned int vao) override;
+    void BindTexture(unsigned int unit, unsigned int texture) override;
+    void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) override;
+    void BindBufferRange(
+        unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+    ) override;
+    int GetUniformLocation(unsigned int program, const char* name) override;
+    void SetUniform(int location, UniformType type, const void* value) override;
+    void DrawArrays(unsigned int mode, int first, int count) override;
+    void DrawElements(unsigned int mode, int count, unsigned int type, const void* indices) override;
+    void MultiDrawElementsIndirect(
+        unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+    ) override;
+};
@@ -0,0 +1,279 @@
+#include "GlyphAtlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+uint32_t DecodeUTF8(const std::string& text, size_t& position)
+{
+    const unsigned char lead = static_cast<unsigned char>(text[position]);
+    if (lead < 0x80)
+    {
+        ++position;
+        return lead;
+    }
+
+    unsigned int length;
+    uint32_t codepoint;
+    uint32_t smallest; // Anything below could be encoded shorter
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length    = 2;
+        codepoint = lead & 0x1F;
+        smallest  = 0x80;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length    = 3;
+        codepoint = lead & 0x0F;
+        smallest  = 0x800;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length    = 4;
+        codepoint = lead & 0x07;
+        smallest  = 0x10000;
+    }
+    else
+    {
+        ++position;
+        return GLYPH_REPLACEMENT;
+    }
+
+    if (position + length > text.size())
+    {
+        ++position;
+        return GLYPH_REPLACEMENT;
+    }
+
+    for (unsigned int i = 1; i < length; ++i)
+    {
+        const unsigned char byte = static_cast<unsigned char>(text[position + i]);
+        if ((byte & 0xC0) != 0x80)
+        {
+            ++position;
+            return GLYPH_REPLACEMENT;
+        }
+        codepoint = (codepoint << 6) | (byte & 0x3F);
+    }
+
+    // Overlong encodings, surrogates and values past the last code point are malformed
+    if (codepoint < smallest || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    {
+        ++position;
+        return GLYPH_REPLACEMENT;
+    }
+
+    position += length;
+    return codepoint;
+}
+
+bool GlyphAtlas::Pack(const std::vector<GlyphBitmap>& bitmaps)
+{
+    std::vector<unsigned int> order(bitmaps.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(),
+        [&bitmaps](unsigned int first, unsigned int second) { return bitmaps[first].height > bitmaps[second].height; }
+    );
+
+    std::vector<unsigned int> glyphX;
+    std::vector<unsigned int> glyphY;
+    unsigned int atlasSize = GLYPH_ATLAS_MIN_SIZE;
+    while (!PlaceGlyphs(bitmaps, order, atlasSize, glyphX, glyphY))
+    {
+        if (atlasSize == GLYPH_ATLAS_MAX_SIZE) return false;
+        atlasSize *= 2;
+    }
+
+    size = atlasSize;
+    pixels.assign(static_cast<size_t>(size) * size, 0);
+    glyphs.assign(bitmaps.size(), AtlasGlyph());
+    glyphIndices.clear();
+
+    for (size_t i = 0; i < bitmaps.size(); ++i)
+    {
+        const GlyphBitmap& bitmap = bitmaps[i];
+        for (unsigned int row = 0; row < bitmap.height; ++row)
+        {
+            std::copy_n(
+                bitmap.pixels.begin() + static_cast<size_t>(row) * bitmap.width, bitmap.width,
+                pixels.begin() + static_cast<size_t>(glyphY[i] + row) * size + glyphX[i]
+            );
+        }
+
+        AtlasGlyph& glyph = glyphs[i];
+        glyph.size        = float2(static_cast<float>(bitmap.width), static_cast<float>(bitmap.height));
+        glyph.bearing     = float2(static_cast<float>(bitmap.left), static_cast<float>(bitmap.top));
+        glyph.uvMin       = float2(static_cast<float>(glyphX[i]), static_cast<float>(glyphY[i])) / float(size);
+        glyph.uvMax       = glyph.uvMin + glyph.size / float(size);
+        glyph.advance     = bitmap.advance;
+
+        glyphIndices[bitmap.codepoint] = static_cast<unsigned int>(i);
+    }
+
+    return true;
+}
+
+void GlyphAtlas::SetKerning(uint32_t left, uint32_t right, int offset)
+{
+    kerning[(static_cast<uint64_t>(left) << 32) | right] = offset;
+}
+
+unsigned int GlyphAtlas::BuildQuads(
+    const std::string& text, const float3& startPos, unsigned int lineHeight, float maxWidth,
+    std::vector<float>& outVertices
+) const
+{
+    struct LaidCharacter
+    {
+        uint32_t codepoint;
+        const AtlasGlyph* glyph;
+    };
+
+    // Characters out of the atlas are drawn with the fallback one, control characters are dropped
+    std::vector<LaidCharacter> characters;
+    characters.reserve(text.size());
+    for (size_t position = 0; position < text.size();)
+    {
+        uint32_t codepoint = DecodeUTF8(text, position);
+        if (codepoint < ' ' && codepoint != '\n') continue;
+
+        const AtlasGlyph* glyph = FindGlyph(codepoint);
+        if (glyph == nullptr && codepoint != ' ' && codepoint != '\n')
+        {
+            codepoint = GLYPH_FALLBACK;
+            glyph     = FindGlyph(codepoint);
+            if (glyph == nullptr) continue;
+        }
+        characters.push_back({codepoint, glyph});
+    }
+
+    // The pen goes in 1/64 pixels from the left of the box, glyphs are placed on whole pixels so they aren't blurred
+    const int lineLeft  = static_cast<int>(startPos.x);
+    const int wrapWidth = maxWidth > 0.f ? static_cast<int>(maxWidth * 64.f) : INT_MAX;
+    int penX            = 0;
+    int baseline        = static_cast<int>(startPos.y) - static_cast<int>(lineHeight);
+    uint32_t previous   = 0;
+    unsigned int quads  = 0;
+
+    const auto newLine  = [&]()
+    {
+        penX      = 0;
+        baseline -= static_cast<int>(lineHeight);
+        previous  = 0;
+    };
+    const auto advance = [this](uint32_t left, const LaidCharacter& character)
+    { return GetKerning(left, character.codepoint) + static_cast<int>(character.glyph->advance); };
+
+    size_t i = 0;
+    while (i < characters.size())
+    {
+        const LaidCharacter& character = characters[i];
+        if (character.codepoint == '\n')
+        {
+            newLine();
+            ++i;
+            continue;
+        }
+        if (character.codepoint == ' ')
+        {
+            if (character.glyph != nullptr) penX += advance(previous, character);
+            previous = ' ';
+            ++i;
+            continue;
+        }
+
+        // A word runs until the next space or line break and goes to the next line as a whole when it doesn't fit
+        size_t wordEnd        = i;
+        int wordWidth         = 0;
+        uint32_t wordPrevious = previous;
+        while (wordEnd < characters.size() && characters[wordEnd].codepoint != ' ' &&
+               characters[wordEnd].codepoint != '\n')
+        {
+            wordWidth    += advance(wordPrevious, characters[wordEnd]);
+            wordPrevious  = characters[wordEnd].codepoint;
+            ++wordEnd;
+        }
+        if (penX > 0 && penX + wordWidth > wrapWidth) newLine();
+
+        for (; i < wordEnd; ++i)
+        {
+            const LaidCharacter& letter = characters[i];
+            if (penX > 0 && penX + advance(previous, letter) > wrapWidth) newLine();
+
+            penX                    += GetKerning(previous, letter.codepoint);
+            const AtlasGlyph& glyph  = *letter.glyph;
+            if (glyph.size.x > 0.f && glyph.size.y > 0.f)
+            {
+                const float left   = lineLeft + ((penX + 32) >> 6) + glyph.bearing.x;
+                const float bottom = baseline - (glyph.size.y - glyph.bearing.y);
+                const float right  = left + glyph.size.x;
+                const float top    = bottom + glyph.size.y;
+
+                // Positions - Uvs interleaved
+                const float vertices[GLYPH_QUAD_FLOATS] = {
+                    left,  top,    glyph.uvMin.x, glyph.uvMin.y, left,  bottom, glyph.uvMin.x, glyph.uvMax.y,
+                    right, bottom, glyph.uvMax.x, glyph.uvMax.y, right, top,    glyph.uvMax.x, glyph.uvMin.y,
+                    left,  top,    glyph.uvMin.x, glyph.uvMin.y, right, bottom, glyph.uvMax.x, glyph.uvMax.y
+                };
+                outVertices.insert(outVertices.end(), std::begin(vertices), std::end(vertices));
+                ++quads;
+            }
+
+            penX     += glyph.advance;
+            previous  = letter.codepoint;
+        }
+    }
+
+    return quads;
+}
+
+const AtlasGlyph* GlyphAtlas::FindGlyph(uint32_t codepoint) const
+{
+    const auto it = glyphIndices.find(codepoint);
+    return it != glyphIndices.end() ? &glyphs[it->second] : nullptr;
+}
+
+int GlyphAtlas::GetKerning(uint32_t left, uint32_t right) const
+{
+    if (kerning.empty()) return 0;
+    const auto it = kerning.find((static_cast<uint64_t>(left) << 32) | right);
+    return it != kerning.end() ? it->second : 0;
+}
+
+bool GlyphAtlas::PlaceGlyphs(
+    const std::vector<GlyphBitmap>& glyphs, const std::vector<unsigned int>& order, unsigned int atlasSize,
+    std::vector<unsigned int>& outX, std::vector<unsigned int>& outY
+)
+{
+    outX.assign(glyphs.size(), 0);
+    outY.assign(glyphs.size(), 0);
+
+    unsigned int shelfX      = GLYPH_ATLAS_PADDING;
+    unsigned int shelfY      = GLYPH_ATLAS_PADDING;
+    unsigned int shelfHeight = 0;
+
+    for (const unsigned int index : order)
+    {
+        const GlyphBitmap& glyph = glyphs[index];
+        if (glyph.width == 0 || glyph.height == 0) continue;
+
+        // Glyphs are sorted by height, the first one of a shelf sets its height
+        if (shelfX + glyph.width + GLYPH_ATLAS_PADDING > atlasSize)
+        {
+            shelfX       = GLYPH_ATLAS_PADDING;
+            shelfY      += shelfHeight + GLYPH_ATLAS_PADDING;
+            shelfHeight  = 0;
+        }
+        if (shelfX + glyph.width + GLYPH_ATLAS_PADDING > atlasSize) return false;
+        if (shelfY + glyph.height + GLYPH_ATLAS_PADDING > atlasSize) return false;
+
+        outX[index]  = shelfX;
+        outY[index]  = shelfY;
+        shelfX      += glyph.width + GLYPH_ATLAS_PADDING;
+        shelfHeight  = std::max(shelfHeight, glyph.height);
+    }
+
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Math/float2.h"
+#include "Math/float3.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr unsigned int GLYPH_ATLAS_PADDING  = 1; // Empty texels around every glyph, linear filtering can't bleed
+constexpr unsigned int GLYPH_ATLAS_MIN_SIZE = 64;
+constexpr unsigned int GLYPH_ATLAS_MAX_SIZE = 4096;
+constexpr unsigned int GLYPH_QUAD_FLOATS    = 24;     // Six vertices of position and uv
+constexpr uint32_t GLYPH_REPLACEMENT        = 0xFFFD; // Given for malformed UTF-8
+constexpr uint32_t GLYPH_FALLBACK           = '?';    // Drawn for characters the atlas doesn't have
+
+// Glyph as rendered by FreeType, one byte of coverage per texel with the top row first
+struct GlyphBitmap
+{
+    uint32_t codepoint   = 0;
+    unsigned int width   = 0;
+    unsigned int height  = 0;
+    int left             = 0;
+    int top              = 0;
+    unsigned int advance = 0; // In 1/64 pixels
+    std::vector<unsigned char> pixels;
+};
+
+struct AtlasGlyph
+{
+    float2 size          = float2::zero;
+    float2 bearing       = float2::zero;
+    float2 uvMin         = float2::zero; // Top left corner, v grows downwards like the bitmap rows
+    float2 uvMax         = float2::zero;
+    unsigned int advance = 0;
+};
+
+// Reads the code point starting at position and moves position past it. Malformed sequences give
+// GLYPH_REPLACEMENT and skip a single byte
+uint32_t DecodeUTF8(const std::string& text, size_t& position);
+
+// Every glyph of a font size packed in a single texture, so a whole string is drawn with one texture and one draw
+// call. Packing and layout don't touch OpenGL, the owner uploads the pixels
+class GlyphAtlas
+{
+  public:
+    // Shelf packing from the tallest glyph to the shortest, in the smallest square power of two where all of them fit.
+    // Returns false if they don't fit in GLYPH_ATLAS_MAX_SIZE
+    bool Pack(const std::vector<GlyphBitmap>& glyphs);
+    // Offset in 1/64 pixels applied to the pen between the two characters
+    void SetKerning(uint32_t left, uint32_t right, int offset);
+
+    // Lays the UTF-8 text out from the top left corner at startPos, appends the quads of the visible characters to
+    // the vertices and returns how many were added. Lines break at '\n' and, when maxWidth is positive, before the
+    // word that would go past it. Words longer than a line are broken between characters
+    unsigned int BuildQuads(
+        const std::string& text, const float3& startPos, unsigned int lineHeight, float maxWidth,
+        std::vector<float>& outVertices
+    ) const;
+
+    const AtlasGlyph* FindGlyph(uint32_t codepoint) const;
+    int GetKerning(uint32_t left, uint32_t right) const;
+    unsigned int GetSize() const { return size; }
+    const std::vector<unsigned char>& GetPixels() const { return pixels; }
+
+  private:
+    // Places the glyphs in order in an atlas of the given size, writing the top left corner of each one
+    static bool PlaceGlyphs(
+        const std::vector<GlyphBitmap>& glyphs, const std::vector<unsigned int>& order, unsigned int atlasSize,
+        std::vector<unsigned int>& outX, std::vector<unsigned int>& outY
+    );
+
+  private:
+    unsigned int size = 0;
+    std::vector<unsigned char> pixels;
+    std::vector<AtlasGlyph> glyphs;
+    std::unordered_map<uint32_t, unsigned int> glyphIndices; // Code point to its glyph
+    std::unordered_map<uint64_t, int> kerning;               // Left code point in the high half of the key
+};
@@ -0,0 +1,136 @@
+#include "LightBuffer.h"
+
+#include "Globals.h"
+#include "RenderState.h"
+
+#include "glew.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#ifdef OPTICK
+#include "optick.h"
+#endif
+
+namespace
+{
+    constexpr GLuint64 COPY_WAIT_TIMEOUT = 1000000; // Nanoseconds per blocking wait, the driver sleeps meanwhile
+} // namespace
+
+LightBuffer::~LightBuffer()
+{
+    for (unsigned int copy = 0; copy < LIGHT_BUFFER_COPIES; ++copy)
+    {
+        if (fences[copy]) glDeleteSync(fences[copy]);
+    }
+    glDeleteBuffers(LIGHT_BUFFER_COPIES, buffers);
+}
+
+void LightBuffer::Bind(RenderState& renderState, unsigned int binding) const
+{
+    renderState.BindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffers[currentCopy], 0, usedSize);
+}
+
+void LightBuffer::Lock()
+{
+    if (fences[currentCopy]) glDeleteSync(fences[currentCopy]);
+    fences[currentCopy] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+std::size_t LightBuffer::Upload(
+    const void* elements, std::size_t elementCount, std::size_t stride, const std::vector<DirtyRange>& dirtyRanges
+)
+{
+    currentCopy            = (currentCopy + 1) % LIGHT_BUFFER_COPIES;
+    usedSize               = LIGHT_BUFFER_HEADER + elementCount * stride;
+    stallTime              = 0.f;
+
+    // New storage starts empty, every slot is written to every copy
+    const bool reallocated = usedSize > capacity;
+    if (reallocated) Allocate(std::max(usedSize, capacity * 2));
+    else WaitCopy(currentCopy);
+
+    unsigned char* copy = mappedCopies[currentCopy];
+    if (copy == nullptr) return 0;
+
+    if (copyCounts[currentCopy] != elementCount)
+    {
+        const int count = static_cast<int>(elementCount);
+        memcpy(copy, &count, sizeof(count));
+        copyCounts[currentCopy] = elementCount;
+    }
+
+    const unsigned char* source = static_cast<const unsigned char*>(elements);
+    std::size_t written         = 0;
+    auto writeRange             = [&](const DirtyRange& range)
+    {
+        if (range.first >= elementCount) return;
+
+        const std::size_t count = std::min(range.count, elementCount - range.first);
+        memcpy(copy + LIGHT_BUFFER_HEADER + range.first * stride, source + range.first * stride, count * stride);
+        written += count;
+    };
+
+    if (reallocated)
+    {
+        writeRange({0, elementCount});
+        pendingRanges.assign(1, {0, elementCount});
+    }
+    else
+    {
+        for (const DirtyRange& range : pendingRanges)
+            writeRange(range);
+        for (const DirtyRange& range : dirtyRanges)
+            writeRange(range);
+        pendingRanges = dirtyRanges;
+    }
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+    return written;
+}
+
+void LightBuffer::Allocate(std::size_t newCapacity)
+{
+    // The old buffers are released by the driver once the GPU stops using them
+    for (unsigned int copy = 0; copy < LIGHT_BUFFER_COPIES; ++copy)
+    {
+        if (fences[copy]) glDeleteSync(fences[copy]);
+        fences[copy] = nullptr;
+    }
+    glDeleteBuffers(LIGHT_BUFFER_COPIES, buffers);
+    glGenBuffers(LIGHT_BUFFER_COPIES, buffers);
+
+    capacity               = newCapacity;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+    for (unsigned int copy = 0; copy < LIGHT_BUFFER_COPIES; ++copy)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[copy]);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, flags);
+        mappedCopies[copy] =
+            static_cast<unsigned char*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, capacity, flags));
+        copyCounts[copy] = ~std::size_t(0);
+
+        if (mappedCopies[copy] == nullptr) GLOG("Error mapping light buffer %d", copy);
+    }
+}
+
+void LightBuffer::WaitCopy(unsigned int copy)
+{
+    if (fences[copy] == nullptr) return;
+
+#ifdef OPTICK
+    OPTICK_CATEGORY("LightBuffer::WaitCopy", Optick::Category::Wait)
+#endif
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // The commands are flushed once, a lost context fails the wait and the copy is written anyway
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        const GLenum waitReturn = glClientWaitSync(fences[copy], waitFlags, COPY_WAIT_TIMEOUT);
+        if (waitReturn != GL_TIMEOUT_EXPIRED) break;
+        waitFlags = 0;
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    stallTime                                              = elapsed.count();
+}
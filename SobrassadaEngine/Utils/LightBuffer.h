@@ -0,0 +1,53 @@
+#pragma once
+
+#include "DirtyBufferMirror.h"
+
+#include <cstddef>
+#include <vector>
+
+class RenderState;
+typedef struct __GLsync* GLsync;
+
+constexpr unsigned int LIGHT_BUFFER_COPIES = 2;
+constexpr std::size_t LIGHT_BUFFER_HEADER  = 16; // Light count, padded to the alignment of the light array
+
+// Shader storage buffer of lights mapped persistently, with a copy for the frame the GPU may still be reading. Only
+// the slots that changed are written, a copy also receives the ranges written to the other one since its last frame
+class LightBuffer
+{
+  public:
+    LightBuffer() = default;
+    ~LightBuffer();
+
+    // Waits until the GPU is done with the copy of this frame and writes the dirty ranges of the mirror in it.
+    // Returns the number of slots written
+    template <typename T> std::size_t Upload(const DirtyBufferMirror<T>& mirror)
+    {
+        return Upload(mirror.GetData(), mirror.GetSize(), sizeof(T), mirror.GetDirtyRanges());
+    }
+
+    void Bind(RenderState& renderState, unsigned int binding) const;
+    // Fence after the draw that reads the current copy
+    void Lock();
+
+    float GetStallTime() const { return stallTime; }
+
+  private:
+    std::size_t Upload(
+        const void* elements, std::size_t elementCount, std::size_t stride, const std::vector<DirtyRange>& dirtyRanges
+    );
+    void Allocate(std::size_t newCapacity);
+    void WaitCopy(unsigned int copy);
+
+  private:
+    unsigned int buffers[LIGHT_BUFFER_COPIES]          = {};
+    unsigned char* mappedCopies[LIGHT_BUFFER_COPIES]   = {};
+    GLsync fences[LIGHT_BUFFER_COPIES]                 = {};
+    std::size_t copyCounts[LIGHT_BUFFER_COPIES]        = {};  // Light count written in the header of each copy
+    std::size_t capacity                               = 0;   // Bytes of each copy
+    std::size_t usedSize                               = 0;
+    unsigned int currentCopy                           = 0;
+    float stallTime                                    = 0.f; // CPU milliseconds the last Upload waited for the GPU
+
+    std::vector<DirtyRange> pendingRanges; // Written to the current copy, the next one has not received them yet
+};
@@ -0,0 +1,161 @@
+#include "LightClusterGrid.h"
+
+#include "Geometry/Sphere.h"
+#include "Math/float4.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // View space point with the given NDC x and y at a positive view depth. Only needs the projections MathGeoLib
+    // builds, without shear between the axes
+    float3 UnprojectAtDepth(const float4x4& projection, float ndcX, float ndcY, float viewDepth)
+    {
+        const float viewZ = -viewDepth;
+        const float w     = projection[3][2] * viewZ + projection[3][3];
+        return float3(
+            (ndcX * w - projection[0][2] * viewZ - projection[0][3]) / projection[0][0],
+            (ndcY * w - projection[1][2] * viewZ - projection[1][3]) / projection[1][1], viewZ
+        );
+    }
+} // namespace
+
+void LightClusterGrid::Build(
+    const float4x4& viewMatrix, const float4x4& projectionMatrix, const std::vector<LightBounds>& pointLights,
+    const std::vector<LightBounds>& spotLights
+)
+{
+    view = viewMatrix;
+    if (clusterBounds.empty() || !projection.Equals(projectionMatrix)) UpdateClusterBounds(projectionMatrix);
+
+    pointHits.clear();
+    spotHits.clear();
+    AddLightHits(pointLights, pointHits);
+    AddLightHits(spotLights, spotHits);
+
+    clusters.assign(LIGHT_CLUSTER_COUNT, LightCluster {});
+    for (const uint64_t hit : pointHits)
+        ++clusters[hit >> 32].pointCount;
+    for (const uint64_t hit : spotHits)
+        ++clusters[hit >> 32].spotCount;
+
+    unsigned int offset = 0;
+    for (LightCluster& cluster : clusters)
+    {
+        cluster.firstLight  = offset;
+        offset             += cluster.pointCount + cluster.spotCount;
+    }
+
+    // Hits are added light by light, so every cluster lists its lights in the order they were given
+    lightIndices.resize(offset);
+    std::vector<unsigned int> cursors(LIGHT_CLUSTER_COUNT);
+    for (unsigned int c = 0; c < LIGHT_CLUSTER_COUNT; ++c)
+        cursors[c] = clusters[c].firstLight;
+
+    for (const uint64_t hit : pointHits)
+        lightIndices[cursors[hit >> 32]++] = static_cast<unsigned int>(hit);
+    for (const uint64_t hit : spotHits)
+        lightIndices[cursors[hit >> 32]++] = static_cast<unsigned int>(hit);
+}
+
+unsigned int LightClusterGrid::GetSlice(float viewDepth) const
+{
+    if (viewDepth <= nearPlane) return 0;
+
+    const int slice = static_cast<int>(std::floor(std::log(viewDepth / nearPlane) * sliceScale));
+    return static_cast<unsigned int>(std::clamp(slice, 0, static_cast<int>(LIGHT_CLUSTER_SLICES) - 1));
+}
+
+int LightClusterGrid::FindCluster(const float3& worldPosition) const
+{
+    const float3 viewPosition = view.TransformPos(worldPosition);
+    const float viewDepth     = -viewPosition.z;
+    if (viewDepth < nearPlane || viewDepth > farPlane) return -1;
+
+    const float4 clip = projection * float4(viewPosition, 1.f);
+    const float ndcX  = clip.x / clip.w;
+    const float ndcY  = clip.y / clip.w;
+    if (std::abs(ndcX) > 1.f || std::abs(ndcY) > 1.f) return -1;
+
+    const unsigned int tileX = std::min(
+        static_cast<unsigned int>((ndcX * 0.5f + 0.5f) * LIGHT_CLUSTER_TILES_X), LIGHT_CLUSTER_TILES_X - 1
+    );
+    const unsigned int tileY = std::min(
+        static_cast<unsigned int>((ndcY * 0.5f + 0.5f) * LIGHT_CLUSTER_TILES_Y), LIGHT_CLUSTER_TILES_Y - 1
+    );
+    return static_cast<int>(GetClusterIndex(tileX, tileY, GetSlice(viewDepth)));
+}
+
+void LightClusterGrid::UpdateClusterBounds(const float4x4& projectionMatrix)
+{
+    projection = projectionMatrix;
+
+    // MathGeoLib builds OpenGL perspective projections but Direct3D orthographic ones
+    if (projection[3][2] != 0.f)
+    {
+        nearPlane = projection[2][3] / (projection[2][2] - 1.f);
+        farPlane  = projection[2][3] / (projection[2][2] + 1.f);
+    }
+    else
+    {
+        nearPlane = projection[2][3] / projection[2][2];
+        farPlane  = (projection[2][3] - 1.f) / projection[2][2];
+    }
+    nearPlane  = std::max(nearPlane, 1e-4f);
+    farPlane   = std::max(farPlane, nearPlane * 1.001f);
+    sliceScale = LIGHT_CLUSTER_SLICES / std::log(farPlane / nearPlane);
+
+    clusterBounds.resize(LIGHT_CLUSTER_COUNT);
+    for (unsigned int slice = 0; slice < LIGHT_CLUSTER_SLICES; ++slice)
+    {
+        const float sliceNear = nearPlane * std::pow(farPlane / nearPlane, float(slice) / LIGHT_CLUSTER_SLICES);
+        const float sliceFar  = nearPlane * std::pow(farPlane / nearPlane, float(slice + 1) / LIGHT_CLUSTER_SLICES);
+
+        for (unsigned int tileY = 0; tileY < LIGHT_CLUSTER_TILES_Y; ++tileY)
+        {
+            const float minY = -1.f + 2.f * tileY / LIGHT_CLUSTER_TILES_Y;
+            const float maxY = -1.f + 2.f * (tileY + 1) / LIGHT_CLUSTER_TILES_Y;
+
+            for (unsigned int tileX = 0; tileX < LIGHT_CLUSTER_TILES_X; ++tileX)
+            {
+                const float minX = -1.f + 2.f * tileX / LIGHT_CLUSTER_TILES_X;
+                const float maxX = -1.f + 2.f * (tileX + 1) / LIGHT_CLUSTER_TILES_X;
+
+                // The cluster is the convex hull of its eight corners
+                AABB& bounds     = clusterBounds[GetClusterIndex(tileX, tileY, slice)];
+                bounds.SetNegativeInfinity();
+                for (const float depth : {sliceNear, sliceFar})
+                {
+                    bounds.Enclose(UnprojectAtDepth(projection, minX, minY, depth));
+                    bounds.Enclose(UnprojectAtDepth(projection, maxX, minY, depth));
+                    bounds.Enclose(UnprojectAtDepth(projection, minX, maxY, depth));
+                    bounds.Enclose(UnprojectAtDepth(projection, maxX, maxY, depth));
+                }
+            }
+        }
+    }
+}
+
+void LightClusterGrid::AddLightHits(const std::vector<LightBounds>& lights, std::vector<uint64_t>& hits) const
+{
+    for (const LightBounds& light : lights)
+    {
+        const Sphere sphere(view.TransformPos(light.center), light.radius);
+        const float depth = -sphere.pos.z;
+        if (depth + sphere.r < nearPlane || depth - sphere.r > farPlane) continue;
+
+        // Only the slices the sphere spans in depth, then the tiles are tested one by one
+        const unsigned int firstSlice = GetSlice(depth - sphere.r);
+        const unsigned int lastSlice  = GetSlice(depth + sphere.r);
+        for (unsigned int slice = firstSlice; slice <= lastSlice; ++slice)
+        {
+            const unsigned int sliceStart = GetClusterIndex(0, 0, slice);
+            for (unsigned int c = sliceStart; c < sliceStart + LIGHT_CLUSTER_TILES_X * LIGHT_CLUSTER_TILES_Y; ++c)
+            {
+                if (clusterBounds[c].Intersects(sphere))
+                    hits.push_back((static_cast<uint64_t>(c) << 32) | light.index);
+            }
+        }
+    }
+}
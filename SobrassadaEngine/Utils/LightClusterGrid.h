@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Geometry/AABB.h"
+#include "Math/float3.h"
+#include "Math/float4x4.h"
+
+#include <cstdint>
+#include <vector>
+
+constexpr unsigned int LIGHT_CLUSTER_TILES_X = 16;
+constexpr unsigned int LIGHT_CLUSTER_TILES_Y = 9;
+constexpr unsigned int LIGHT_CLUSTER_SLICES  = 24;
+constexpr unsigned int LIGHT_CLUSTER_COUNT   = LIGHT_CLUSTER_TILES_X * LIGHT_CLUSTER_TILES_Y * LIGHT_CLUSTER_SLICES;
+
+// Sphere a light can reach and the slot of the light in its buffer, the index the clusters list
+struct LightBounds
+{
+    float3 center;
+    float radius;
+    unsigned int index;
+};
+
+// Same layout as the uvec4 the lighting pass reads
+struct LightCluster
+{
+    unsigned int firstLight; // Offset in the light index list, the point lights go before the spot lights
+    unsigned int pointCount;
+    unsigned int spotCount;
+    unsigned int padding;
+};
+
+// View frustum split in screen tiles and depth slices. The slices grow logarithmically with the distance, so the
+// clusters keep a similar shape. Built on the CPU every frame, no GL calls, the lighting pass only reads the lights
+// of the cluster of each pixel
+class LightClusterGrid
+{
+  public:
+    void Build(
+        const float4x4& viewMatrix, const float4x4& projectionMatrix, const std::vector<LightBounds>& pointLights,
+        const std::vector<LightBounds>& spotLights
+    );
+
+    // Slice of a positive view depth, clamped to the grid
+    unsigned int GetSlice(float viewDepth) const;
+    // Cluster of a world position, the same lookup the lighting pass does. -1 when it is out of the frustum
+    int FindCluster(const float3& worldPosition) const;
+
+    static unsigned int GetClusterIndex(unsigned int tileX, unsigned int tileY, unsigned int slice)
+    {
+        return (slice * LIGHT_CLUSTER_TILES_Y + tileY) * LIGHT_CLUSTER_TILES_X + tileX;
+    }
+
+    const float4x4& GetViewMatrix() const { return view; }
+    float GetNearPlane() const { return nearPlane; }
+    float GetFarPlane() const { return farPlane; }
+    float GetSliceScale() const { return sliceScale; }
+
+    const std::vector<LightCluster>& GetClusters() const { return clusters; }
+    const std::vector<unsigned int>& GetLightIndices() const { return lightIndices; }
+    const AABB& GetClusterBounds(unsigned int cluster) const { return clusterBounds[cluster]; }
+
+  private:
+    void UpdateClusterBounds(const float4x4& projectionMatrix);
+    void AddLightHits(const std::vector<LightBounds>& lights, std::vector<uint64_t>& hits) const;
+
+  private:
+    float4x4 view       = float4x4::identity;
+    float4x4 projection = float4x4::zero; // Projection the cluster bounds were computed with
+    float nearPlane     = 0.f;
+    float farPlane      = 0.f;
+    float sliceScale    = 0.f; // Slices per log unit of depth
+
+    std::vector<AABB> clusterBounds; // In view space
+    std::vector<LightCluster> clusters;
+    std::vector<unsigned int> lightIndices;
+
+    // Cluster and light of every overlap, kept between frames to reuse the memory
+    std::vector<uint64_t> pointHits;
+    std::vector<uint64_t> spotHits;
+};
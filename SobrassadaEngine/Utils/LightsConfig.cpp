@@ -7,6 +7,7 @@
 #include "Framebuffer.h"
 #include "LibraryModule.h"
 #include "OpenGLModule.h"
+#include "RenderState.h"
 #include "ResourceTexture.h"
 #include "ResourcesModule.h"
 #include "SceneModule.h"
@@ -16,10 +17,30 @@
 #include "Standalone/Lights/SpotLightComponent.h"
 #include "TextureImporter.h"
 
+#include "Geometry/Sphere.h"
 #include "glew.h"
 #include "imgui.h"
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 
+namespace
+{
+    // Smallest sphere around the cone of a spot light. Past 45 degrees it is centered on the base of the cone
+    LightBounds SpotLightBounds(
+        const float3& position, const float3& direction, float range, float outerAngle, unsigned int index
+    )
+    {
+        const float angle    = std::min(outerAngle, 89.f) * DEGREE_RAD_CONV;
+        const float cosAngle = std::cos(angle);
+
+        if (cosAngle * cosAngle < 0.5f) return {position + direction * range, range * std::tan(angle), index};
+
+        const float radius = range / (2.f * cosAngle * cosAngle);
+        return {position + direction * radius, radius, index};
+    }
+} // namespace
+
 LightsConfig::LightsConfig()
 {
     ambientColor     = float3(1.0f, 1.0f, 1.0f);
@@ -30,12 +51,13 @@ LightsConfig::~LightsConfig()
 {
     glDeleteBuffers(1, &ambientBufferId);
     glDeleteBuffers(1, &directionalBufferId);
-    glDeleteBuffers(1, &pointBufferId);
-    glDeleteBuffers(1, &spotBufferId);
+    glDeleteBuffers(1, &clusterBufferId);
+    glDeleteBuffers(1, &lightIndexBufferId);
 
     glDeleteVertexArrays(1, &skyboxVao);
     glDeleteBuffers(1, &skyboxVbo);
     glDeleteProgram(skyboxProgram);
+    App->GetOpenGLModule()->GetRenderState()->ForgetProgram(skyboxProgram);
     FreeCubemap();
     delete currentTexture;
 }
@@ -120,20 +142,19 @@ void LightsConfig::RenderSkybox(const float4x4& projection, const float4x4& view
 {
     App->GetOpenGLModule()->SetDepthFunc(false);
 
-    glUseProgram(skyboxProgram);
-    glUniformMatrix4fv(0, 1, GL_TRUE, projection.ptr());
-    glUniformMatrix4fv(1, 1, GL_TRUE, view.ptr());
+    RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+    renderState->UseProgram(skyboxProgram);
+    renderState->SetUniform(0, projection);
+    renderState->SetUniform(1, view);
 
-    if (isHDRTexture) glUniformHandleui64ARB(glGetUniformLocation(skyboxProgram, "hdrSkybox"), skyboxHandle);
-    else glUniformHandleui64ARB(glGetUniformLocation(skyboxProgram, "skybox"), skyboxHandle);
+    const char* skyboxUniform = isHDRTexture ? "hdrSkybox" : "skybox";
+    renderState->SetUniformHandle(renderState->GetUniformLocation(skyboxProgram, skyboxUniform), skyboxHandle);
+    renderState->SetUniform(renderState->GetUniformLocation(skyboxProgram, "isHDR"), isHDRTexture ? 1 : 0);
 
-    GLint isHDRLoc = glGetUniformLocation(skyboxProgram, "isHDR");
-    glUniform1i(isHDRLoc, isHDRTexture);
-
-    glBindVertexArray(skyboxVao);
+    renderState->BindVertexArray(skyboxVao);
     App->GetOpenGLModule()->DrawArrays(GL_TRIANGLES, 0, 36);
 
-    glBindVertexArray(0);
+    renderState->BindVertexArray(0);
 
     App->GetOpenGLModule()->SetDepthFunc(true);
 }
@@ -408,6 +429,11 @@ void LightsConfig::EditorParams(bool& lightConfig)
     ImGui::SliderFloat3("Ambient color", &ambientColor[0], 0, 1);
     ImGui::SliderFloat("Ambient intensity", &ambientIntensity, 0, 1);
 
+    ImGui::SeparatorText("Statistics");
+    ImGui::Text("Visible lights: %u", frameStats.visibleLights);
+    ImGui::Text("Culled lights: %u", frameStats.culledLights);
+    ImGui::Text("Uploaded lights: %u", frameStats.uploadedLights);
+
     ImGui::End();
 }
 
@@ -416,14 +442,14 @@ void LightsConfig::InitLightBuffers()
     // First generate all buffers
     glGenBuffers(1, &ambientBufferId);
     glGenBuffers(1, &directionalBufferId);
-    glGenBuffers(1, &pointBufferId);
-    glGenBuffers(1, &spotBufferId);
+    glGenBuffers(1, &clusterBufferId);
+    glGenBuffers(1, &lightIndexBufferId);
 
     // Then get all lights an resize each buffer accordingly
     GetAllSceneLights();
 }
 
-void LightsConfig::SetLightsShaderData() const
+void LightsConfig::SetLightsShaderData(const float4x4& view, const float4x4& projection)
 {
     // Ambient light
     Lights::AmbientLightShaderData ambient = Lights::AmbientLightShaderData(
@@ -433,11 +459,26 @@ void LightsConfig::SetLightsShaderData() const
 
     glBindBuffer(GL_UNIFORM_BUFFER, ambientBufferId);
     glBufferData(GL_UNIFORM_BUFFER, sizeof(ambient), &ambient, GL_STATIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 2, ambientBufferId);
+    App->GetOpenGLModule()->GetRenderState()->BindBufferBase(GL_UNIFORM_BUFFER, 2, ambientBufferId);
 
     SetDirectionalLightShaderData();
-    SetPointLightsShaderData();
-    SetSpotLightsShaderData();
+
+    frameStats = {};
+    frustumPlanes.UpdateFrustumPlanes(view, projection);
+
+    std::vector<LightBounds> pointBounds;
+    std::vector<LightBounds> spotBounds;
+    SetPointLightsShaderData(pointBounds);
+    SetSpotLightsShaderData(spotBounds);
+    frameStats.visibleLights = static_cast<unsigned int>(pointBounds.size() + spotBounds.size());
+
+    SetLightClustersShaderData(view, projection, pointBounds, spotBounds);
+}
+
+void LightsConfig::LockLightBuffers()
+{
+    pointBuffer.Lock();
+    spotBuffer.Lock();
 }
 
 void LightsConfig::SetDirectionalLightShaderData() const
@@ -451,64 +492,123 @@ void LightsConfig::SetDirectionalLightShaderData() const
 
         glBindBuffer(GL_UNIFORM_BUFFER, directionalBufferId);
         glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Lights::DirectionalLightShaderData), &dirLightData);
-        glBindBufferBase(GL_UNIFORM_BUFFER, 3, directionalBufferId);
+        App->GetOpenGLModule()->GetRenderState()->BindBufferBase(GL_UNIFORM_BUFFER, 3, directionalBufferId);
     }
 }
 
-void LightsConfig::SetPointLightsShaderData() const
+void LightsConfig::SetPointLightsShaderData(std::vector<LightBounds>& bounds)
 {
-    std::vector<Lights::PointLightShaderData> points;
-    for (int i = 0; i < pointLights.size(); ++i)
+    if (pointLightsChanged) pointData.Resize(pointLights.size());
+
+    for (unsigned int i = 0; i < pointLights.size(); ++i)
     {
-        if (pointLights[i] && pointLights[i]->IsEffectivelyEnabled())
+        PointLightComponent* light = pointLights[i];
+        if (light == nullptr) continue;
+
+        // The mirror only marks the slot dirty when the data really changed
+        if (pointLightsChanged || light->IsDirty())
         {
-            points.emplace_back(Lights::PointLightShaderData(
-                float4(pointLights[i]->GetGlobalTransform().TranslatePart(), pointLights[i]->GetRange()),
-                float4(pointLights[i]->GetColor(), pointLights[i]->GetIntensity())
-            ));
+            pointData.Set(
+                i, Lights::PointLightShaderData(
+                       float4(light->GetGlobalTransform().TranslatePart(), light->GetRange()),
+                       float4(light->GetColor(), light->GetIntensity())
+                   )
+            );
+            light->ClearDirty();
         }
-    }
 
-    // This only works whith a constant number of lights. If a new light is added, the buffer must be resized
-    int count = static_cast<int>(points.size());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pointBufferId);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(int), &count);
-    int offset = 16; // Byte start offset for the point light array in the SSBO
-    for (const Lights::PointLightShaderData& light : points)
-    {
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(Lights::PointLightShaderData), &light);
-        offset += sizeof(Lights::PointLightShaderData);
+        if (!light->IsEffectivelyEnabled()) continue;
+
+        const Lights::PointLightShaderData& data = pointData[i];
+        const LightBounds lightBounds            = {data.position.xyz(), data.position.w, i};
+        if (frustumPlanes.Intersects(Sphere(lightBounds.center, lightBounds.radius))) bounds.push_back(lightBounds);
+        else ++frameStats.culledLights;
     }
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, pointBufferId);
+    pointLightsChanged         = false;
+
+    frameStats.uploadedLights += static_cast<unsigned int>(pointBuffer.Upload(pointData));
+    App->GetOpenGLModule()->AddBufferStallTime(pointBuffer.GetStallTime());
+    pointData.ClearDirty();
+    pointBuffer.Bind(*App->GetOpenGLModule()->GetRenderState(), 4);
 }
 
-void LightsConfig::SetSpotLightsShaderData() const
+void LightsConfig::SetSpotLightsShaderData(std::vector<LightBounds>& bounds)
 {
-    // This could probably include only lights that changed
-    std::vector<Lights::SpotLightShaderData> spots;
-    for (int i = 0; i < spotLights.size(); ++i)
+    if (spotLightsChanged) spotData.Resize(spotLights.size());
+
+    for (unsigned int i = 0; i < spotLights.size(); ++i)
     {
-        if (spotLights[i] && spotLights[i]->IsEffectivelyEnabled())
+        SpotLightComponent* light = spotLights[i];
+        if (light == nullptr) continue;
+
+        if (spotLightsChanged || light->IsDirty())
         {
-            spots.emplace_back(Lights::SpotLightShaderData(
-                float4(spotLights[i]->GetGlobalTransform().TranslatePart(), spotLights[i]->GetRange()),
-                float4(spotLights[i]->GetColor(), spotLights[i]->GetIntensity()), float3(spotLights[i]->GetDirection()),
-                spotLights[i]->GetInnerAngle(), spotLights[i]->GetOuterAngle()
-            ));
+            spotData.Set(
+                i, Lights::SpotLightShaderData(
+                       float4(light->GetGlobalTransform().TranslatePart(), light->GetRange()),
+                       float4(light->GetColor(), light->GetIntensity()), light->GetDirection(),
+                       light->GetInnerAngle(), light->GetOuterAngle()
+                   )
+            );
+            light->ClearDirty();
         }
+
+        if (!light->IsEffectivelyEnabled()) continue;
+
+        const Lights::SpotLightShaderData& data = spotData[i];
+        const LightBounds lightBounds =
+            SpotLightBounds(data.position.xyz(), data.direction, data.position.w, data.outerAngle, i);
+        if (frustumPlanes.Intersects(Sphere(lightBounds.center, lightBounds.radius))) bounds.push_back(lightBounds);
+        else ++frameStats.culledLights;
     }
+    spotLightsChanged          = false;
 
-    // This only works whith a constant number of lights. If a new light is added, the buffer must be resized
-    int count = static_cast<int>(spots.size());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, spotBufferId);
-    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(int), &count);
-    int offset = 16; // Byte start offset for the point light array in the SSBO
-    for (const Lights::SpotLightShaderData& light : spots)
+    frameStats.uploadedLights += static_cast<unsigned int>(spotBuffer.Upload(spotData));
+    App->GetOpenGLModule()->AddBufferStallTime(spotBuffer.GetStallTime());
+    spotData.ClearDirty();
+    spotBuffer.Bind(*App->GetOpenGLModule()->GetRenderState(), 5);
+}
+
+void LightsConfig::SetLightClustersShaderData(
+    const float4x4& view, const float4x4& projection, const std::vector<LightBounds>& pointBounds,
+    const std::vector<LightBounds>& spotBounds
+)
+{
+    lightClusters.Build(view, projection, pointBounds, spotBounds);
+
+    // Header with what the lighting pass needs to find the cluster of a pixel, then the clusters
+    struct ClustersHeader
     {
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, sizeof(Lights::SpotLightShaderData), &light);
-        offset += sizeof(Lights::SpotLightShaderData) + 12;
-    }
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, spotBufferId);
+        float4x4 view;
+        unsigned int counts[4];
+        float depth[4];
+    } header = {
+        view,
+        {LIGHT_CLUSTER_TILES_X, LIGHT_CLUSTER_TILES_Y, LIGHT_CLUSTER_SLICES, 0},
+        {lightClusters.GetNearPlane(), lightClusters.GetFarPlane(), lightClusters.GetSliceScale(), 0.f}
+    };
+
+    const std::vector<LightCluster>& clusters = lightClusters.GetClusters();
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterBufferId);
+    glBufferData(
+        GL_SHADER_STORAGE_BUFFER, sizeof(ClustersHeader) + clusters.size() * sizeof(LightCluster), nullptr,
+        GL_DYNAMIC_DRAW
+    );
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(ClustersHeader), &header);
+    glBufferSubData(
+        GL_SHADER_STORAGE_BUFFER, sizeof(ClustersHeader), clusters.size() * sizeof(LightCluster), clusters.data()
+    );
+    RenderState* renderState = App->GetOpenGLModule()->GetRenderState();
+    renderState->BindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, clusterBufferId);
+
+    // Never empty, binding a buffer without storage is an error
+    const std::vector<unsigned int>& indices = lightClusters.GetLightIndices();
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightIndexBufferId);
+    glBufferData(
+        GL_SHADER_STORAGE_BUFFER, std::max<size_t>(indices.size(), 1) * sizeof(unsigned int),
+        indices.empty() ? nullptr : indices.data(), GL_DYNAMIC_DRAW
+    );
+    renderState->BindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, lightIndexBufferId);
 }
 
 void LightsConfig::AddDirectionalLight(DirectionalLightComponent* newDirectional)
@@ -531,12 +631,8 @@ void LightsConfig::AddPointLight(PointLightComponent* newPoint)
         return;
     }
 
-    // Add point light to vector and resize buffer
     pointLights.push_back(newPoint);
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pointBufferId);
-    int bufferSize = static_cast<int>(sizeof(Lights::PointLightShaderData) * pointLights.size() + 16);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
+    pointLightsChanged = true;
     /*
     GLOG(
         "Add point light with uid: %d. Point lights count: %d. Buffer size: %d", newPoint->GetUID(), pointLights.size(),
@@ -553,12 +649,7 @@ void LightsConfig::AddSpotLight(SpotLightComponent* newSpot)
     }
 
     spotLights.push_back(newSpot);
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, spotBufferId);
-    int bufferSize = static_cast<int>(
-        (sizeof(Lights::SpotLightShaderData) + 12) * spotLights.size() + 16
-    ); // 12 bytes offset between spotlights
-    glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
+    spotLightsChanged = true;
     /*
     GLOG(
         "Add spot light with uid: %d. Spot lights count: %d. Buffer size: %d", newSpot->GetUID(), spotLights.size(),
@@ -600,11 +691,7 @@ void LightsConfig::RemovePointLight(PointLightComponent* point)
         }
     }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pointBufferId);
-    int bufferSize = static_cast<int>(sizeof(Lights::PointLightShaderData) * pointLights.size() + 16);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
-
-    // GLOG("Point lights size: %d. Buffer size: %d", pointLights.size(), bufferSize);
+    pointLightsChanged = true;
 }
 
 void LightsConfig::RemoveSpotLight(SpotLightComponent* spot)
@@ -629,14 +716,7 @@ void LightsConfig::RemoveSpotLight(SpotLightComponent* spot)
         }
     }
 
-    // Resize lights buffer
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, spotBufferId);
-    int bufferSize = static_cast<int>(
-        (sizeof(Lights::SpotLightShaderData) + 12) * spotLights.size() + 16
-    ); // 12 bytes offset between spotlights
-    glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
-
-    // GLOG("Spot lights size: %d. Buffer size: %d", spotLights.size(), bufferSize);
+    spotLightsChanged = true;
 }
 
 void LightsConfig::GetAllSceneLights()
@@ -657,14 +737,8 @@ void LightsConfig::GetAllSceneLights()
         spotLights            = scene->GetEnabledComponentsOfType<SpotLightComponent*>();
         // GLOG("Spot lights count: %d", spotLights.size());
 
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, pointBufferId);
-        size_t pointBufferSize = sizeof(Lights::PointLightShaderData) * pointLights.size() + 16;
-        glBufferData(GL_SHADER_STORAGE_BUFFER, pointBufferSize, nullptr, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, spotBufferId);
-        size_t spotBufferSize =
-            (sizeof(Lights::SpotLightShaderData) + 12) * spotLights.size() + 16; // 12 bytes offset between spotlights
-        glBufferData(GL_SHADER_STORAGE_BUFFER, spotBufferSize, nullptr, GL_STATIC_DRAW);
+        pointLightsChanged     = true;
+        spotLightsChanged      = true;
 
         glBindBuffer(GL_UNIFORM_BUFFER, directionalBufferId);
         glBufferData(GL_UNIFORM_BUFFER, sizeof(Lights::DirectionalLightShaderData), nullptr, GL_STATIC_DRAW);
@@ -685,9 +759,7 @@ void LightsConfig::GetAllPointLights(const std::vector<Component*>& components)
         }
     }
     // GLOG("Point lights count: %d", pointLights.size());
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pointBufferId);
-    size_t bufferSize = sizeof(Lights::PointLightShaderData) * pointLights.size() + 16;
-    glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
+    pointLightsChanged = true;
 }
 
 void LightsConfig::GetAllSpotLights(const std::vector<Component*>& components)
@@ -705,11 +777,7 @@ void LightsConfig::GetAllSpotLights(const std::vector<Component*>& components)
     }
     // GLOG("Spot lights count: %d", spotLights.size());
 
-    // Maybe make function to do this because it's called like 3 times
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, spotBufferId);
-    size_t bufferSize =
-        (sizeof(Lights::SpotLightShaderData) + 12) * spotLights.size() + 16; // 12 bytes offset between spotlights
-    glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
+    spotLightsChanged = true;
 }
 
 void LightsConfig::GetDirectionalLight(const std::vector<Component*>& components)
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "FrustumPlanes.h"
 #include "Globals.h"
+#include "LightBuffer.h"
+#include "LightClusterGrid.h"
 
 #include "Math/float3.h"
 #include "Math/float4.h"
@@ -48,6 +51,7 @@ namespace Lights
         float4 position;
         float4 color;
 
+        PointLightShaderData() = default;
         PointLightShaderData(const float4& pos, const float4& color) : position(pos), color(color) {}
     };
 
@@ -58,7 +62,9 @@ namespace Lights
         float3 direction;
         float innerAngle;
         float outerAngle;
+        float padding[3] = {}; // Array stride of the struct in std430
 
+        SpotLightShaderData() = default;
         SpotLightShaderData(
             const float4& pos, const float4& color, const float3& dir, const float inner, const float outer
         )
@@ -66,6 +72,14 @@ namespace Lights
         {
         }
     };
+
+    // Counters of the last frame
+    struct LightsFrameStats
+    {
+        unsigned int uploadedLights = 0; // Slots written to the light buffers
+        unsigned int visibleLights  = 0;
+        unsigned int culledLights   = 0; // Enabled lights out of the camera frustum
+    };
 } // namespace Lights
 
 class DirectionalLightComponent;
@@ -87,7 +101,10 @@ class LightsConfig
     unsigned int EnvironmentBRDFGeneration(int width, int height);
 
     void InitLightBuffers();
-    void SetLightsShaderData() const;
+    void SetLightsShaderData(const float4x4& view, const float4x4& projection);
+    // Called after the lighting pass, the light buffers written this frame are not reused until the GPU is done
+    void LockLightBuffers();
+    const Lights::LightsFrameStats& GetFrameStats() const { return frameStats; }
     void GetAllSceneLights();
 
     void AddDirectionalLight(DirectionalLightComponent* newDirectional);
@@ -112,8 +129,12 @@ class LightsConfig
     void GetDirectionalLight(const std::vector<Component*>& components);
 
     void SetDirectionalLightShaderData() const;
-    void SetPointLightsShaderData() const;
-    void SetSpotLightsShaderData() const;
+    void SetPointLightsShaderData(std::vector<LightBounds>& bounds);
+    void SetSpotLightsShaderData(std::vector<LightBounds>& bounds);
+    void SetLightClustersShaderData(
+        const float4x4& view, const float4x4& projection, const std::vector<LightBounds>& pointBounds,
+        const std::vector<LightBounds>& spotBounds
+    );
 
   private:
     UID skyboxUID                          = INVALID_UID;
@@ -136,14 +157,24 @@ class LightsConfig
     float ambientIntensity;
     unsigned int directionalBufferId            = 0;
     unsigned int ambientBufferId                = 0;
-    unsigned int pointBufferId                  = 0;
-    unsigned int spotBufferId                   = 0;
+    unsigned int clusterBufferId                = 0;
+    unsigned int lightIndexBufferId             = 0;
 
     int numMipMaps                              = 0;
 
     DirectionalLightComponent* directionalLight = nullptr;
     std::vector<PointLightComponent*> pointLights;
     std::vector<SpotLightComponent*> spotLights;
+    bool pointLightsChanged = true; // Adding or removing lights moves the slots, all of them are written again
+    bool spotLightsChanged  = true;
+
+    DirtyBufferMirror<Lights::PointLightShaderData> pointData;
+    DirtyBufferMirror<Lights::SpotLightShaderData> spotData;
+    LightBuffer pointBuffer;
+    LightBuffer spotBuffer;
+    FrustumPlanes frustumPlanes;
+    Lights::LightsFrameStats frameStats;
+    LightClusterGrid lightClusters;
 
     ResourceTexture* currentTexture = nullptr;
     std::string currentTextureName  = "Not selected";
@@ -0,0 +1,171 @@
+#include "PersistentRingBuffer.h"
+
+#include "Globals.h"
+#include "RenderState.h"
+
+#include "glew.h"
+#include <algorithm>
+#include <chrono>
+#ifdef OPTICK
+#include "optick.h"
+#endif
+
+namespace
+{
+    constexpr GLuint64 STALL_WAIT_TIMEOUT = 1000000; // Nanoseconds per blocking wait, the driver sleeps meanwhile
+} // namespace
+
+PersistentRingBuffer::PersistentRingBuffer(unsigned int depth)
+    : initialDepth(std::clamp(depth, 1u, PERSISTENT_RING_MAX_DEPTH))
+{
+}
+
+PersistentRingBuffer::~PersistentRingBuffer()
+{
+    Release();
+}
+
+void PersistentRingBuffer::Allocate(std::size_t newRegionSize)
+{
+    Release();
+    regionSize = newRegionSize;
+    if (regionSize == 0) return;
+
+    regions.resize(initialDepth);
+    for (Region& region : regions)
+        region = CreateRegion();
+}
+
+void PersistentRingBuffer::Release()
+{
+    for (Region& region : regions)
+        DeleteRegion(region);
+    regions.clear();
+    current      = 0;
+    regionSize   = 0;
+    framesOnTime = 0;
+}
+
+void* PersistentRingBuffer::Acquire()
+{
+    stallTime = 0.f;
+    if (regions.empty()) return nullptr;
+
+    // Regions are used in order, if the oldest one is still being read so are the rest
+    const unsigned int next = (current + 1) % GetDepth();
+    if (!IsSignaled(regions[next].fence))
+    {
+        framesOnTime = 0;
+        if (GetDepth() < PERSISTENT_RING_MAX_DEPTH)
+        {
+            regions.insert(regions.begin() + current + 1, CreateRegion());
+            GLOG("GPU is %u frames behind, persistent buffer ring grown to %u regions", GetDepth() - 1, GetDepth());
+        }
+        else WaitFence(regions[next].fence);
+    }
+    else if (GetDepth() > initialDepth && ++framesOnTime >= PERSISTENT_RING_SHRINK_FRAMES)
+    {
+        // The free region is dropped when the one after it, written next instead, is free as well
+        const unsigned int following = (next + 1) % GetDepth();
+        if (following != current && IsSignaled(regions[following].fence))
+        {
+            DeleteRegion(regions[next]);
+            regions.erase(regions.begin() + next);
+            if (next < current) --current;
+
+            framesOnTime = 0;
+            GLOG("GPU caught up, persistent buffer ring shrunk to %u regions", GetDepth());
+        }
+    }
+
+    current        = (current + 1) % GetDepth();
+    Region& region = regions[current];
+    if (region.fence)
+    {
+        glDeleteSync(region.fence);
+        region.fence = nullptr;
+    }
+    return region.mapping;
+}
+
+void PersistentRingBuffer::Lock()
+{
+    if (regions.empty()) return;
+
+    Region& region = regions[current];
+    if (region.fence) glDeleteSync(region.fence);
+    region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void PersistentRingBuffer::Bind(RenderState& renderState, unsigned int binding) const
+{
+    if (regions.empty()) return;
+
+    renderState.BindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, regions[current].buffer, 0, regionSize);
+}
+
+void* PersistentRingBuffer::GetMapping() const
+{
+    return regions.empty() ? nullptr : regions[current].mapping;
+}
+
+PersistentRingBuffer::Region PersistentRingBuffer::CreateRegion() const
+{
+    // Immutable storage, growing means creating the regions again
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+
+    Region region;
+    glGenBuffers(1, &region.buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, region.buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, regionSize, nullptr, flags);
+    region.mapping = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, regionSize, flags);
+
+    if (region.mapping == nullptr) GLOG("Error mapping persistent buffer region of %zu bytes", regionSize);
+    return region;
+}
+
+void PersistentRingBuffer::DeleteRegion(Region& region) const
+{
+    if (region.fence) glDeleteSync(region.fence);
+
+    // The driver releases the storage once the GPU stops using it
+    if (region.mapping)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, region.buffer);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    }
+    glDeleteBuffers(1, &region.buffer);
+    region = Region();
+}
+
+bool PersistentRingBuffer::IsSignaled(GLsync fence)
+{
+    if (fence == nullptr) return true;
+
+    GLint status = GL_UNSIGNALED;
+    glGetSynciv(fence, GL_SYNC_STATUS, 1, nullptr, &status);
+    return status == GL_SIGNALED;
+}
+
+void PersistentRingBuffer::WaitFence(GLsync fence)
+{
+#ifdef OPTICK
+    OPTICK_CATEGORY("PersistentRingBuffer::WaitFence", Optick::Category::Wait)
+#endif
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // The commands are flushed once, a lost context fails the wait and the region is written anyway
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        const GLenum waitReturn = glClientWaitSync(fence, waitFlags, STALL_WAIT_TIMEOUT);
+        if (waitReturn != GL_TIMEOUT_EXPIRED) break;
+        waitFlags = 0;
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    stallTime                                              = elapsed.count();
+#ifdef OPTICK
+    OPTICK_TAG("Stall (ms)", stallTime);
+#endif
+}
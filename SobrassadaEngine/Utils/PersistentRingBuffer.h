@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class RenderState;
+typedef struct __GLsync* GLsync;
+
+constexpr unsigned int PERSISTENT_RING_DEPTH         = 3;   // Frames the CPU can write ahead of the GPU
+constexpr unsigned int PERSISTENT_RING_MAX_DEPTH     = 8;   // Regions added while the GPU lags, then the CPU waits
+constexpr unsigned int PERSISTENT_RING_SHRINK_FRAMES = 300; // Frames without lag before a grown ring drops a region
+
+// Shader storage buffer mapped persistently, with a ring of regions the CPU writes in turns. Every region is fenced
+// after the draws that read it and is only written again once its fence is signaled. Fences are checked without
+// waiting: when the GPU still reads the oldest region, a new one is added to the ring instead, and only at
+// PERSISTENT_RING_MAX_DEPTH does the CPU block on the fence. Once the GPU keeps up again the added regions are released
+// one every PERSISTENT_RING_SHRINK_FRAMES, back to the initial depth
+class PersistentRingBuffer
+{
+  public:
+    PersistentRingBuffer(unsigned int depth = PERSISTENT_RING_DEPTH);
+    ~PersistentRingBuffer();
+
+    // Creates the regions again with the new size, the content is lost. A size of 0 releases them
+    void Allocate(std::size_t newRegionSize);
+    void Release();
+
+    // Moves to the next region the GPU is done with and returns its mapping, nullptr if the buffer is not mapped
+    void* Acquire();
+    // Fence after the draws that read the current region
+    void Lock();
+    void Bind(RenderState& renderState, unsigned int binding) const;
+
+    void* GetMapping() const;
+    unsigned int GetDepth() const { return static_cast<unsigned int>(regions.size()); }
+    std::size_t GetRegionSize() const { return regionSize; }
+    float GetStallTime() const { return stallTime; }
+
+  private:
+    struct Region
+    {
+        unsigned int buffer = 0;
+        void* mapping       = nullptr;
+        GLsync fence        = nullptr;
+    };
+
+    Region CreateRegion() const;
+    void DeleteRegion(Region& region) const;
+    static bool IsSignaled(GLsync fence);
+    void WaitFence(GLsync fence);
+
+  private:
+    std::vector<Region> regions;
+    unsigned int initialDepth = PERSISTENT_RING_DEPTH;
+    unsigned int current      = 0;
+    std::size_t regionSize    = 0;
+    float stallTime           = 0.f; // CPU milliseconds the last Acquire waited for the GPU
+    unsigned int framesOnTime = 0;   // Acquires in a row that found the oldest region free
+};
@@ -3,14 +3,209 @@
 #include "Application.h"
 #include "FileSystem/Mesh.h"
 #include "GameObject.h"
+#include "ResourceMesh.h"
 #include "SceneModule.h"
 #include "Standalone/MeshComponent.h"
-#include "ResourceMesh.h"
+#include "Standalone/Physics/CapsuleColliderComponent.h"
+#include "Standalone/Physics/CubeColliderComponent.h"
+#include "Standalone/Physics/SphereColliderComponent.h"
 
 #include "Geometry/Triangle.h"
 #include "Math/float4x4.h"
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
+#ifdef OPTICK
+#include "optick.h"
+#endif
+
+// Waking a pooled worker is cheap, but a handful of queries is still faster on a single thread
+constexpr size_t MIN_RAYCASTS_PER_WORKER = 32;
+
+namespace
+{
+    // Threads kept alive between batches, so a call only pays for waking them. Every call runs one job on a number of
+    // workers, the calling thread is worker 0 and the call returns once all of them finished
+    class RaycastWorkerPool
+    {
+      public:
+        RaycastWorkerPool()
+        {
+            const size_t hardwareThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+            for (size_t worker = 1; worker < hardwareThreads; ++worker)
+                threads.emplace_back(&RaycastWorkerPool::WorkerLoop, this, worker);
+        }
+
+        ~RaycastWorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wakeWorkers.notify_all();
+            for (std::thread& thread : threads)
+                thread.join();
+        }
+
+        size_t GetMaxWorkers() const { return threads.size() + 1; }
+
+        void Run(size_t workerCount, const std::function<void(size_t)>& workerJob)
+        {
+            // Batches from different threads take turns, the pool runs a single job at a time
+            std::lock_guard<std::mutex> runLock(runMutex);
+            workerCount = std::clamp<size_t>(workerCount, 1, GetMaxWorkers());
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                job           = &workerJob;
+                activeWorkers = workerCount;
+                pendingJobs   = workerCount - 1;
+                ++generation;
+            }
+            if (workerCount > 1) wakeWorkers.notify_all();
+
+            workerJob(0);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            jobsDone.wait(lock, [this] { return pendingJobs == 0; });
+            job = nullptr;
+        }
+
+      private:
+        void WorkerLoop(size_t worker)
+        {
+            unsigned int seenGeneration = 0;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true)
+            {
+                wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) return;
+
+                seenGeneration = generation;
+                if (worker >= activeWorkers) continue; // Not needed for this job
+
+                const std::function<void(size_t)>* currentJob = job;
+                lock.unlock();
+                (*currentJob)(worker);
+                lock.lock();
+
+                if (--pendingJobs == 0) jobsDone.notify_one();
+            }
+        }
+
+      private:
+        std::vector<std::thread> threads;
+        std::mutex runMutex;
+        std::mutex mutex; // Guards everything below
+        std::condition_variable wakeWorkers;
+        std::condition_variable jobsDone;
+        const std::function<void(size_t)>* job = nullptr;
+        size_t activeWorkers                   = 0;
+        size_t pendingJobs                     = 0; // Workers besides the caller still running the job
+        unsigned int generation                = 0; // Increased by every job, workers wait for it to change
+        bool stopping                          = false;
+    };
+
+    RaycastWorkerPool& GetWorkerPool()
+    {
+        // Created by the first batch, its threads are joined when the program exits
+        static RaycastWorkerPool pool;
+        return pool;
+    }
+
+    // Layer of the closest collider from the object up to the root of its branch, meshes are usually children of the
+    // object with the collider
+    ColliderLayer GetColliderLayer(const GameObject* gameObject, Scene* scene)
+    {
+        while (gameObject != nullptr)
+        {
+            if (const CubeColliderComponent* cube = gameObject->GetComponent<CubeColliderComponent*>())
+                return cube->layer;
+            if (const SphereColliderComponent* sphere = gameObject->GetComponent<SphereColliderComponent*>())
+                return sphere->layer;
+            if (const CapsuleColliderComponent* capsule = gameObject->GetComponent<CapsuleColliderComponent*>())
+                return capsule->layer;
+
+            if (gameObject->GetUID() == scene->GetGameObjectRootUID()) break;
+            gameObject = scene->GetGameObjectByUID(gameObject->GetParent());
+        }
+        return ColliderLayer::WORLD_OBJECTS;
+    }
+
+    bool RaycastObjects(
+        const RaycastQuery& query, Scene* scene, const std::vector<GameObject*>& candidates, RaycastHit& outHit
+    )
+    {
+        float closestDistance = 1.f; // Normalized along the segment, the same in local and world space
+        float nearDistance    = 0.f;
+        float farDistance     = 0.f;
+
+        for (GameObject* gameObject : candidates)
+        {
+            if (gameObject == query.ignoredGameObject) continue;
+            if (!query.segment.Intersects(gameObject->GetGlobalAABB(), nearDistance, farDistance)) continue;
+            if (nearDistance > closestDistance) continue;
+
+            const MeshComponent* meshComponent = gameObject->GetComponent<MeshComponent*>();
+            if (meshComponent == nullptr || !meshComponent->GetEnabled()) continue;
+            if (!gameObject->IsGloballyEnabled()) continue;
+
+            const int layerBit = 1 << static_cast<int>(GetColliderLayer(gameObject, scene));
+            if (!(query.layerMask & layerBit)) continue;
+
+            const ResourceMesh* resourceMesh = meshComponent->GetResourceMesh();
+            if (resourceMesh == nullptr || resourceMesh->GetBVH().IsEmpty()) continue;
+
+            const float4x4& globalTransform = meshComponent->GetCombinedMatrix();
+            float4x4 inverseTransform       = globalTransform;
+            if (!inverseTransform.Inverse()) continue;
+
+            LineSegment localSegment(query.segment);
+            localSegment.Transform(inverseTransform);
+
+            float distance = closestDistance;
+            float3 localHitPoint;
+            float3 localNormal;
+            if (resourceMesh->GetBVH().Intersects(localSegment, distance, localHitPoint, localNormal) &&
+                distance < closestDistance)
+            {
+                closestDistance   = distance;
+                outHit.gameObject = gameObject;
+                outHit.hitPoint   = globalTransform.MulPos(localHitPoint);
+                // Normals are transformed by the inverse transpose to stay valid under non uniform scale
+                outHit.hitNormal  = inverseTransform.Transposed().MulDir(localNormal).Normalized();
+            }
+        }
+
+        if (outHit.gameObject != nullptr) outHit.distance = closestDistance * query.segment.Length();
+        return outHit.gameObject != nullptr;
+    }
+
+    bool ResolveQuery(const RaycastQuery& query, Scene* scene, std::vector<GameObject*>& candidates, RaycastHit& outHit)
+    {
+        outHit = RaycastHit();
+        candidates.clear();
+
+        const Octree* staticTree    = scene->GetOctree();
+        const Quadtree* dynamicTree = scene->GetDynamicTree();
+        if (staticTree != nullptr && (query.treeMask & RAYCAST_STATIC_TREE))
+            staticTree->QueryElements<LineSegment>(query.segment, candidates);
+
+        if (dynamicTree != nullptr && (query.treeMask & RAYCAST_DYNAMIC_TREE))
+        {
+            // The quadtree is flat on the XZ plane, it is queried with the segment bounds projected on it
+            AABB segmentBounds(query.segment.a.Min(query.segment.b), query.segment.a.Max(query.segment.b));
+            segmentBounds.minPoint.y = -1.f;
+            segmentBounds.maxPoint.y = 1.f;
+            dynamicTree->QueryElements<AABB>(segmentBounds, candidates);
+        }
+
+        return RaycastObjects(query, scene, candidates, outHit);
+    }
+} // namespace
 
 namespace RaycastController
 {
@@ -98,4 +293,53 @@ namespace RaycastController
 
         return selectedGameObject;
     }
+
+    bool Raycast(const RaycastQuery& query, RaycastHit& outHit)
+    {
+        Scene* scene = App->GetSceneModule()->GetScene();
+        if (scene == nullptr)
+        {
+            outHit = RaycastHit();
+            return false;
+        }
+
+        std::vector<GameObject*> candidates;
+        return ResolveQuery(query, scene, candidates, outHit);
+    }
+
+    void RaycastBatch(const std::vector<RaycastQuery>& queries, std::vector<RaycastHit>& outHits)
+    {
+#ifdef OPTICK
+        OPTICK_CATEGORY("RaycastController::RaycastBatch", Optick::Category::GameLogic)
+#endif
+        outHits.resize(queries.size());
+        if (queries.empty()) return;
+
+        Scene* scene = App->GetSceneModule()->GetScene();
+        if (scene == nullptr)
+        {
+            std::fill(outHits.begin(), outHits.end(), RaycastHit());
+            return;
+        }
+
+        RaycastWorkerPool& pool       = GetWorkerPool();
+        const size_t workerCount      = std::min(
+            pool.GetMaxWorkers(), (queries.size() + MIN_RAYCASTS_PER_WORKER - 1) / MIN_RAYCASTS_PER_WORKER
+        );
+        const size_t queriesPerWorker = (queries.size() + workerCount - 1) / workerCount;
+
+        // The trees, the scene objects and the mesh BVHs are only read here, so every worker can traverse them at the
+        // same time. The calling thread resolves the first range instead of waiting idle
+        pool.Run(
+            workerCount,
+            [&](size_t worker)
+            {
+                std::vector<GameObject*> candidates;
+                const size_t first = worker * queriesPerWorker;
+                const size_t last  = std::min(first + queriesPerWorker, queries.size());
+                for (size_t i = first; i < last; ++i)
+                    ResolveQuery(queries[i], scene, candidates, outHits[i]);
+            }
+        );
+    }
 } // namespace RaycastController
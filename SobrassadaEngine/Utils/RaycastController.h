@@ -1,16 +1,50 @@
 #pragma once
 
+#include "ComponentUtils.h"
+#include "Globals.h"
 #include "Octree.h"
 #include "Quadtree.h"
 
+#include "Geometry/LineSegment.h"
+#include "Math/float3.h"
 #include <vector>
 
-namespace math
+class GameObject;
+
+// Spatial structures a batched raycast is tested against
+enum RaycastTree : int
 {
-    class LineSegment;
-}
+    RAYCAST_STATIC_TREE  = 1 << 0, // Static objects, stored in the scene octree
+    RAYCAST_DYNAMIC_TREE = 1 << 1, // Dynamic objects, stored in the scene quadtree
+    RAYCAST_ALL_TREES    = RAYCAST_STATIC_TREE | RAYCAST_DYNAMIC_TREE
+};
 
-class GameObject;
+struct RaycastQuery
+{
+    RaycastQuery() = default;
+    RaycastQuery(
+        const math::LineSegment& segment, int layerMask = ALL_COLLIDER_LAYERS, const GameObject* ignore = nullptr,
+        int treeMask = RAYCAST_ALL_TREES
+    )
+        : segment(segment), layerMask(layerMask), ignoredGameObject(ignore), treeMask(treeMask) {};
+
+    math::LineSegment segment;
+    // Collider layers that can be hit. Objects take the layer of the closest collider in their branch, objects without
+    // any are world objects
+    int layerMask                       = ALL_COLLIDER_LAYERS;
+    const GameObject* ignoredGameObject = nullptr; // Usually the one casting the ray
+    int treeMask                        = RAYCAST_ALL_TREES;
+};
+
+struct RaycastHit
+{
+    GameObject* gameObject = nullptr;
+    float3 hitPoint        = float3::zero;
+    float3 hitNormal       = float3::zero;
+    float distance         = 0.f; // World space distance from the segment start
+
+    bool HasHit() const { return gameObject != nullptr; }
+};
 
 namespace RaycastController
 {
@@ -24,4 +58,11 @@ namespace RaycastController
 
         return GetRayIntersectionObject(ray, queriedGameObjects);
     }
-} // namespace RaycastController
\ No newline at end of file
+
+    // Closest hit against the meshes of the current scene
+    SOBRASADA_API_ENGINE bool Raycast(const RaycastQuery& query, RaycastHit& outHit);
+
+    // Resolves every query against the current scene, splitting them across worker threads. outHits is resized to
+    // match queries and can be reused between calls to avoid allocations
+    SOBRASADA_API_ENGINE void RaycastBatch(const std::vector<RaycastQuery>& queries, std::vector<RaycastHit>& outHits);
+} // namespace RaycastController
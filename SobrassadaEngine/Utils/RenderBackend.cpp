@@ -0,0 +1,85 @@
+#include "RenderBackend.h"
+
+#include <algorithm>
+#include <cstring>
+
+void RecordingRenderBackend::UseProgram(unsigned int program)
+{
+    Record(RenderCall::UseProgram, program);
+}
+
+void RecordingRenderBackend::BindVertexArray(unsigned int vao)
+{
+    Record(RenderCall::BindVertexArray, vao);
+}
+
+void RecordingRenderBackend::BindTexture(unsigned int unit, unsigned int texture)
+{
+    Record(RenderCall::BindTexture, unit, texture);
+}
+
+void RecordingRenderBackend::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+    Record(RenderCall::BindBufferBase, target, index, buffer);
+}
+
+void RecordingRenderBackend::BindBufferRange(
+    unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+)
+{
+    Record(RenderCall::BindBufferRange, target, index, buffer, (static_cast<uint64_t>(offset) << 32) | size);
+}
+
+int RecordingRenderBackend::GetUniformLocation(unsigned int program, const char* name)
+{
+    Record(RenderCall::GetUniformLocation, program);
+
+    int programLocations = 0;
+    for (const auto& location : uniformLocations)
+        if (location.first.first == program) ++programLocations;
+
+    const auto inserted = uniformLocations.emplace(std::make_pair(program, std::string(name)), programLocations);
+    return inserted.first->second;
+}
+
+void RecordingRenderBackend::SetUniform(int location, UniformType type, const void* value)
+{
+    // Only the first word of the value is kept, enough to tell the calls apart
+    unsigned int firstWord = 0;
+    memcpy(&firstWord, value, sizeof(firstWord));
+    Record(RenderCall::SetUniform, static_cast<uint64_t>(location), static_cast<uint64_t>(type), firstWord);
+}
+
+void RecordingRenderBackend::DrawArrays(unsigned int mode, int first, int count)
+{
+    Record(RenderCall::DrawArrays, mode, static_cast<uint64_t>(first), static_cast<uint64_t>(count));
+}
+
+void RecordingRenderBackend::DrawElements(unsigned int mode, int count, unsigned int type, const void* indices)
+{
+    Record(
+        RenderCall::DrawElements, mode, static_cast<uint64_t>(count), type, reinterpret_cast<uintptr_t>(indices)
+    );
+}
+
+void RecordingRenderBackend::MultiDrawElementsIndirect(
+    unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+)
+{
+    Record(
+        RenderCall::MultiDrawElementsIndirect, mode, type, reinterpret_cast<uintptr_t>(indirect),
+        static_cast<uint64_t>(drawCount)
+    );
+}
+
+std::size_t RecordingRenderBackend::CountCalls(RenderCall call) const
+{
+    return std::count_if(
+        calls.begin(), calls.end(), [call](const RecordedCall& recorded) { return recorded.call == call; }
+    );
+}
+
+void RecordingRenderBackend::Record(RenderCall call, uint64_t first, uint64_t second, uint64_t third, uint64_t fourth)
+{
+    calls.push_back({call, {first, second, third, fourth}});
+}
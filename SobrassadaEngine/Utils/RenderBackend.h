@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Layout of the value given to SetUniform. Matrices are row major and get transposed
+enum class UniformType : unsigned char
+{
+    Int,
+    UInt,
+    Float,
+    Float2,
+    UInt2,
+    Float3,
+    Matrix4,
+    Handle
+};
+
+enum class RenderCall : unsigned char
+{
+    UseProgram,
+    BindVertexArray,
+    BindTexture,
+    BindBufferBase,
+    BindBufferRange,
+    GetUniformLocation,
+    SetUniform,
+    DrawArrays,
+    DrawElements,
+    MultiDrawElementsIndirect,
+    Count
+};
+
+constexpr const char* RenderCallNames[] = {
+    "UseProgram",
+    "BindVertexArray",
+    "BindTexture",
+    "BindBufferBase",
+    "BindBufferRange",
+    "GetUniformLocation",
+    "SetUniform",
+    "DrawArrays",
+    "DrawElements",
+    "MultiDrawElementsIndirect",
+};
+
+// Receives the calls that get past the RenderState cache. Enums are GL values, the backend does not need GL headers
+class RenderBackend
+{
+  public:
+    virtual ~RenderBackend() = default;
+
+    virtual void UseProgram(unsigned int program)                                             = 0;
+    virtual void BindVertexArray(unsigned int vao)                                            = 0;
+    virtual void BindTexture(unsigned int unit, unsigned int texture)                         = 0;
+    virtual void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) = 0;
+    virtual void BindBufferRange(
+        unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+    ) = 0;
+
+    virtual int GetUniformLocation(unsigned int program, const char* name)                          = 0;
+    virtual void SetUniform(int location, UniformType type, const void* value)                      = 0;
+    virtual void DrawArrays(unsigned int mode, int first, int count)                                = 0;
+    virtual void DrawElements(unsigned int mode, int count, unsigned int type, const void* indices) = 0;
+    virtual void MultiDrawElementsIndirect(
+        unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+    ) = 0;
+};
+
+struct RecordedCall
+{
+    RenderCall call;
+    uint64_t arguments[4]; // In the order of the backend function, pointers as offsets
+};
+
+// Keeps the calls instead of sending them to a GPU, render submission can be run and checked headless
+class RecordingRenderBackend : public RenderBackend
+{
+  public:
+    void UseProgram(unsigned int program) override;
+    void BindVertexArray(unsigned int vao) override;
+    void BindTexture(unsigned int unit, unsigned int texture) override;
+    void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) override;
+    void BindBufferRange(
+        unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+    ) override;
+    int GetUniformLocation(unsigned int program, const char* name) override;
+    void SetUniform(int location, UniformType type, const void* value) override;
+    void DrawArrays(unsigned int mode, int first, int count) override;
+    void DrawElements(unsigned int mode, int count, unsigned int type, const void* indices) override;
+    void MultiDrawElementsIndirect(
+        unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+    ) override;
+
+    std::size_t CountCalls(RenderCall call) const;
+    void Clear() { calls.clear(); }
+
+    const std::vector<RecordedCall>& GetCalls() const { return calls; }
+
+  private:
+    void Record(RenderCall call, uint64_t first = 0, uint64_t second = 0, uint64_t third = 0, uint64_t fourth = 0);
+
+  private:
+    std::vector<RecordedCall> calls;
+    std::map<std::pair<unsigned int, std::string>, int> uniformLocations; // Handed out in the order they are asked
+};
@@ -0,0 +1,224 @@
+#include "RenderState.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t WHOLE_BUFFER = ~std::size_t(0);
+}
+
+RenderState::RenderState(RenderBackend* backend) : backend(backend)
+{
+    Invalidate();
+}
+
+void RenderState::Invalidate()
+{
+    program      = RENDER_STATE_UNKNOWN;
+    programCache = nullptr;
+    vao          = RENDER_STATE_UNKNOWN;
+    std::fill(std::begin(textures), std::end(textures), RENDER_STATE_UNKNOWN);
+    buffers.clear();
+}
+
+void RenderState::ForgetProgram(unsigned int deletedProgram)
+{
+    programs.erase(deletedProgram);
+    if (program == deletedProgram)
+    {
+        program      = RENDER_STATE_UNKNOWN;
+        programCache = nullptr;
+    }
+}
+
+void RenderState::UseProgram(unsigned int newProgram)
+{
+    if (newProgram == program)
+    {
+        ++stats.skipped;
+        return;
+    }
+
+    backend->UseProgram(newProgram);
+    Issue(RenderCall::UseProgram);
+
+    program      = newProgram;
+    programCache = newProgram != 0 ? &programs[newProgram] : nullptr;
+}
+
+void RenderState::BindVertexArray(unsigned int newVao)
+{
+    if (newVao == vao)
+    {
+        ++stats.skipped;
+        return;
+    }
+
+    backend->BindVertexArray(newVao);
+    Issue(RenderCall::BindVertexArray);
+    vao = newVao;
+}
+
+void RenderState::BindTexture(unsigned int unit, unsigned int texture)
+{
+    // Units past the cached ones are always bound
+    if (unit < RENDER_STATE_TEXTURE_UNITS)
+    {
+        if (textures[unit] == texture)
+        {
+            ++stats.skipped;
+            return;
+        }
+        textures[unit] = texture;
+    }
+
+    backend->BindTexture(unit, texture);
+    Issue(RenderCall::BindTexture);
+}
+
+void RenderState::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+    BindBuffer({buffer, 0, WHOLE_BUFFER}, target, index);
+}
+
+void RenderState::BindBufferRange(
+    unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+)
+{
+    BindBuffer({buffer, offset, size}, target, index);
+}
+
+int RenderState::GetUniformLocation(unsigned int locationProgram, const char* name)
+{
+    ProgramCache& cache = programs[locationProgram];
+    const auto it       = cache.locations.find(name);
+    if (it != cache.locations.end())
+    {
+        ++stats.skipped;
+        return it->second;
+    }
+
+    const int location = backend->GetUniformLocation(locationProgram, name);
+    Issue(RenderCall::GetUniformLocation);
+
+    cache.locations.emplace(name, location);
+    return location;
+}
+
+void RenderState::SetUniform(int location, int value)
+{
+    SetUniform(location, UniformType::Int, &value, sizeof(value));
+}
+
+void RenderState::SetUniform(int location, unsigned int value)
+{
+    SetUniform(location, UniformType::UInt, &value, sizeof(value));
+}
+
+void RenderState::SetUniform(int location, float value)
+{
+    SetUniform(location, UniformType::Float, &value, sizeof(value));
+}
+
+void RenderState::SetUniform(int location, const float2& value)
+{
+    SetUniform(location, UniformType::Float2, value.ptr(), sizeof(float2));
+}
+
+void RenderState::SetUniform(int location, unsigned int x, unsigned int y)
+{
+    const unsigned int value[] = {x, y};
+    SetUniform(location, UniformType::UInt2, value, sizeof(value));
+}
+
+void RenderState::SetUniform(int location, const float3& value)
+{
+    SetUniform(location, UniformType::Float3, value.ptr(), sizeof(float3));
+}
+
+void RenderState::SetUniform(int location, const float4x4& value)
+{
+    SetUniform(location, UniformType::Matrix4, value.ptr(), sizeof(float4x4));
+}
+
+void RenderState::SetUniformHandle(int location, uint64_t handle)
+{
+    SetUniform(location, UniformType::Handle, &handle, sizeof(handle));
+}
+
+void RenderState::DrawArrays(unsigned int mode, int first, int count)
+{
+    backend->DrawArrays(mode, first, count);
+    Issue(RenderCall::DrawArrays);
+}
+
+void RenderState::DrawElements(unsigned int mode, int count, unsigned int type, const void* indices)
+{
+    backend->DrawElements(mode, count, type, indices);
+    Issue(RenderCall::DrawElements);
+}
+
+void RenderState::MultiDrawElementsIndirect(
+    unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+)
+{
+    backend->MultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    Issue(RenderCall::MultiDrawElementsIndirect);
+}
+
+unsigned int RenderState::GetIssuedCalls() const
+{
+    unsigned int total = 0;
+    for (const unsigned int count : stats.issued)
+        total += count;
+    return total;
+}
+
+void RenderState::SetUniform(int location, UniformType type, const void* value, std::size_t size)
+{
+    if (location < 0) return;
+
+    // Without a known program there is nowhere to keep the value
+    if (programCache != nullptr)
+    {
+        const auto inserted   = programCache->uniforms.try_emplace(location);
+        CachedUniform& cached = inserted.first->second;
+        if (!inserted.second && cached.type == type && memcmp(cached.value, value, size) == 0)
+        {
+            ++stats.skipped;
+            return;
+        }
+
+        cached.type = type;
+        memcpy(cached.value, value, size);
+    }
+
+    backend->SetUniform(location, type, value);
+    Issue(RenderCall::SetUniform);
+}
+
+void RenderState::BindBuffer(const BufferBinding& binding, unsigned int target, unsigned int index)
+{
+    const uint64_t key    = (static_cast<uint64_t>(target) << 32) | index;
+    const auto inserted   = buffers.try_emplace(key, binding);
+    BufferBinding& cached = inserted.first->second;
+    if (!inserted.second && cached.buffer == binding.buffer && cached.offset == binding.offset &&
+        cached.size == binding.size)
+    {
+        ++stats.skipped;
+        return;
+    }
+    cached = binding;
+
+    if (binding.size == WHOLE_BUFFER)
+    {
+        backend->BindBufferBase(target, index, binding.buffer);
+        Issue(RenderCall::BindBufferBase);
+    }
+    else
+    {
+        backend->BindBufferRange(target, index, binding.buffer, binding.offset, binding.size);
+        Issue(RenderCall::BindBufferRange);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+#include "Math/float2.h"
+#include "Math/float3.h"
+#include "Math/float4x4.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+constexpr unsigned int RENDER_STATE_TEXTURE_UNITS = 16;
+constexpr unsigned int RENDER_STATE_UNKNOWN       = ~0u; // The next bind always reaches the backend
+
+struct RenderStateStats
+{
+    unsigned int issued[static_cast<int>(RenderCall::Count)] = {};
+    unsigned int skipped                                     = 0; // Calls that matched the cached state
+};
+
+// Program, vertex array, texture unit, indexed buffer and uniform state set through it, redundant calls never reach
+// the backend. Code out of the render passes (resource creation, ImGui) touches GL directly, so the bindings are
+// forgotten at the start of every pass. Uniform values are program state and are kept, programs used here get their
+// uniforms only through here
+class RenderState
+{
+  public:
+    explicit RenderState(RenderBackend* backend);
+
+    void Invalidate();
+    // The id of a deleted program can be given to a new one
+    void ForgetProgram(unsigned int program);
+    void ResetStats() { stats = RenderStateStats(); }
+
+    void UseProgram(unsigned int program);
+    void BindVertexArray(unsigned int vao);
+    void BindTexture(unsigned int unit, unsigned int texture);
+    void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+    void BindBufferRange(
+        unsigned int target, unsigned int index, unsigned int buffer, std::size_t offset, std::size_t size
+    );
+
+    int GetUniformLocation(unsigned int program, const char* name);
+
+    // Values are cached for the program in use
+    void SetUniform(int location, int value);
+    void SetUniform(int location, unsigned int value);
+    void SetUniform(int location, float value);
+    void SetUniform(int location, const float2& value);
+    void SetUniform(int location, unsigned int x, unsigned int y);
+    void SetUniform(int location, const float3& value);
+    void SetUniform(int location, const float4x4& value);
+    void SetUniformHandle(int location, uint64_t handle);
+
+    void DrawArrays(unsigned int mode, int first, int count);
+    void DrawElements(unsigned int mode, int count, unsigned int type, const void* indices);
+    void MultiDrawElementsIndirect(
+        unsigned int mode, unsigned int type, const void* indirect, int drawCount, int stride
+    );
+
+    unsigned int GetProgram() const { return program; }
+    const RenderStateStats& GetStats() const { return stats; }
+    unsigned int GetIssuedCalls() const;
+
+  private:
+    struct CachedUniform
+    {
+        UniformType type;
+        unsigned char value[sizeof(float4x4)];
+    };
+
+    struct ProgramCache
+    {
+        std::unordered_map<std::string, int> locations;
+        std::unordered_map<int, CachedUniform> uniforms;
+    };
+
+    struct BufferBinding
+    {
+        unsigned int buffer;
+        std::size_t offset;
+        std::size_t size; // Whole buffer when it is bound with BindBufferBase
+    };
+
+    void SetUniform(int location, UniformType type, const void* value, std::size_t size);
+    void BindBuffer(const BufferBinding& binding, unsigned int target, unsigned int index);
+    void Issue(RenderCall call) { ++stats.issued[static_cast<int>(call)]; }
+
+  private:
+    RenderBackend* backend;
+    unsigned int program       = RENDER_STATE_UNKNOWN;
+    ProgramCache* programCache = nullptr; // Of the program in use, null when it is not known
+    unsigned int vao           = RENDER_STATE_UNKNOWN;
+    unsigned int textures[RENDER_STATE_TEXTURE_UNITS];
+
+    std::unordered_map<uint64_t, BufferBinding> buffers; // Target in the high half of the key, binding index in the low
+    std::unordered_map<unsigned int, ProgramCache> programs;
+
+    RenderStateStats stats;
+};
@@ -10,57 +10,79 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
+
 namespace TextManager
 {
-    static void GenerateFontTextures(const FT_Face face, std::map<char, Character>& outCharacters)
+    // Unicode blocks packed in every atlas: Basic Latin, Latin-1 Supplement, Latin Extended-A and Cyrillic
+    static const uint32_t FONT_RANGES[][2] = {
+        {0x20, 0x7E},
+        {0xA0, 0x17F},
+        {0x400, 0x4FF}
+    };
+
+    static bool GenerateFontAtlas(const FT_Face face, GlyphAtlas& outAtlas)
     {
-        // Disable byte-alignment restriction.
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        std::vector<GlyphBitmap> glyphs;
+        std::vector<FT_UInt> glyphIndices;
 
-        // 128 as of ASCII table
-        for (unsigned char ch = 0; ch < 128; ch++)
+        for (const auto& range : FONT_RANGES)
         {
-            if (FT_Load_Char(face, ch, FT_LOAD_RENDER))
+            for (uint32_t codepoint = range[0]; codepoint <= range[1]; ++codepoint)
             {
-                GLOG("ERROR: Failed to load character");
-                continue;
+                // Characters the font doesn't have are drawn with the fallback one
+                const FT_UInt glyphIndex = FT_Get_Char_Index(face, codepoint);
+                if (glyphIndex == 0) continue;
+
+                if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_RENDER))
+                {
+                    GLOG("ERROR: Failed to load character");
+                    continue;
+                }
+
+                const FT_Bitmap& bitmap = face->glyph->bitmap;
+                GlyphBitmap glyph;
+                glyph.codepoint = codepoint;
+                glyph.width     = bitmap.width;
+                glyph.height    = bitmap.rows;
+                glyph.left      = face->glyph->bitmap_left;
+                glyph.top       = face->glyph->bitmap_top;
+                glyph.advance   = static_cast<unsigned int>(face->glyph->advance.x);
+
+                // Rows can be padded or stored bottom up, the pitch tells
+                glyph.pixels.resize(static_cast<size_t>(glyph.width) * glyph.height);
+                for (unsigned int row = 0; row < glyph.height; ++row)
+                {
+                    const unsigned char* source =
+                        bitmap.pitch >= 0 ? bitmap.buffer + row * bitmap.pitch
+                                          : bitmap.buffer + (glyph.height - 1 - row) * -bitmap.pitch;
+                    std::copy_n(source, glyph.width, glyph.pixels.begin() + static_cast<size_t>(row) * glyph.width);
+                }
+
+                glyphs.push_back(std::move(glyph));
+                glyphIndices.push_back(glyphIndex);
             }
-            // if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL))
-            //{
-            //     GLOG("ERROR: Failed to load character");
-            //     continue;
-            // }
-
-            GLuint texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-
-            glTexImage2D(
-                GL_TEXTURE_2D, 0, GL_R8, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED,
-                GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer
-            );
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            UID bindlessUID = glGetTextureHandleARB(texture);
-            glMakeTextureHandleResidentARB(bindlessUID);
+        }
 
-            // Store the data of the character texture
-            Character character = {
-                texture, bindlessUID,
-                float2(static_cast<float>(face->glyph->bitmap.width), static_cast<float>(face->glyph->bitmap.rows)),
-                float2(static_cast<float>(face->glyph->bitmap_left), static_cast<float>(face->glyph->bitmap_top)),
-                static_cast<unsigned int>(face->glyph->advance.x)
-            };
+        if (!outAtlas.Pack(glyphs)) return false;
 
-            // Store the loaded glyph in the map for later use.
-            outCharacters.insert(std::pair<char, Character>(ch, character));
+        // Only the pairs with an offset are kept, most fonts kern a few hundred of them
+        if (FT_HAS_KERNING(face))
+        {
+            for (size_t left = 0; left < glyphs.size(); ++left)
+            {
+                for (size_t right = 0; right < glyphs.size(); ++right)
+                {
+                    FT_Vector delta;
+                    if (FT_Get_Kerning(face, glyphIndices[left], glyphIndices[right], FT_KERNING_DEFAULT, &delta) ||
+                        delta.x == 0)
+                        continue;
+                    outAtlas.SetKerning(glyphs[left].codepoint, glyphs[right].codepoint, static_cast<int>(delta.x));
+                }
+            }
         }
 
-        // Reset pixel storage mode to default
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return true;
     }
 
     void FontData::Init(const char* filename, const unsigned int fontSize)
@@ -79,8 +101,34 @@ namespace TextManager
         // Set the font size
         FT_Set_Pixel_Sizes(face, 0, fontSize);
 
-        // Generate a texture per character
-        GenerateFontTextures(face, characters);
+        // Pack every character in a single texture
+        if (GenerateFontAtlas(face, atlas))
+        {
+            // Disable byte-alignment restriction.
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            const GLsizei atlasSize = static_cast<GLsizei>(atlas.GetSize());
+            glGenTextures(1, &textureID);
+            glBindTexture(GL_TEXTURE_2D, textureID);
+            glTexImage2D(
+                GL_TEXTURE_2D, 0, GL_R8, atlasSize, atlasSize, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.GetPixels().data()
+            );
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            bindlessUID = glGetTextureHandleARB(textureID);
+            glMakeTextureHandleResidentARB(bindlessUID);
+
+            // Reset pixel storage mode to default
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+        else
+        {
+            GLOG("Error: The glyphs of the font don't fit in a %u atlas", GLYPH_ATLAS_MAX_SIZE);
+        }
+
         this->fontSize = fontSize;
         this->fontName = face->family_name;
 
@@ -90,69 +138,31 @@ namespace TextManager
 
     void FontData::Clean()
     {
-        for (const auto& c : characters)
+        if (textureID != 0)
         {
-            if (c.second.textureID != 0)
-            {
-                glMakeTextureHandleNonResidentARB(c.second.bindlessUID);
-                glDeleteTextures(1, &c.second.textureID);
-            }
-            
+            glMakeTextureHandleNonResidentARB(bindlessUID);
+            glDeleteTextures(1, &textureID);
         }
-        characters.clear();
+        textureID   = 0;
+        bindlessUID = 0;
+        atlas       = GlyphAtlas();
     }
 
-    void RenderText(FontData& fontData, const std::string& text, const float3& startPos, const unsigned vbo, const float maxWidth)
+    bool UpdateTextLayout(
+        const FontData& fontData, const std::string& text, const float3& startPos, float maxWidth, TextLayout& layout
+    )
     {
-        // When deferred lightning works, this won't be needed as transparency will be p6roperly handled
-        glDisable(GL_DEPTH_TEST);
-
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        int x = (int)startPos.x;
-        int y = (int)startPos.y - fontData.fontSize;
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-        for (char c : text)
-        {
-            if (c == '\n')
-            {
-                x  = 0;
-                y -= fontData.fontSize;
-                continue;
-            }
-            else if (x > maxWidth)
-            {
-                x  = 0;
-                y -= fontData.fontSize;
-            }
-
-            const Character character = fontData.characters[c];
-
-            const float xPos          = x + character.bearing.x;
-            const float yPos          = y - (character.size.y - character.bearing.y);
-            const float width         = character.size.x;
-            const float height        = character.size.y;
-
-            // Positions - Uvs interleaved
-            const float vertices[]    = {xPos,         yPos + height, 0.0f,         0.0f, xPos, yPos,
-                                         0.0f,         1.0f,          xPos + width, yPos, 1.0f, 1.0f,
-
-                                         xPos + width, yPos + height, 1.0f,         0.0f, xPos, yPos + height,
-                                         0.0f,         0.0f,          xPos + width, yPos, 1.0f, 1.0f};
-
-            const GLuint lower = static_cast<GLuint>(character.bindlessUID & 0xFFFFFFFF);
-            const GLuint higher = static_cast<GLuint>(character.bindlessUID >> 32);
-            glUniform2ui(4, lower, higher);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-            App->GetOpenGLModule()->DrawArrays(GL_TRIANGLES, 0, 6);
-
-            x += (character.advance >> 6);
-        }
-
-        glDisable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST);
+        if (!layout.textChanged && layout.fontData == &fontData && layout.startPos.Equals(startPos) &&
+            layout.maxWidth == maxWidth)
+            return false;
+
+        layout.fontData    = &fontData;
+        layout.startPos    = startPos;
+        layout.maxWidth    = maxWidth;
+        layout.textChanged = false;
+        layout.vertices.clear();
+        fontData.atlas.BuildQuads(text, startPos, fontData.fontSize, maxWidth, layout.vertices);
+        return true;
     }
 
 } // namespace TextManager
\ No newline at end of file
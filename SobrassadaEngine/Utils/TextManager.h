@@ -1,34 +1,40 @@
 #pragma once
 
 #include "Globals.h"
-#include "Math/float2.h"
-
-#include <map>
+#include "GlyphAtlas.h"
 
 
 // Reference tutorial: https://nehe.gamedev.net/tutorial/freetype_fonts_in_opengl/24001/
 
 namespace TextManager
 {
-    struct Character
-    {
-        unsigned int textureID = 0;
-        UID bindlessUID        = 0;
-        float2 size            = float2::zero;
-        float2 bearing         = float2::zero;
-        unsigned int advance   = 0;
-    };
-
+    // Every glyph of the font size lives in one atlas texture, a whole text is drawn with a single draw call
     struct FontData
     {
         std::string fontName;
-        unsigned int fontSize;
-        std::map<char, Character> characters;
+        unsigned int fontSize  = 0;
+        GlyphAtlas atlas;
+        unsigned int textureID = 0;
+        UID bindlessUID        = 0;
 
         void Init(const char* filename, const unsigned int fontSize);
         void Clean();
     };
 
-    void RenderText(FontData& fontData, const std::string& text, const float3& startPos, const unsigned vbo, const float maxWidth);
+    // Quads of a text in the widget space and what they were laid out for. It is only laid out again when the text is
+    // marked as changed or the font, position or width differ, static texts cost a few comparisons per frame
+    struct TextLayout
+    {
+        const FontData* fontData = nullptr;
+        float3 startPos          = float3::zero;
+        float maxWidth           = 0.f;
+        bool textChanged         = true;
+        std::vector<float> vertices;
+    };
+
+    // Lays the text out when the layout is out of date, returns true when it did
+    bool UpdateTextLayout(
+        const FontData& fontData, const std::string& text, const float3& startPos, float maxWidth, TextLayout& layout
+    );
 
 } // namespace TextManager
@@ -0,0 +1,147 @@
+#include "MeshBVH.h"
+
+#include "Mesh.h"
+
+#include "Geometry/LineSegment.h"
+#include <algorithm>
+#include <cassert>
+
+constexpr unsigned int MAX_LEAF_TRIANGLES = 4;
+// Median splits halve the triangles at every level and never get past 32 for a 32 bit count. Nodes at the cap become
+// leaves anyway, so the traversal stack below always fits
+constexpr unsigned int MAX_TREE_DEPTH     = 48;
+// Depth first, the stack holds at most one pending sibling per level and the two children of the deepest node
+constexpr unsigned int TRAVERSAL_STACK    = MAX_TREE_DEPTH + 1;
+
+void MeshBVH::Build(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    Clear();
+
+    const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    if (triangleCount == 0) return;
+
+    std::vector<Triangle> sourceTriangles;
+    std::vector<float3> centroids;
+    std::vector<unsigned int> order;
+    sourceTriangles.reserve(triangleCount);
+    centroids.reserve(triangleCount);
+    order.reserve(triangleCount);
+
+    for (unsigned int i = 0; i < triangleCount; ++i)
+    {
+        const Triangle triangle(
+            vertices[indices[i * 3]].position, vertices[indices[i * 3 + 1]].position,
+            vertices[indices[i * 3 + 2]].position
+        );
+        sourceTriangles.push_back(triangle);
+        centroids.push_back(triangle.Centroid());
+        order.push_back(i);
+    }
+
+    nodes.reserve(triangleCount);
+    BuildNode(sourceTriangles, centroids, order, 0, triangleCount, 0);
+
+    // Store the triangles in leaf order so every leaf reads a contiguous range
+    triangles.reserve(triangleCount);
+    for (const unsigned int index : order)
+        triangles.push_back(sourceTriangles[index]);
+}
+
+void MeshBVH::Clear()
+{
+    nodes.clear();
+    triangles.clear();
+}
+
+void MeshBVH::BuildNode(
+    const std::vector<Triangle>& sourceTriangles, const std::vector<float3>& centroids, std::vector<unsigned int>& order,
+    unsigned int first, unsigned int count, unsigned int depth
+)
+{
+    const unsigned int nodeIndex = static_cast<unsigned int>(nodes.size());
+    nodes.emplace_back();
+
+    AABB bounds;
+    AABB centroidBounds;
+    bounds.SetNegativeInfinity();
+    centroidBounds.SetNegativeInfinity();
+    for (unsigned int i = first; i < first + count; ++i)
+    {
+        const Triangle& triangle = sourceTriangles[order[i]];
+        bounds.Enclose(triangle.a);
+        bounds.Enclose(triangle.b);
+        bounds.Enclose(triangle.c);
+        centroidBounds.Enclose(centroids[order[i]]);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    if (count <= MAX_LEAF_TRIANGLES || depth == MAX_TREE_DEPTH)
+    {
+        nodes[nodeIndex].firstTriangle = first;
+        nodes[nodeIndex].triangleCount = count;
+        return;
+    }
+
+    // Median split along the longest axis of the centroids
+    const float3 extent = centroidBounds.Size();
+    int axis            = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    const unsigned int half = count / 2;
+    std::nth_element(
+        order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+        [&centroids, axis](unsigned int a, unsigned int b) { return centroids[a][axis] < centroids[b][axis]; }
+    );
+
+    BuildNode(sourceTriangles, centroids, order, first, half, depth + 1);
+    nodes[nodeIndex].firstTriangle = static_cast<unsigned int>(nodes.size());
+    BuildNode(sourceTriangles, centroids, order, first + half, count - half, depth + 1);
+}
+
+bool MeshBVH::Intersects(const LineSegment& segment, float& outDistance, float3& outHitPoint, float3& outNormal) const
+{
+    if (nodes.empty()) return false;
+
+    bool hit                    = false;
+    float closestDistance       = 1.f;
+
+    unsigned int nodesToVisit[TRAVERSAL_STACK];
+    unsigned int stackSize      = 0;
+    nodesToVisit[stackSize++]   = 0;
+
+    float nearDistance          = 0.f;
+    float farDistance           = 0.f;
+
+    while (stackSize > 0)
+    {
+        const BVHNode& node = nodes[nodesToVisit[--stackSize]];
+
+        if (!segment.Intersects(node.bounds, nearDistance, farDistance) || nearDistance > closestDistance) continue;
+
+        if (node.triangleCount > 0)
+        {
+            for (unsigned int i = node.firstTriangle; i < node.firstTriangle + node.triangleCount; ++i)
+            {
+                float distance = 0.f;
+                float3 hitPoint;
+                if (triangles[i].Intersects(segment, &distance, &hitPoint) && distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    outHitPoint     = hitPoint;
+                    outNormal       = triangles[i].NormalCCW();
+                    hit             = true;
+                }
+            }
+        }
+        else
+        {
+            assert(stackSize + 2 <= TRAVERSAL_STACK);
+            nodesToVisit[stackSize++] = node.firstTriangle;
+            nodesToVisit[stackSize++] = static_cast<unsigned int>(&node - nodes.data()) + 1;
+        }
+    }
+
+    if (hit) outDistance = closestDistance;
+    return hit;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Geometry/AABB.h"
+#include "Geometry/Triangle.h"
+#include "Math/float3.h"
+
+#include <vector>
+
+namespace math
+{
+    class LineSegment;
+}
+
+struct Vertex;
+
+// Bounding volume hierarchy over the triangles of a mesh, in mesh local space. Built once when the mesh data is loaded
+// and only read afterwards, so it can be queried from several threads at the same time
+class MeshBVH
+{
+  private:
+    struct BVHNode
+    {
+        AABB bounds;
+        unsigned int firstTriangle = 0; // Leaf: first triangle. Inner node: index of the right child
+        unsigned int triangleCount = 0; // 0 for inner nodes, the left child is always the next node
+    };
+
+  public:
+    MeshBVH()  = default;
+    ~MeshBVH() = default;
+
+    void Build(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    void Clear();
+
+    // Closest hit along the segment. Distance is returned normalized to [0, 1] like MathGeoLib does
+    bool Intersects(
+        const math::LineSegment& segment, float& outDistance, float3& outHitPoint, float3& outNormal
+    ) const;
+
+    bool IsEmpty() const { return nodes.empty(); }
+    size_t GetTriangleCount() const { return triangles.size(); }
+
+  private:
+    void BuildNode(
+        const std::vector<Triangle>& sourceTriangles, const std::vector<float3>& centroids,
+        std::vector<unsigned int>& order, unsigned int first, unsigned int count, unsigned int depth
+    );
+
+  private:
+    std::vector<BVHNode> nodes;
+    std::vector<Triangle> triangles;
+};
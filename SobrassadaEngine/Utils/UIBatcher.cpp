@@ -0,0 +1,107 @@
+#include "UIBatcher.h"
+
+#include "Math/MathConstants.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // Touching edges don't count, a grid of slots doesn't overlap itself
+    bool Overlaps(const float3& minA, const float3& maxA, const float3& minB, const float3& maxB)
+    {
+        return minA.x < maxB.x && minB.x < maxA.x && minA.y < maxB.y && minB.y < maxA.y && minA.z <= maxB.z &&
+               minB.z <= maxA.z;
+    }
+} // namespace
+
+void UIBatcher::Clear()
+{
+    widgets.clear();
+    widgetVertices.clear();
+    order.clear();
+    vertices.clear();
+    batches.clear();
+}
+
+void UIBatcher::AddWidget(
+    uint64_t texture, UIWidgetType type, const float4x4& model, const float3& color, const float* widgetQuads,
+    unsigned int vertexCount
+)
+{
+    if (vertexCount == 0) return;
+
+    Widget widget;
+    widget.texture     = texture;
+    widget.type        = type;
+    widget.firstVertex = static_cast<unsigned int>(widgetVertices.size() / UI_BATCH_VERTEX_FLOATS);
+    widget.vertexCount = vertexCount;
+    widget.minPoint    = float3(FLOAT_INF);
+    widget.maxPoint    = float3(-FLOAT_INF);
+    widget.layer       = 0;
+
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        const float* vertex  = widgetQuads + i * UI_WIDGET_VERTEX_FLOATS;
+        const float3 point   = model.TransformPos(float3(vertex[0], vertex[1], 0.f));
+        widget.minPoint      = widget.minPoint.Min(point);
+        widget.maxPoint      = widget.maxPoint.Max(point);
+
+        const float packed[] = {point.x, point.y, point.z, vertex[2], vertex[3], color.x, color.y, color.z};
+        widgetVertices.insert(widgetVertices.end(), std::begin(packed), std::end(packed));
+    }
+
+    widgets.push_back(widget);
+}
+
+void UIBatcher::Build()
+{
+    // A widget goes on the highest layer of the earlier widgets it overlaps, one above it when they can't share a
+    // batch
+    for (size_t i = 0; i < widgets.size(); ++i)
+    {
+        Widget& widget = widgets[i];
+        for (size_t j = 0; j < i; ++j)
+        {
+            const Widget& earlier = widgets[j];
+            if (!Overlaps(widget.minPoint, widget.maxPoint, earlier.minPoint, earlier.maxPoint)) continue;
+
+            const bool sameBatch = earlier.texture == widget.texture && earlier.type == widget.type;
+            widget.layer         = std::max(widget.layer, earlier.layer + (sameBatch ? 0 : 1));
+        }
+    }
+
+    // Stable, so the widgets of a batch keep the order they were added in and the result doesn't depend on the sort
+    order.resize(widgets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(),
+        [this](unsigned int first, unsigned int second)
+        {
+            const Widget& a = widgets[first];
+            const Widget& b = widgets[second];
+            if (a.layer != b.layer) return a.layer < b.layer;
+            if (a.texture != b.texture) return a.texture < b.texture;
+            return a.type < b.type;
+        }
+    );
+
+    vertices.clear();
+    vertices.reserve(widgetVertices.size());
+    batches.clear();
+
+    for (const unsigned int index : order)
+    {
+        const Widget& widget           = widgets[index];
+        const unsigned int firstVertex = static_cast<unsigned int>(vertices.size() / UI_BATCH_VERTEX_FLOATS);
+        vertices.insert(
+            vertices.end(), widgetVertices.begin() + widget.firstVertex * UI_BATCH_VERTEX_FLOATS,
+            widgetVertices.begin() + (widget.firstVertex + widget.vertexCount) * UI_BATCH_VERTEX_FLOATS
+        );
+
+        // Batches of the same texture and type on consecutive layers merge too
+        if (!batches.empty() && batches.back().texture == widget.texture && batches.back().type == widget.type)
+            batches.back().vertexCount += widget.vertexCount;
+        else batches.push_back({widget.texture, widget.type, firstVertex, widget.vertexCount});
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Math/float3.h"
+#include "Math/float4x4.h"
+
+#include <cstdint>
+#include <vector>
+
+constexpr unsigned int UI_WIDGET_VERTEX_FLOATS = 4; // Position and uv in the widget space, what the widgets give
+constexpr unsigned int UI_BATCH_VERTEX_FLOATS  = 8; // Position in the canvas space, uv and color
+
+enum class UIWidgetType : unsigned int
+{
+    Label = 0, // The texture red channel is the coverage of the glyphs
+    Image = 1
+};
+
+// Consecutive vertices drawn with the same texture and widget type
+struct UIBatch
+{
+    uint64_t texture;
+    UIWidgetType type;
+    unsigned int firstVertex;
+    unsigned int vertexCount;
+};
+
+// Collects the quads of the widgets of a canvas in their draw order and merges them in the fewest draws that keep
+// the result the same. A widget only has to stay after the earlier widgets it overlaps with another texture or type,
+// the rest are free to move to the batch of their texture. No GL calls, the canvas uploads and draws the batches
+class UIBatcher
+{
+  public:
+    void Clear();
+
+    // Vertices are triangles of UI_WIDGET_VERTEX_FLOATS each, the model matrix moves them to the canvas space
+    void AddWidget(
+        uint64_t texture, UIWidgetType type, const float4x4& model, const float3& color, const float* vertices,
+        unsigned int vertexCount
+    );
+
+    void Build();
+
+    const std::vector<float>& GetVertices() const { return vertices; }
+    const std::vector<UIBatch>& GetBatches() const { return batches; }
+    unsigned int GetWidgetCount() const { return static_cast<unsigned int>(widgets.size()); }
+
+  private:
+    struct Widget
+    {
+        uint64_t texture;
+        UIWidgetType type;
+        unsigned int firstVertex; // In widgetVertices
+        unsigned int vertexCount;
+        float3 minPoint; // Bounds in the canvas space, overlapping bounds are a conservative overlap test
+        float3 maxPoint;
+        unsigned int layer; // Batches are drawn by layer, a widget is a layer above the ones it has to follow
+    };
+
+    std::vector<Widget> widgets;
+    std::vector<float> widgetVertices; // Transformed, in the order the widgets were added
+    std::vector<unsigned int> order;
+    std::vector<float> vertices;
+    std::vector<UIBatch> batches;
+};
@@ -0,0 +1,91 @@
+#include "UIHitGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+void UIHitGrid::Build(const float2& canvasSize, const std::vector<UIHitRect>& newRects)
+{
+    rects    = newRects;
+    cellSize = float2(
+        std::max(canvasSize.x, 1.f) / UI_HIT_GRID_CELLS, std::max(canvasSize.y, 1.f) / UI_HIT_GRID_CELLS
+    );
+
+    // Cell range of the bounds of every rectangle. Rectangles out of the canvas go to the border cells, where the
+    // points out of the canvas are looked for too
+    std::vector<unsigned int> ranges(rects.size() * 4);
+    cellFirst.assign(UI_HIT_GRID_CELLS * UI_HIT_GRID_CELLS + 1, 0);
+
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        const UIHitRect& rect = rects[i];
+
+        // The corners come from the widget axes, the columns of the inverse of toLocal. A collapsed rectangle only
+        // takes the cell of its center and is never hit
+        const float determinant = rect.toLocalX.x * rect.toLocalY.y - rect.toLocalX.y * rect.toLocalY.x;
+        float2 extent           = float2::zero;
+        if (determinant != 0.f)
+        {
+            const float2 axisX = float2(rect.toLocalY.y, -rect.toLocalY.x) / determinant * rect.halfSize.x;
+            const float2 axisY = float2(-rect.toLocalX.y, rect.toLocalX.x) / determinant * rect.halfSize.y;
+            extent             = axisX.Abs() + axisY.Abs();
+        }
+
+        unsigned int* range = &ranges[i * 4];
+        range[0]            = GetCell(rect.center.x - extent.x, cellSize.x);
+        range[1]            = GetCell(rect.center.x + extent.x, cellSize.x);
+        range[2]            = GetCell(rect.center.y - extent.y, cellSize.y);
+        range[3]            = GetCell(rect.center.y + extent.y, cellSize.y);
+
+        for (unsigned int y = range[2]; y <= range[3]; ++y)
+            for (unsigned int x = range[0]; x <= range[1]; ++x)
+                ++cellFirst[y * UI_HIT_GRID_CELLS + x + 1];
+    }
+
+    for (size_t cell = 1; cell < cellFirst.size(); ++cell)
+        cellFirst[cell] += cellFirst[cell - 1];
+
+    // Filled in order, the rectangles of a cell keep the order they were given in
+    cellRects.resize(cellFirst.back());
+    std::vector<unsigned int> cellFill(cellFirst.begin(), cellFirst.end() - 1);
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        const unsigned int* range = &ranges[i * 4];
+        for (unsigned int y = range[2]; y <= range[3]; ++y)
+            for (unsigned int x = range[0]; x <= range[1]; ++x)
+                cellRects[cellFill[y * UI_HIT_GRID_CELLS + x]++] = static_cast<unsigned int>(i);
+    }
+}
+
+void UIHitGrid::FindAll(const float2& point, std::vector<unsigned int>& outHits) const
+{
+    outHits.clear();
+    if (rects.empty()) return;
+
+    const unsigned int cell = GetCell(point.y, cellSize.y) * UI_HIT_GRID_CELLS + GetCell(point.x, cellSize.x);
+    for (unsigned int i = cellFirst[cell]; i < cellFirst[cell + 1]; ++i)
+    {
+        if (Contains(rects[cellRects[i]], point)) outHits.push_back(cellRects[i]);
+    }
+
+    std::stable_sort(
+        outHits.begin(), outHits.end(),
+        [this](unsigned int first, unsigned int second) { return rects[first].order > rects[second].order; }
+    );
+}
+
+bool UIHitGrid::Contains(const UIHitRect& rect, const float2& point)
+{
+    // A collapsed widget has no area to hit, whatever toLocal the failed inverse left
+    if (rect.toLocalX.x * rect.toLocalY.y - rect.toLocalX.y * rect.toLocalY.x == 0.f) return false;
+
+    const float2 offset = point - rect.center;
+    return std::abs(rect.toLocalX.Dot(offset)) <= rect.halfSize.x &&
+           std::abs(rect.toLocalY.Dot(offset)) <= rect.halfSize.y;
+}
+
+unsigned int UIHitGrid::GetCell(float position, float size)
+{
+    const float cell = std::floor(position / size);
+    if (!(cell > 0.f)) return 0; // Also takes NaN
+    return static_cast<unsigned int>(std::min(cell, static_cast<float>(UI_HIT_GRID_CELLS - 1)));
+}
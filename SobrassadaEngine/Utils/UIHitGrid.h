@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Math/float2.h"
+
+#include <vector>
+
+constexpr unsigned int UI_HIT_GRID_CELLS = 16; // Per side, over the whole canvas
+
+// Rectangle of an interactive widget in the canvas space, it can be rotated and scaled
+struct UIHitRect
+{
+    float2 center;
+    float2 halfSize;
+    float2 toLocalX; // Rows of the inverse of the widget rotation and scale, they take a point to the widget space
+    float2 toLocalY;
+    unsigned int order; // Draw order, the highest one is on top
+};
+
+// Uniform grid of the interactive widgets of a canvas. Every cell lists the rectangles whose bounds touch it, a hit test
+// only checks the rectangles of the cell of the point. Built when the widgets change, not per query. No GL calls
+class UIHitGrid
+{
+  public:
+    void Build(const float2& canvasSize, const std::vector<UIHitRect>& rects);
+
+    // Indices of the rectangles that contain the point, the one on top first
+    void FindAll(const float2& point, std::vector<unsigned int>& outHits) const;
+    static bool Contains(const UIHitRect& rect, const float2& point);
+
+    const std::vector<UIHitRect>& GetRects() const { return rects; }
+
+  private:
+    static unsigned int GetCell(float position, float size);
+
+  private:
+    float2 cellSize = float2::one;
+    std::vector<UIHitRect> rects;
+    std::vector<unsigned int> cellFirst; // Offset of each cell in cellRects, one more entry marks the end
+    std::vector<unsigned int> cellRects;
+};